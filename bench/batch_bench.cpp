@@ -0,0 +1,65 @@
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bench.hpp"
+#include "../src/PlutoMath/plutomath.hpp"
+
+// compose_trs / transform_points / transform_aabbs throughput against object count, next to the
+// per-object translate * rotate * scale path the Renderer used to run.
+
+int main(){
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+
+    std::printf("%10s %14s %14s %12s %14s %14s\n", "objects", "per-object ns", "batch ns", "batch GB/s",
+                "points ns", "aabbs ns");
+    for(std::size_t count = 1000; count <= 1'000'000; count *= 10){
+        plutom::transform_batchf batch;
+        batch.reserve(count);
+        std::vector<plutom::aabbf> local(count, plutom::aabbf({-0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, 0.5f}));
+        std::vector<plutom::aabbf> world(count);
+        std::vector<plutom::vec3f> points(count), moved(count);
+        for(std::size_t i = 0; i < count; ++i){
+            batch.push_back({dist(gen), dist(gen), dist(gen)}, dist(gen), {dist(gen), dist(gen), dist(gen)},
+                            {1.0f, 2.0f, 0.5f});
+            points[i] = {dist(gen), dist(gen), dist(gen)};
+        }
+        std::vector<plutom::mat4f> matrices(count);
+        const long passes = static_cast<long>(20'000'000 / count) + 1;
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "  per-object %zu", count);
+        const double perObject = bench::run(name, passes, [&]{
+            for(std::size_t i = 0; i < count; ++i){
+                auto model = plutom::transform3D::translate(plutom::mat4f(1.0f),
+                                                            plutom::vec3f(batch.px[i], batch.py[i], batch.pz[i]));
+                model = plutom::transform3D::rotate(model, batch.angle[i],
+                                                    plutom::vec3f(batch.ax[i], batch.ay[i], batch.az[i]));
+                matrices[i] = plutom::transform3D::scale(model, plutom::vec3f(batch.sx[i], batch.sy[i], batch.sz[i]));
+            }
+            bench::do_not_optimize(matrices.data());
+        });
+        std::snprintf(name, sizeof(name), "  compose_trs %zu", count);
+        const double batched = bench::run(name, passes * 4, [&]{
+            plutom::compose_trs(batch, matrices.data());
+            bench::do_not_optimize(matrices.data());
+        });
+        std::snprintf(name, sizeof(name), "  transform_points %zu", count);
+        const double pts = bench::run(name, passes * 4, [&]{
+            plutom::transform_points(matrices[0], points.data(), moved.data(), count);
+            bench::do_not_optimize(moved.data());
+        });
+        std::snprintf(name, sizeof(name), "  transform_aabbs %zu", count);
+        const double boxes = bench::run(name, passes * 4, [&]{
+            plutom::transform_aabbs(matrices.data(), local.data(), world.data(), count);
+            bench::do_not_optimize(world.data());
+        });
+
+        // 10 floats read + 16 floats written per object
+        const double bytes = static_cast<double>(count) * 26.0 * sizeof(float);
+        std::printf("%10zu %14.2f %14.2f %12.2f %14.2f %14.2f\n\n", count, perObject / count, batched / count,
+                    bytes / batched, pts / count, boxes / count);
+    }
+    return 0;
+}
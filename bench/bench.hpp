@@ -0,0 +1,30 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+// Minimal timing harness shared by the benchmark executables.
+namespace bench{
+
+    template<typename T>
+    inline void do_not_optimize(T const& value){
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const T* sink;
+        sink = &value;
+#endif
+    }
+
+    // Runs fn iterations times and prints the average cost of one call
+    template<typename Fn>
+    double run(const char* name, const long iterations, Fn&& fn){
+        for(long i = 0; i < iterations / 10; ++i) fn(); // warm up
+        const auto start = std::chrono::steady_clock::now();
+        for(long i = 0; i < iterations; ++i) fn();
+        const auto end = std::chrono::steady_clock::now();
+        const double ns = std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(iterations);
+        std::printf("%-40s %10.2f ns/op\n", name, ns);
+        return ns;
+    }
+}
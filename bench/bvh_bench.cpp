@@ -0,0 +1,111 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bench.hpp"
+#include "../src/PlutoMath/plutomath.hpp"
+#include "../src/scene/scene.hpp"
+#include "../src/util/job_system.hpp"
+
+// 1M static + 10k dynamic boxes in the scene BVH: build, per-frame refit of the dynamic tree,
+// hierarchical frustum culling next to the flat SoA test over every box, ray picks and range queries.
+
+namespace {
+    double elapsed_ms(const std::chrono::steady_clock::time_point start){
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(){
+    constexpr std::size_t staticCount = 1'000'000;
+    constexpr std::size_t dynamicCount = 10'000;
+    std::mt19937 gen(13);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> size(0.1f, 2.0f);
+    std::uniform_real_distribution<float> step(-0.5f, 0.5f);
+
+    const auto random_box = [&]{
+        const plutom::vec3f c{position(gen), position(gen), position(gen)};
+        const plutom::vec3f e{size(gen), size(gen), size(gen)};
+        return plutom::aabbf(c - e, c + e);
+    };
+
+    JobSystem jobs;
+    scene world;
+    std::vector<plutom::aabbf> boxes;
+    boxes.reserve(staticCount + dynamicCount);
+    for(std::size_t i = 0; i < staticCount; ++i){
+        boxes.push_back(random_box());
+        world.add_object(boxes.back());
+    }
+    std::vector<scene::object_id> moving;
+    for(std::size_t i = 0; i < dynamicCount; ++i){
+        boxes.push_back(random_box());
+        moving.push_back(world.add_object(boxes.back(), true));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    world.update(&jobs);
+    std::printf("%-40s %10.2f ms\n", "build 1M static + 10k dynamic", elapsed_ms(start));
+    std::printf("%-40s %10zu nodes, SAH %.1f\n", "  static tree", world.get_static_tree().get_nodes().size(),
+                world.get_static_tree().sah_cost());
+
+    bench::run("move 10k + refit", 50, [&]{
+        for(const auto id : moving){
+            const plutom::vec3f d{step(gen), step(gen), step(gen)};
+            boxes[id] = plutom::aabbf(boxes[id].min + d, boxes[id].max + d);
+            world.set_bounds(id, boxes[id]);
+        }
+        world.update(&jobs);
+    });
+
+    plutom::aabb_batchf flat;
+    flat.assign(boxes.data(), boxes.size());
+    std::vector<std::uint8_t> flags(boxes.size());
+    std::vector<scene::object_id> visible;
+    visible.reserve(boxes.size());
+
+    const float fovs[] = {10.0f, 45.0f, 90.0f};
+    for(const float fov : fovs){
+        const auto viewProj = plutom::perspective(plutom::radians(fov), 16.0f / 9.0f, 0.1f, 300.0f) *
+                              plutom::lookAt(plutom::vec3f{0.0f, 0.0f, 0.0f}, plutom::vec3f{0.0f, 0.0f, 1.0f});
+        const auto frustum = plutom::frustumf::from_matrix(viewProj);
+        visible.clear();
+        world.cull(frustum, visible, &jobs);
+        std::printf("fov %4.0f: %zu of %zu visible\n", fov, visible.size(), boxes.size());
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "  bvh cull fov %.0f", fov);
+        bench::run(name, 20, [&]{
+            visible.clear();
+            world.cull(frustum, visible, &jobs);
+            bench::do_not_optimize(visible.data());
+        });
+        std::snprintf(name, sizeof(name), "  flat cull_aabbs fov %.0f", fov);
+        bench::run(name, 20, [&]{
+            bench::do_not_optimize(plutom::cull_aabbs(frustum, flat, flags.data()));
+        });
+    }
+
+    std::vector<plutom::vec3f> origins(1000), directions(1000);
+    for(std::size_t i = 0; i < origins.size(); ++i){
+        origins[i] = {position(gen), position(gen), position(gen)};
+        directions[i] = plutom::vec3f{step(gen), step(gen), step(gen)}.normalize();
+    }
+    std::size_t hits = 0;
+    bench::run("pick (1000 rays)", 20, [&]{
+        for(std::size_t i = 0; i < origins.size(); ++i) hits += world.pick(origins[i], directions[i], 1000.0f).valid();
+    });
+    std::printf("%-40s %10zu\n", "  hits", hits);
+
+    std::vector<scene::object_id> found;
+    bench::run("query 20^3 region (1000 regions)", 20, [&]{
+        for(const auto& o : origins){
+            found.clear();
+            world.query(plutom::aabbf(o - plutom::vec3f(10.0f), o + plutom::vec3f(10.0f)), found);
+            bench::do_not_optimize(found.data());
+        }
+    });
+    return 0;
+}
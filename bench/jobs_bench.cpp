@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+#include "../src/PlutoMath/plutomath.hpp"
+#include "../src/scene/scene.hpp"
+#include "../src/util/job_system.hpp"
+
+// The CPU side of a Renderer frame over 100k shapes (spin animation, transform propagation,
+// world bounds, BVH refit, frustum culling and per-object data) on 1 up to one job thread per
+// hardware thread, with the speedup over the single threaded run.
+
+namespace {
+    constexpr std::size_t objectCount = 100'000;
+    constexpr std::size_t grain = 512;
+
+    struct ObjectData {
+        plutom::mat4f model;
+        plutom::mat3f normalMatrix;
+    };
+
+    struct Frame {
+        scene world;
+        std::vector<plutom::aabbf> localBounds;
+        std::vector<float> angles;
+        std::vector<plutom::quatf> rotations;
+        std::vector<plutom::aabbf> updatedBounds;
+        std::vector<ObjectData> objects;
+        std::vector<scene::object_id> visible;
+    };
+
+    // Every fourth shape hangs off the one before it, half of them spin
+    void populate(Frame& frame){
+        std::mt19937 gen(16);
+        std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+        auto& transforms = frame.world.get_transforms();
+        for(std::size_t i = 0; i < objectCount; ++i){
+            const bool child = i % 4 == 3;
+            const plutom::vec3f at = child ? plutom::vec3f{1.5f, 0.0f, 0.0f}
+                                           : plutom::vec3f{position(gen), position(gen), position(gen)};
+            transforms.create(at, plutom::quatf::identity(), plutom::vec3f(1.0f),
+                              child ? static_cast<TransformGraph::node_id>(i - 1) : TransformGraph::NONE);
+            frame.world.add_object(plutom::aabbf(at, at), true);
+            frame.localBounds.emplace_back(plutom::vec3f(-0.5f), plutom::vec3f(0.5f));
+        }
+        frame.angles.assign(objectCount / 2, 0.0f);
+        frame.rotations.resize(objectCount / 2);
+        frame.objects.resize(objectCount);
+    }
+
+    void run_frame(Frame& frame, JobSystem& jobs, const plutom::frustumf& frustum){
+        auto& transforms = frame.world.get_transforms();
+        jobs.parallel_for(0, frame.angles.size(), grain, [&](const std::size_t first, const std::size_t last){
+            for(std::size_t k = first; k < last; ++k){
+                frame.angles[k] = std::fmod(frame.angles[k] + 0.5f, 360.0f);
+                frame.rotations[k] = plutom::quatf::from_axis_angle(plutom::radians(frame.angles[k]),
+                                                                    plutom::vec3f{0.0f, 1.0f, 0.0f});
+            }
+        });
+        for(std::size_t k = 0; k < frame.rotations.size(); ++k)
+            transforms.set_rotation(static_cast<TransformGraph::node_id>(k * 2), frame.rotations[k]);
+        transforms.update(&jobs);
+
+        const auto& updated = transforms.get_updated();
+        frame.updatedBounds.resize(updated.size());
+        jobs.parallel_for(0, updated.size(), grain, [&](const std::size_t first, const std::size_t last){
+            for(std::size_t k = first; k < last; ++k){
+                const auto i = updated[k];
+                frame.updatedBounds[k] = plutom::transform_aabb(transforms.get_world(i), frame.localBounds[i]);
+            }
+        });
+        for(std::size_t k = 0; k < updated.size(); ++k) frame.world.set_bounds(updated[k], frame.updatedBounds[k]);
+        frame.world.update(&jobs);
+
+        frame.visible.clear();
+        frame.world.cull(frustum, frame.visible, &jobs);
+        jobs.parallel_for(0, frame.visible.size(), grain, [&](const std::size_t first, const std::size_t last){
+            for(std::size_t k = first; k < last; ++k){
+                const auto i = frame.visible[k];
+                frame.objects[k].model = transforms.get_world(i);
+                frame.objects[k].normalMatrix = transforms.get_world(i).normal_matrix();
+            }
+        });
+        bench::do_not_optimize(frame.objects.data());
+    }
+}
+
+int main(){
+    const unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    const auto viewProj = plutom::perspective(plutom::radians(60.0f), 16.0f / 9.0f, 0.1f, 300.0f) *
+                          plutom::lookAt(plutom::vec3f{0.0f, 0.0f, 0.0f}, plutom::vec3f{0.0f, 0.0f, 1.0f});
+    const auto frustum = plutom::frustumf::from_matrix(viewProj);
+
+    std::printf("%8s %12s %10s %10s\n", "threads", "ms/frame", "speedup", "visible");
+    double single = 0.0;
+    for(unsigned int threads = 1; threads <= maxThreads; ++threads){
+        Frame frame;
+        populate(frame);
+        JobSystem jobs(threads);
+        for(int i = 0; i < 5; ++i) run_frame(frame, jobs, frustum); // warm up, builds the trees
+
+        constexpr int frames = 50;
+        const auto start = std::chrono::steady_clock::now();
+        for(int i = 0; i < frames; ++i) run_frame(frame, jobs, frustum);
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+        if(threads == 1) single = ms;
+        std::printf("%8u %12.3f %9.2fx %10zu\n", threads, ms, single / ms, frame.visible.size());
+    }
+    return 0;
+}
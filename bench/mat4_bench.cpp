@@ -0,0 +1,130 @@
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bench.hpp"
+#include "../src/PlutoMath/plutomath.hpp"
+
+// Compares the generic (scalar) mat4 kernels against the mat4<float> SIMD specialization.
+
+int main(){
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    auto random_mat = [&]{
+        plutom::mat4f m;
+        for(auto& c : m.columns) c = {dist(gen), dist(gen), dist(gen), dist(gen)};
+        return m + plutom::mat4f(4.0f); // keep it well conditioned
+    };
+
+    plutom::mat4f a = random_mat();
+    plutom::mat4f b = random_mat();
+    plutom::mat4f out;
+    plutom::vec4f v{dist(gen), dist(gen), dist(gen), 1.0f};
+    constexpr long N = 20'000'000;
+
+#if defined(PLUTOM_SIMD_AVX)
+    std::printf("backend: AVX\n");
+#elif defined(PLUTOM_SIMD_SSE)
+    std::printf("backend: SSE2\n");
+#else
+    std::printf("backend: scalar\n");
+#endif
+
+    using scalar = plutom::simd::mat4_scalar<float>;
+    using kernels = plutom::simd::mat4_kernels<float>;
+
+    const double mulScalar = bench::run("mat4f multiply (scalar)", N, [&]{
+        scalar::multiply(a.columns, b.columns, out.columns);
+        bench::do_not_optimize(out);
+        bench::do_not_optimize(a);
+    });
+    const double mulSimd = bench::run("mat4f multiply (kernels)", N, [&]{
+        kernels::multiply(a.columns, b.columns, out.columns);
+        bench::do_not_optimize(out);
+        bench::do_not_optimize(a);
+    });
+
+    const double vecScalar = bench::run("mat4f * vec4f (scalar)", N, [&]{
+        auto r = scalar::transform(a.columns, v);
+        bench::do_not_optimize(r);
+        bench::do_not_optimize(v);
+    });
+    const double vecSimd = bench::run("mat4f * vec4f (kernels)", N, [&]{
+        auto r = kernels::transform(a.columns, v);
+        bench::do_not_optimize(r);
+        bench::do_not_optimize(v);
+    });
+
+    const double trScalar = bench::run("mat4f transpose (scalar)", N, [&]{
+        scalar::transpose(a.columns, out.columns);
+        bench::do_not_optimize(out);
+        bench::do_not_optimize(a);
+    });
+    const double trSimd = bench::run("mat4f transpose (kernels)", N, [&]{
+        kernels::transpose(a.columns, out.columns);
+        bench::do_not_optimize(out);
+        bench::do_not_optimize(a);
+    });
+
+    const double invScalar = bench::run("mat4f inverse (adjugate)", N / 10, [&]{
+        out = a.adjugate() / a.determinant();
+        bench::do_not_optimize(out);
+        bench::do_not_optimize(a);
+    });
+    const double invSimd = bench::run("mat4f inverse()", N / 10, [&]{
+        out = a.inverse();
+        bench::do_not_optimize(out);
+        bench::do_not_optimize(a);
+    });
+    bench::run("mat4f inverse (closed form scalar)", N / 10, [&]{
+        scalar::inverse(a.columns, out.columns);
+        bench::do_not_optimize(out);
+        bench::do_not_optimize(a);
+    });
+
+    const plutom::mat4f model = plutom::transform3D::scale(
+        plutom::transform3D::rotate(plutom::transform3D::translate(plutom::mat4f(1.0f), plutom::vec3f(1.0f, 2.0f, 3.0f)),
+                                    0.7f, plutom::vec3f(0.3f, 1.0f, 0.2f)), plutom::vec3f(2.0f, 1.0f, 0.5f));
+    bench::run("mat4f affine_inverse()", N / 10, [&]{
+        out = model.affine_inverse();
+        bench::do_not_optimize(out);
+    });
+    bench::run("mat4f inverse_transpose3x3()", N / 10, [&]{
+        auto n = model.inverse_transpose3x3();
+        bench::do_not_optimize(n);
+    });
+
+    // Throughput over arrays large enough to leave L1, the shape of the per-frame model matrix work
+    constexpr std::size_t count = 1 << 14;
+    std::vector<plutom::mat4f> lhs(count), rhs(count), dst(count);
+    for(std::size_t i = 0; i < count; ++i){
+        lhs[i] = random_mat();
+        rhs[i] = random_mat();
+    }
+    constexpr long passes = 200;
+    // Single calls above sit inside do_not_optimize's stores, the array form is what the kernels are for
+    const double mulArrayScalar = bench::run("mat4f multiply over 16k (scalar)", passes, [&]{
+        for(std::size_t i = 0; i < count; ++i) scalar::multiply(lhs[i].columns, rhs[i].columns, dst[i].columns);
+        bench::do_not_optimize(dst.data());
+    });
+    const double mulArrayKernels = bench::run("mat4f multiply over 16k (kernels)", passes, [&]{
+        for(std::size_t i = 0; i < count; ++i) kernels::multiply(lhs[i].columns, rhs[i].columns, dst[i].columns);
+        bench::do_not_optimize(dst.data());
+    });
+    const double mulArray = bench::run("mat4f multiply over 16k matrices", passes, [&]{
+        for(std::size_t i = 0; i < count; ++i) dst[i] = lhs[i] * rhs[i];
+        bench::do_not_optimize(dst.data());
+    });
+    const double invArray = bench::run("mat4f inverse over 16k matrices", passes / 4, [&]{
+        for(std::size_t i = 0; i < count; ++i) dst[i] = lhs[i].inverse();
+        bench::do_not_optimize(dst.data());
+    });
+    std::printf("throughput: multiply %.1f M/s, inverse %.1f M/s (checked indexing: %s)\n",
+                static_cast<double>(count) * 1e3 / mulArray, static_cast<double>(count) * 1e3 / invArray,
+                PLUTOM_CHECKED_INDEXING ? "on" : "off");
+
+    std::printf("\nspeedup multiply %.2fx (%.2fx over 16k), mat*vec %.2fx, transpose %.2fx, inverse %.2fx\n",
+                mulScalar / mulSimd, mulArrayScalar / mulArrayKernels, vecScalar / vecSimd, trScalar / trSimd,
+                invScalar / invSimd);
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "bench.hpp"
+#include "../src/util/mesh_optimizer.hpp"
+#include "../src/util/pmesh_format.hpp"
+
+// Mesh optimizer cost and effect on UV spheres of growing size, with triangles shuffled like a
+// careless exporter would leave them and every vertex duplicated for the weld to find. ACMR and
+// ATVR are simulated on the default 16 entry FIFO cache.
+// Usage: pluto_bench_mesh [max triangles], 1M by default.
+
+namespace {
+    struct Mesh {
+        std::vector<PackedVertex> vertices;
+        std::vector<unsigned int> indices;
+    };
+
+    Mesh make_sphere(const int rings, const int segments){
+        Mesh mesh;
+        for(int i = 0; i <= rings; ++i){
+            for(int j = 0; j <= segments; ++j){
+                const float theta = 3.14159265f * static_cast<float>(i) / static_cast<float>(rings);
+                const float phi = 6.28318531f * static_cast<float>(j) / static_cast<float>(segments);
+                const float x = std::sin(theta) * std::cos(phi), y = std::cos(theta), z = std::sin(theta) * std::sin(phi);
+                const float vertex[8] = {x, y, z, x, y, z, static_cast<float>(j) / static_cast<float>(segments),
+                                         static_cast<float>(i) / static_cast<float>(rings)};
+                mesh.vertices.push_back(pack_vertex(vertex));
+            }
+        }
+        const auto count = static_cast<unsigned int>(mesh.vertices.size());
+        mesh.vertices.insert(mesh.vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+
+        std::vector<unsigned int> triangles;
+        for(int i = 0; i < rings; ++i){
+            for(int j = 0; j < segments; ++j){
+                const auto a = static_cast<unsigned int>(i * (segments + 1) + j);
+                const auto b = a + static_cast<unsigned int>(segments + 1);
+                // The second triangle of each quad uses the duplicated vertices
+                const unsigned int quad[6] = {a, b, a + 1, a + 1 + count, b + count, b + 1 + count};
+                triangles.insert(triangles.end(), quad, quad + 6);
+            }
+        }
+        std::vector<unsigned int> order(triangles.size() / 3);
+        for(std::size_t t = 0; t < order.size(); ++t) order[t] = static_cast<unsigned int>(t);
+        std::shuffle(order.begin(), order.end(), std::mt19937(7));
+        for(const unsigned int t : order) mesh.indices.insert(mesh.indices.end(), &triangles[t * 3], &triangles[t * 3 + 3]);
+        return mesh;
+    }
+
+    template<typename Fn>
+    double time_ms(Fn&& fn){
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv){
+    const long maxTriangles = argc > 1 ? std::atol(argv[1]) : 1000000;
+
+    std::printf("%10s %10s %8s %8s %8s %8s %8s %10s %10s %10s %10s\n", "triangles", "vertices", "welded", "ACMR in",
+                "tipsify", "full", "ATVR", "weld ms", "cache ms", "overdraw", "fetch ms");
+    for(long triangles = 1000; triangles <= maxTriangles; triangles *= 10){
+        const int rings = std::max(2, static_cast<int>(std::sqrt(static_cast<double>(triangles) / 4.0)));
+        Mesh mesh = make_sphere(rings, rings * 2);
+        const std::size_t indexCount = mesh.indices.size();
+        const VertexCacheStats input = mesh_optimizer::analyze_vertex_cache(mesh.indices.data(), indexCount,
+                                                                           mesh.vertices.size());
+
+        std::size_t welded = 0;
+        std::vector<unsigned int> clusters;
+        const double weldMs = time_ms([&]{
+            welded = mesh_optimizer::weld_vertices(mesh.vertices.data(), mesh.vertices.size(), sizeof(PackedVertex),
+                                                   mesh.indices.data(), indexCount);
+        });
+        const double cacheMs = time_ms([&]{
+            mesh_optimizer::optimize_vertex_cache(mesh.indices.data(), indexCount, welded,
+                                                  mesh_optimizer::DEFAULT_CACHE_SIZE, &clusters);
+        });
+        const VertexCacheStats tipsify = mesh_optimizer::analyze_vertex_cache(mesh.indices.data(), indexCount, welded);
+        const double overdrawMs = time_ms([&]{
+            mesh_optimizer::optimize_overdraw(mesh.indices.data(), indexCount, mesh.vertices.data(), welded,
+                                              sizeof(PackedVertex), clusters);
+        });
+        std::size_t fetched = 0;
+        const double fetchMs = time_ms([&]{
+            fetched = mesh_optimizer::optimize_vertex_fetch(mesh.vertices.data(), welded, sizeof(PackedVertex),
+                                                            mesh.indices.data(), indexCount);
+        });
+        const VertexCacheStats full = mesh_optimizer::analyze_vertex_cache(mesh.indices.data(), indexCount, fetched);
+        bench::do_not_optimize(mesh.indices.data());
+
+        std::printf("%10zu %10zu %8zu %8.3f %8.3f %8.3f %8.3f %10.2f %10.2f %10.2f %10.2f\n", indexCount / 3,
+                    mesh.vertices.size(), welded, input.acmr, tipsify.acmr, full.acmr, full.atvr, weldMs, cacheMs,
+                    overdrawMs, fetchMs);
+    }
+    return 0;
+}
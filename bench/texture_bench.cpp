@@ -0,0 +1,88 @@
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "../src/util/block_codec.hpp"
+#include "../src/util/mapped_file.hpp"
+#include "../src/util/ptex_format.hpp"
+
+// Texture load cost on the CPU: decoding the source image with stb_image, as the TextureManager
+// does for PNG/JPEG, against mapping the cooked .ptex and reading its pages in. Also the memory
+// each takes with a full mip chain. The GPU side (glGenerateMipmap against uploading prebuilt
+// levels) needs a context and is not measured here.
+// Usage: pluto_bench_texture [image...], the images in res/ by default.
+
+namespace {
+    constexpr int iterations = 50;
+
+    // Cooked as pluto_cook does by default: flipped, the format picked by alpha, all mips
+    bool write_ptex(const std::string& source, const std::string& path){
+        int width, height, channels;
+        stbi_set_flip_vertically_on_load(true);
+        std::uint8_t* pixels = stbi_load(source.c_str(), &width, &height, &channels, 4);
+        if(!pixels) return false;
+        const bool written = ptex_writer::write(path, pixels, width, height,
+                                                ptex_writer::pick_format(pixels, width, height), true);
+        stbi_image_free(pixels);
+        return written;
+    }
+
+    template<typename Fn>
+    double time_ms(Fn&& fn){
+        fn(); // warm up, and the file cache
+        const auto start = std::chrono::steady_clock::now();
+        for(int i = 0; i < iterations; ++i) fn();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+    }
+}
+
+int main(int argc, char** argv){
+    std::vector<std::string> images;
+    for(int i = 1; i < argc; ++i) images.emplace_back(argv[i]);
+    if(images.empty()){
+        images.push_back(std::string(PLUTO_SOURCE_DIR) + "/res/awesomeface.png");
+        images.push_back(std::string(PLUTO_SOURCE_DIR) + "/res/wall.jpg");
+    }
+
+    std::printf("%-20s %10s %10s %9s %12s %12s %7s\n", "image", "stb ms", "ptex ms", "speedup", "rgba+mips", "ptex bytes",
+                "ratio");
+    for(const auto& image : images){
+        const std::string ptexPath = (std::filesystem::temp_directory_path() /
+                                      (std::filesystem::path(image).stem().string() + ".bench.ptex")).string();
+        if(!write_ptex(image, ptexPath)){
+            std::printf("%-20s could not be loaded\n", image.c_str());
+            continue;
+        }
+
+        int width = 0, height = 0, channels = 0;
+        const double stbMs = time_ms([&]{
+            stbi_set_flip_vertically_on_load(true);
+            std::uint8_t* pixels = stbi_load(image.c_str(), &width, &height, &channels, 0);
+            bench::do_not_optimize(pixels);
+            stbi_image_free(pixels);
+        });
+        std::size_t ptexBytes = 0;
+        const double ptexMs = time_ms([&]{
+            MappedFile file(ptexPath);
+            PtexView view;
+            if(!view.parse(file.data(), file.size())) return;
+            file.prefetch();
+            ptexBytes = file.size();
+        });
+        // GL keeps 3 channel textures as RGBX, the mip chain adds a third
+        const std::size_t rgbaBytes = static_cast<std::size_t>(width) * height * 4 * 4 / 3;
+        std::printf("%-20s %10.3f %10.3f %8.1fx %12zu %12zu %6.1fx\n",
+                    std::filesystem::path(image).filename().string().c_str(), stbMs, ptexMs, stbMs / ptexMs, rgbaBytes,
+                    ptexBytes, static_cast<double>(rgbaBytes) / static_cast<double>(ptexBytes));
+        std::filesystem::remove(ptexPath);
+    }
+    return 0;
+}
@@ -4,11 +4,22 @@ layout (location = 1) in vec3 aColor;
 
 out vec3 vertexColor;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#define MAX_LIGHTS 8
+struct Light {
+    vec4 position;
+    vec4 color;
+};
+
+layout (std140, binding = 0) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;
+    vec4 viewPos;
+    Light lights[MAX_LIGHTS];
+    int lightCount;
+};
 
 void main() {
     vertexColor = aColor;
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = viewProj * vec4(aPos, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+#version 460 core
+#ifdef PLUTO_BINDLESS_TEXTURES
+#extension GL_ARB_bindless_texture : require
+#endif
+in vec3 Normal;
+in vec3 FragPos;
+in vec2 TexCoord;
+flat in vec4 ObjectColor;
+flat in uvec4 ObjectTexture; // layer, bindless handle low and high, flags
+
+out vec4 FragColor;
+
+#define MAX_LIGHTS 8
+struct Light {
+    vec4 position;
+    vec4 color;
+};
+
+layout (std140, binding = 0) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;
+    vec4 viewPos;
+    Light lights[MAX_LIGHTS];
+    int lightCount;
+};
+
+#define MATERIAL_TEXTURED 1u
+
+#ifndef PLUTO_BINDLESS_TEXTURES
+// Every material texture is a layer, bound once a frame to MATERIAL_TEXTURE_UNIT
+layout (binding = 0) uniform sampler2DArray materialTextures;
+#endif
+
+vec3 material_color(){
+    if ((ObjectTexture.w & MATERIAL_TEXTURED) == 0u) return ObjectColor.rgb;
+#ifdef PLUTO_BINDLESS_TEXTURES
+    vec4 texel = texture(sampler2D(ObjectTexture.yz), TexCoord);
+#else
+    vec4 texel = texture(materialTextures, vec3(TexCoord, float(ObjectTexture.x)));
+#endif
+    return texel.rgb * ObjectColor.rgb;
+}
+
+void main(){
+    float ambientStrength = 0.1;
+    float specularStrength = 0.5;
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
+    float shine = ObjectColor.w;
+    vec3 result = vec3(0.0);
+    for (int i = 0; i < lightCount; ++i) {
+        vec3 lightColor = lights[i].color.rgb;
+        vec3 lightDir = normalize(lights[i].position.xyz - FragPos);
+        vec3 reflectDir = reflect(-lightDir, norm);
+        vec3 ambient = ambientStrength * lightColor;
+        float diff = max(dot(norm, lightDir), 0.0);
+        vec3 diffuse = diff * lightColor;
+        float spec = pow(max(dot(viewDir, reflectDir), 0.0), shine);
+        vec3 specular = specularStrength * spec * lightColor;
+        result += ambient + diffuse + specular;
+    }
+    FragColor = vec4(result * material_color(), 1.0);
+}
\ No newline at end of file
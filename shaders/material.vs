@@ -0,0 +1,47 @@
+#version 460 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+out vec3 Normal;
+out vec3 FragPos;
+out vec2 TexCoord;
+flat out vec4 ObjectColor;
+flat out uvec4 ObjectTexture;
+
+#define MAX_LIGHTS 8
+struct Light {
+    vec4 position;
+    vec4 color;
+};
+
+layout (std140, binding = 0) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;
+    vec4 viewPos;
+    Light lights[MAX_LIGHTS];
+    int lightCount;
+};
+
+struct ObjectData {
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 color; // rgb, shininess in w
+    uvec4 texture; // layer, bindless handle low and high, flags
+};
+
+layout (std430, binding = 1) readonly buffer ObjectBuffer {
+    ObjectData objects[];
+};
+
+void main(){
+    ObjectData object = objects[gl_BaseInstance + gl_InstanceID];
+    vec4 worldPos = object.model * vec4(aPos, 1.0);
+    gl_Position = viewProj * worldPos;
+    FragPos = worldPos.xyz;
+    Normal = mat3(object.normalMatrix) * aNormal; // transpose(inverse(mat3(model))), computed on the CPU
+    TexCoord = aTexCoord;
+    ObjectColor = object.color;
+    ObjectTexture = object.texture;
+}
\ No newline at end of file
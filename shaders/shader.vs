@@ -3,12 +3,37 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
 
 out vec2 TexCoord;
+flat out vec4 ObjectColor;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#define MAX_LIGHTS 8
+struct Light {
+    vec4 position;
+    vec4 color;
+};
+
+layout (std140, binding = 0) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;
+    vec4 viewPos;
+    Light lights[MAX_LIGHTS];
+    int lightCount;
+};
+
+struct ObjectData {
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 color; // rgb, shininess in w
+    uvec4 texture; // layer, bindless handle low and high, flags
+};
+
+layout (std430, binding = 1) readonly buffer ObjectBuffer {
+    ObjectData objects[];
+};
 
 void main(){
-    gl_Position = projection * view * model * vec4(aPos, 1.0f);
+    ObjectData object = objects[gl_BaseInstance + gl_InstanceID];
+    gl_Position = viewProj * object.model * vec4(aPos, 1.0f);
     TexCoord = aTexCoord;
+    ObjectColor = object.color;
 }
\ No newline at end of file
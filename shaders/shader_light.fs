@@ -1,27 +1,42 @@
 #version 460 core
 in vec3 Normal;
 in vec3 FragPos;
+flat in vec4 ObjectColor;
 
 out vec4 FragColor;
 
-uniform vec3 objectColor;
-uniform vec3 lightColor;
-uniform vec3 lightPos;
-uniform vec3 viewPos;
-uniform float shine;
+#define MAX_LIGHTS 8
+struct Light {
+    vec4 position;
+    vec4 color;
+};
+
+layout (std140, binding = 0) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;
+    vec4 viewPos;
+    Light lights[MAX_LIGHTS];
+    int lightCount;
+};
 
 void main(){
     float ambientStrength = 0.1;
     float specularStrength = 0.5;
-    vec3 ambient = ambientStrength * lightColor;
     vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(lightPos - FragPos);
-    vec3 viewDir = normalize(viewPos - FragPos);
-    vec3 reflectDir = reflect(-lightDir, norm);
-    float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = diff * lightColor;
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shine);
-    vec3 specular = specularStrength * spec * lightColor;
-    vec3 result = (ambient + diffuse + specular) * objectColor;
-    FragColor = vec4(result, 1.0);
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
+    float shine = ObjectColor.w;
+    vec3 result = vec3(0.0);
+    for (int i = 0; i < lightCount; ++i) {
+        vec3 lightColor = lights[i].color.rgb;
+        vec3 lightDir = normalize(lights[i].position.xyz - FragPos);
+        vec3 reflectDir = reflect(-lightDir, norm);
+        vec3 ambient = ambientStrength * lightColor;
+        float diff = max(dot(norm, lightDir), 0.0);
+        vec3 diffuse = diff * lightColor;
+        float spec = pow(max(dot(viewDir, reflectDir), 0.0), shine);
+        vec3 specular = specularStrength * spec * lightColor;
+        result += ambient + diffuse + specular;
+    }
+    FragColor = vec4(result * ObjectColor.rgb, 1.0);
 }
\ No newline at end of file
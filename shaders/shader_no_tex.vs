@@ -4,13 +4,39 @@ layout (location = 1) in vec3 aNormal;
 
 out vec3 Normal;
 out vec3 FragPos;
+flat out vec4 ObjectColor;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#define MAX_LIGHTS 8
+struct Light {
+    vec4 position;
+    vec4 color;
+};
+
+layout (std140, binding = 0) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;
+    vec4 viewPos;
+    Light lights[MAX_LIGHTS];
+    int lightCount;
+};
+
+struct ObjectData {
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 color; // rgb, shininess in w
+    uvec4 texture; // layer, bindless handle low and high, flags
+};
+
+layout (std430, binding = 1) readonly buffer ObjectBuffer {
+    ObjectData objects[];
+};
 
 void main(){
-    gl_Position = projection * view * model * vec4(aPos, 1.0f);
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    ObjectData object = objects[gl_BaseInstance + gl_InstanceID];
+    vec4 worldPos = object.model * vec4(aPos, 1.0);
+    gl_Position = viewProj * worldPos;
+    FragPos = worldPos.xyz;
+    Normal = mat3(object.normalMatrix) * aNormal; // transpose(inverse(mat3(model))), computed on the CPU
+    ObjectColor = object.color;
 }
\ No newline at end of file
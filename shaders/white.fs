@@ -1,8 +1,8 @@
 #version 460 core
-out vec4 FragColor;
+flat in vec4 ObjectColor;
 
-uniform vec3 color;
+out vec4 FragColor;
 
 void main(){
-    FragColor = vec4(color, 1.0);
+    FragColor = vec4(ObjectColor.rgb, 1.0);
 }
\ No newline at end of file
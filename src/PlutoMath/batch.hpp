@@ -0,0 +1,292 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "vec3.hpp"
+#include "mat4.hpp"
+#include "bounds.hpp"
+#include "quat.hpp"
+
+#if defined(_MSC_VER)
+    #define PLUTOM_RESTRICT __restrict
+#else
+    #define PLUTOM_RESTRICT __restrict__
+#endif
+
+namespace plutom{
+
+    /*  Structure-of-arrays storage for many translate/rotate/scale transforms.
+        Entry i describes translate(position) * rotate(angle, axis) * scale(scale) with the same
+        conventions as transform3D: angle in radians, counter-clockwise around the axis. Axes are
+        normalized once when they are stored instead of every time a matrix is built.
+     */
+    template<typename T>
+    struct transform_batch{
+        std::vector<T> px, py, pz;
+        std::vector<T> ax, ay, az, angle;
+        std::vector<T> sx, sy, sz;
+
+        std::size_t size() const{
+            return px.size();
+        }
+
+        void resize(std::size_t count){
+            for(auto* v : {&px, &py, &pz, &ax, &ay, &az, &angle}) v->resize(count, T(0));
+            for(auto* v : {&sx, &sy, &sz}) v->resize(count, T(1));
+        }
+
+        void reserve(std::size_t count){
+            for(auto* v : {&px, &py, &pz, &ax, &ay, &az, &angle, &sx, &sy, &sz}) v->reserve(count);
+        }
+
+        void clear(){
+            resize(0);
+        }
+
+        void set(std::size_t i, const vec3<T>& position, T theta, const vec3<T>& axis, const vec3<T>& scale){
+            set_position(i, position);
+            set_rotation(i, theta, axis);
+            set_scale(i, scale);
+        }
+
+        std::size_t push_back(const vec3<T>& position, T theta, const vec3<T>& axis, const vec3<T>& scale){
+            const std::size_t i = size();
+            resize(i + 1);
+            set(i, position, theta, axis, scale);
+            return i;
+        }
+
+        void set_position(std::size_t i, const vec3<T>& position){
+            px[i] = position.x;
+            py[i] = position.y;
+            pz[i] = position.z;
+        }
+
+        void set_rotation(std::size_t i, T theta, const vec3<T>& axis){
+            const vec3<T> n = axis.normalize();
+            ax[i] = n.x;
+            ay[i] = n.y;
+            az[i] = n.z;
+            angle[i] = theta;
+        }
+
+        void set_rotation(std::size_t i, const quat<T>& q){
+            T theta;
+            vec3<T> axis;
+            q.to_axis_angle(theta, axis);
+            ax[i] = axis.x;
+            ay[i] = axis.y;
+            az[i] = axis.z;
+            angle[i] = theta;
+        }
+
+        // Only the angle changes for objects spinning around a fixed axis
+        void set_angle(std::size_t i, T theta){
+            angle[i] = theta;
+        }
+
+        void set_scale(std::size_t i, const vec3<T>& scale){
+            sx[i] = scale.x;
+            sy[i] = scale.y;
+            sz[i] = scale.z;
+        }
+    };
+
+    using transform_batchf = transform_batch<float>;
+    using transform_batchd = transform_batch<double>;
+
+    namespace detail{
+        /*  Branch free sine/cosine for the batch kernels so the compose loop vectorizes.
+            Cody-Waite reduction to [-pi/4, pi/4] followed by the Cephes minimax polynomials,
+            accurate to a few ulp for |x| < 8192. Doubles go through the standard library.
+         */
+        template<typename T>
+        inline void sincos(T x, T& s, T& c){
+            if constexpr (std::is_same_v<T, float>){
+                const float y = x * 0.63661977236758134f; // 2/pi
+                const int32_t q = static_cast<int32_t>(y + (y >= 0.0f ? 0.5f : -0.5f));
+                const float qf = static_cast<float>(q);
+                float r = x - qf * 1.5703125f;
+                r = r - qf * 4.837512969970703125e-4f;
+                r = r - qf * 7.549789948768648e-8f;
+                const float r2 = r * r;
+                const float ps = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+                const float pc = 1.0f - 0.5f * r2 + r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+                const bool swap = (q & 1) != 0;
+                const float sinv = swap ? pc : ps;
+                const float cosv = swap ? ps : pc;
+                s = (q & 2) ? -sinv : sinv;
+                c = ((q + 1) & 2) ? -cosv : cosv;
+            }else{
+                s = std::sin(x);
+                c = std::cos(x);
+            }
+        }
+    }
+
+    namespace detail{
+        template<typename T>
+        void compose_trs(const transform_batch<T>& batch, mat4<T>* PLUTOM_RESTRICT out, std::size_t begin, std::size_t end){
+            const T* PLUTOM_RESTRICT px = batch.px.data();
+            const T* PLUTOM_RESTRICT py = batch.py.data();
+            const T* PLUTOM_RESTRICT pz = batch.pz.data();
+            const T* PLUTOM_RESTRICT ax = batch.ax.data();
+            const T* PLUTOM_RESTRICT ay = batch.ay.data();
+            const T* PLUTOM_RESTRICT az = batch.az.data();
+            const T* PLUTOM_RESTRICT an = batch.angle.data();
+            const T* PLUTOM_RESTRICT sx = batch.sx.data();
+            const T* PLUTOM_RESTRICT sy = batch.sy.data();
+            const T* PLUTOM_RESTRICT sz = batch.sz.data();
+
+            for(std::size_t i = begin; i < end; ++i){
+                T s, c;
+                detail::sincos(an[i], s, c);
+                const T oc = T(1) - c;
+                const T x = ax[i], y = ay[i], z = az[i];
+                const T xy = x * y * oc, xz = x * z * oc, yz = y * z * oc;
+
+                out[i].columns[0] = {(x * x * oc + c) * sx[i], (xy + z * s) * sx[i], (xz - y * s) * sx[i], T(0)};
+                out[i].columns[1] = {(xy - z * s) * sy[i], (y * y * oc + c) * sy[i], (yz + x * s) * sy[i], T(0)};
+                out[i].columns[2] = {(xz + y * s) * sz[i], (yz - x * s) * sz[i], (z * z * oc + c) * sz[i], T(0)};
+                out[i].columns[3] = {px[i], py[i], pz[i], T(1)};
+            }
+        }
+
+#if defined(PLUTOM_SIMD_SSE)
+        // Four objects per iteration: every matrix element is computed for all four in one register,
+        // then each group of four registers is transposed into columns before the store.
+        inline std::size_t compose_trs_sse(const transform_batch<float>& batch, mat4<float>* out){
+            const std::size_t count = batch.size() & ~std::size_t(3);
+            const __m128 one = _mm_set1_ps(1.0f);
+            for(std::size_t i = 0; i < count; i += 4){
+                __m128 s, c;
+                simd::sincos(_mm_loadu_ps(&batch.angle[i]), s, c);
+                const __m128 oc = _mm_sub_ps(one, c);
+                const __m128 x = _mm_loadu_ps(&batch.ax[i]);
+                const __m128 y = _mm_loadu_ps(&batch.ay[i]);
+                const __m128 z = _mm_loadu_ps(&batch.az[i]);
+                const __m128 sx = _mm_loadu_ps(&batch.sx[i]);
+                const __m128 sy = _mm_loadu_ps(&batch.sy[i]);
+                const __m128 sz = _mm_loadu_ps(&batch.sz[i]);
+                const __m128 xy = _mm_mul_ps(_mm_mul_ps(x, y), oc);
+                const __m128 xz = _mm_mul_ps(_mm_mul_ps(x, z), oc);
+                const __m128 yz = _mm_mul_ps(_mm_mul_ps(y, z), oc);
+                const __m128 xs = _mm_mul_ps(x, s);
+                const __m128 ys = _mm_mul_ps(y, s);
+                const __m128 zs = _mm_mul_ps(z, s);
+
+                __m128 c0[4] = {_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(x, x), oc), c), sx),
+                                _mm_mul_ps(_mm_add_ps(xy, zs), sx),
+                                _mm_mul_ps(_mm_sub_ps(xz, ys), sx),
+                                _mm_setzero_ps()};
+                __m128 c1[4] = {_mm_mul_ps(_mm_sub_ps(xy, zs), sy),
+                                _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(y, y), oc), c), sy),
+                                _mm_mul_ps(_mm_add_ps(yz, xs), sy),
+                                _mm_setzero_ps()};
+                __m128 c2[4] = {_mm_mul_ps(_mm_add_ps(xz, ys), sz),
+                                _mm_mul_ps(_mm_sub_ps(yz, xs), sz),
+                                _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(z, z), oc), c), sz),
+                                _mm_setzero_ps()};
+                __m128 c3[4] = {_mm_loadu_ps(&batch.px[i]), _mm_loadu_ps(&batch.py[i]), _mm_loadu_ps(&batch.pz[i]), one};
+                _MM_TRANSPOSE4_PS(c0[0], c0[1], c0[2], c0[3]);
+                _MM_TRANSPOSE4_PS(c1[0], c1[1], c1[2], c1[3]);
+                _MM_TRANSPOSE4_PS(c2[0], c2[1], c2[2], c2[3]);
+                _MM_TRANSPOSE4_PS(c3[0], c3[1], c3[2], c3[3]);
+                for(int k = 0; k < 4; ++k){
+                    _mm_store_ps(&out[i + k].columns[0].x, c0[k]);
+                    _mm_store_ps(&out[i + k].columns[1].x, c1[k]);
+                    _mm_store_ps(&out[i + k].columns[2].x, c2[k]);
+                    _mm_store_ps(&out[i + k].columns[3].x, c3[k]);
+                }
+            }
+            return count;
+        }
+#endif
+    }
+
+    // out[i] = translate(p[i]) * rotate(angle[i], axis[i]) * scale(s[i]) for every entry of the batch,
+    // written directly without the intermediate 4x4 products. out must hold batch.size() matrices.
+    template<typename T>
+    void compose_trs(const transform_batch<T>& batch, mat4<T>* out){
+        std::size_t done = 0;
+#if defined(PLUTOM_SIMD_SSE)
+        if constexpr (std::is_same_v<T, float>) done = detail::compose_trs_sse(batch, out);
+#endif
+        detail::compose_trs(batch, out, done, batch.size());
+    }
+
+    template<typename T>
+    void compose_trs(const transform_batch<T>& batch, std::vector<mat4<T>>& out){
+        out.resize(batch.size());
+        compose_trs(batch, out.data());
+    }
+
+    // out[i] = (m * vec4(in[i], 1)).xyz, assumes m is affine. in and out may be the same array.
+    template<typename T>
+    void transform_points(const mat4<T>& m, const vec3<T>* in, vec3<T>* out, std::size_t count){
+        const vec4<T> c0 = m.columns[0], c1 = m.columns[1], c2 = m.columns[2], c3 = m.columns[3];
+        for(std::size_t i = 0; i < count; ++i){
+            const T x = in[i].x, y = in[i].y, z = in[i].z;
+            out[i] = {c0.x * x + c1.x * y + c2.x * z + c3.x,
+                      c0.y * x + c1.y * y + c2.y * z + c3.y,
+                      c0.z * x + c1.z * y + c2.z * z + c3.z};
+        }
+    }
+
+    template<typename T>
+    void transform_points(const mat4<T>& m, const std::vector<vec3<T>>& in, std::vector<vec3<T>>& out){
+        out.resize(in.size());
+        transform_points(m, in.data(), out.data(), in.size());
+    }
+
+    namespace detail{
+        // World space bounds of a local box under an affine matrix (Arvo's method): the center is
+        // transformed, the extent is carried through the absolute value of the 3x3 block.
+        template<typename T>
+        inline void transform_aabb(const mat4<T>& m, const aabb<T>& box, aabb<T>& out){
+            const T cx = (box.min.x + box.max.x) * T(0.5), ex = (box.max.x - box.min.x) * T(0.5);
+            const T cy = (box.min.y + box.max.y) * T(0.5), ey = (box.max.y - box.min.y) * T(0.5);
+            const T cz = (box.min.z + box.max.z) * T(0.5), ez = (box.max.z - box.min.z) * T(0.5);
+            const vec4<T>& c0 = m.columns[0];
+            const vec4<T>& c1 = m.columns[1];
+            const vec4<T>& c2 = m.columns[2];
+            const vec4<T>& c3 = m.columns[3];
+            const T wx = c0.x * cx + c1.x * cy + c2.x * cz + c3.x;
+            const T wy = c0.y * cx + c1.y * cy + c2.y * cz + c3.y;
+            const T wz = c0.z * cx + c1.z * cy + c2.z * cz + c3.z;
+            const T rx = std::abs(c0.x) * ex + std::abs(c1.x) * ey + std::abs(c2.x) * ez;
+            const T ry = std::abs(c0.y) * ex + std::abs(c1.y) * ey + std::abs(c2.y) * ez;
+            const T rz = std::abs(c0.z) * ex + std::abs(c1.z) * ey + std::abs(c2.z) * ez;
+            out.min.x = wx - rx;
+            out.min.y = wy - ry;
+            out.min.z = wz - rz;
+            out.max.x = wx + rx;
+            out.max.y = wy + ry;
+            out.max.z = wz + rz;
+        }
+    }
+
+    // World space bounds of a local box under an affine matrix
+    template<typename T>
+    aabb<T> transform_aabb(const mat4<T>& m, const aabb<T>& box){
+        aabb<T> out;
+        detail::transform_aabb(m, box, out);
+        return out;
+    }
+
+    // out[i] = bounds of in[i] under matrices[i]
+    template<typename T>
+    void transform_aabbs(const mat4<T>* matrices, const aabb<T>* in, aabb<T>* out, std::size_t count){
+        for(std::size_t i = 0; i < count; ++i) detail::transform_aabb(matrices[i], in[i], out[i]);
+    }
+
+    // out[i] = bounds of in[i] under a single matrix
+    template<typename T>
+    void transform_aabbs(const mat4<T>& m, const aabb<T>* in, aabb<T>* out, std::size_t count){
+        for(std::size_t i = 0; i < count; ++i) detail::transform_aabb(m, in[i], out[i]);
+    }
+}
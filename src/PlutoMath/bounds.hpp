@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include "vec3.hpp"
+
+namespace plutom{
+
+    // Axis aligned bounding box. Default constructed boxes are empty (min > max) so that
+    // expanding them by the first point or box yields exactly that point or box.
+    template<typename T>
+    struct aabb{
+        vec3<T> min;
+        vec3<T> max;
+
+        constexpr aabb() : min(std::numeric_limits<T>::max()), max(std::numeric_limits<T>::lowest()) {}
+        constexpr aabb(const vec3<T>& min, const vec3<T>& max) : min(min), max(max) {}
+
+        constexpr bool empty() const{
+            return min.x > max.x || min.y > max.y || min.z > max.z;
+        }
+
+        constexpr vec3<T> center() const{
+            return (min + max) * T(0.5);
+        }
+
+        // Half size along each axis
+        constexpr vec3<T> extent() const{
+            return (max - min) * T(0.5);
+        }
+
+        // Total area of the six faces, the SAH weight of the box. Meaningless for empty boxes.
+        constexpr T surface_area() const{
+            const vec3<T> d = max - min;
+            return T(2) * (d.x * d.y + d.y * d.z + d.z * d.x);
+        }
+
+        constexpr void expand(const vec3<T>& p){
+            min = {std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z)};
+            max = {std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z)};
+        }
+
+        constexpr void expand(const aabb& other){
+            min = {std::min(min.x, other.min.x), std::min(min.y, other.min.y), std::min(min.z, other.min.z)};
+            max = {std::max(max.x, other.max.x), std::max(max.y, other.max.y), std::max(max.z, other.max.z)};
+        }
+
+        constexpr bool contains(const vec3<T>& p) const{
+            return  p.x >= min.x && p.x <= max.x &&
+                    p.y >= min.y && p.y <= max.y &&
+                    p.z >= min.z && p.z <= max.z;
+        }
+
+        constexpr bool intersects(const aabb& other) const{
+            return  min.x <= other.max.x && max.x >= other.min.x &&
+                    min.y <= other.max.y && max.y >= other.min.y &&
+                    min.z <= other.max.z && max.z >= other.min.z;
+        }
+    };
+
+    using aabbf = aabb<float>;
+    using aabbd = aabb<double>;
+}
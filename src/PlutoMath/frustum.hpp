@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "vec3.hpp"
+#include "vec4.hpp"
+#include "mat4.hpp"
+#include "bounds.hpp"
+#include "simd.hpp"
+
+namespace plutom{
+
+    // Points p with normal.dot(p) + d >= 0 are on the inside
+    template<typename T>
+    struct plane{
+        vec3<T> normal;
+        T d;
+
+        constexpr T distance(const vec3<T>& p) const{
+            return normal.dot(p) + d;
+        }
+    };
+
+    /*  View frustum as six inward facing planes: left, right, bottom, top, near, far.
+        from_matrix() extracts them from a projection * view matrix (Gribb/Hartmann), so the
+        planes are in whatever space the matrix maps from, world space for proj * view.
+     */
+    template<typename T>
+    struct frustum{
+        plane<T> planes[6];
+
+        static frustum from_matrix(const mat4<T>& m){
+            static_assert(std::is_floating_point_v<T>, "from_matrix() only available for float/double types");
+            // Rows of the column-major matrix
+            const vec4<T> r0{m.columns[0].x, m.columns[1].x, m.columns[2].x, m.columns[3].x};
+            const vec4<T> r1{m.columns[0].y, m.columns[1].y, m.columns[2].y, m.columns[3].y};
+            const vec4<T> r2{m.columns[0].z, m.columns[1].z, m.columns[2].z, m.columns[3].z};
+            const vec4<T> r3{m.columns[0].w, m.columns[1].w, m.columns[2].w, m.columns[3].w};
+            const vec4<T> raw[6] = {r3 + r0, r3 - r0, r3 + r1, r3 - r1, r3 + r2, r3 - r2};
+            frustum result;
+            for(int i = 0; i < 6; ++i){
+                const vec3<T> n{raw[i].x, raw[i].y, raw[i].z};
+                const T len = n.length();
+                const T inv = len > T(0) ? T(1) / len : T(0);
+                result.planes[i] = {n * inv, raw[i].w * inv};
+            }
+            return result;
+        }
+
+        // Conservative: boxes straddling a corner outside the frustum can still pass
+        bool intersects(const aabb<T>& box) const{
+            const vec3<T> c = box.center();
+            const vec3<T> e = box.extent();
+            for(const auto& p : planes){
+                const T r = e.x * std::abs(p.normal.x) + e.y * std::abs(p.normal.y) + e.z * std::abs(p.normal.z);
+                if(p.distance(c) + r < T(0)) return false;
+            }
+            return true;
+        }
+
+        constexpr bool intersects_sphere(const vec3<T>& center, T radius) const{
+            for(const auto& p : planes){
+                if(p.distance(center) < -radius) return false;
+            }
+            return true;
+        }
+    };
+
+    /*  Structure-of-arrays boxes in center/extent form, the layout the batched frustum test reads.
+        Extents are half sizes.
+     */
+    template<typename T>
+    struct aabb_batch{
+        std::vector<T> cx, cy, cz;
+        std::vector<T> ex, ey, ez;
+
+        std::size_t size() const{
+            return cx.size();
+        }
+
+        void resize(std::size_t n){
+            cx.resize(n); cy.resize(n); cz.resize(n);
+            ex.resize(n); ey.resize(n); ez.resize(n);
+        }
+
+        void set(std::size_t i, const aabb<T>& box){
+            const vec3<T> c = box.center();
+            const vec3<T> e = box.extent();
+            cx[i] = c.x; cy[i] = c.y; cz[i] = c.z;
+            ex[i] = e.x; ey[i] = e.y; ez[i] = e.z;
+        }
+
+        void assign(const aabb<T>* boxes, std::size_t count){
+            resize(count);
+            for(std::size_t i = 0; i < count; ++i) set(i, boxes[i]);
+        }
+
+        aabb<T> get(std::size_t i) const{
+            return {vec3<T>{cx[i] - ex[i], cy[i] - ey[i], cz[i] - ez[i]},
+                    vec3<T>{cx[i] + ex[i], cy[i] + ey[i], cz[i] + ez[i]}};
+        }
+    };
+
+    using planef = plane<float>;
+    using planed = plane<double>;
+    using frustumf = frustum<float>;
+    using frustumd = frustum<double>;
+    using aabb_batchf = aabb_batch<float>;
+    using aabb_batchd = aabb_batch<double>;
+
+    namespace detail{
+
+        template<typename T>
+        std::size_t cull_aabbs(const frustum<T>& f, const aabb_batch<T>& boxes, std::uint8_t* visible,
+                               std::size_t begin, std::size_t end){
+            std::size_t count = 0;
+            for(std::size_t i = begin; i < end; ++i){
+                bool inside = true;
+                for(const auto& p : f.planes){
+                    const T d = p.normal.x * boxes.cx[i] + p.normal.y * boxes.cy[i] + p.normal.z * boxes.cz[i] + p.d;
+                    const T r = std::abs(p.normal.x) * boxes.ex[i] + std::abs(p.normal.y) * boxes.ey[i] +
+                                std::abs(p.normal.z) * boxes.ez[i];
+                    inside = inside && d + r >= T(0);
+                }
+                visible[i] = inside ? 1 : 0;
+                count += inside ? 1 : 0;
+            }
+            return count;
+        }
+
+#if defined(PLUTOM_SIMD_SSE)
+        // Four boxes against one plane per step, the planes are splatted once up front
+        inline std::size_t cull_aabbs_sse(const frustum<float>& f, const aabb_batch<float>& boxes,
+                                          std::uint8_t* visible, std::size_t& done){
+            __m128 nx[6], ny[6], nz[6], ax[6], ay[6], az[6], pd[6];
+            for(int p = 0; p < 6; ++p){
+                const plane<float>& pl = f.planes[p];
+                nx[p] = _mm_set1_ps(pl.normal.x);
+                ny[p] = _mm_set1_ps(pl.normal.y);
+                nz[p] = _mm_set1_ps(pl.normal.z);
+                ax[p] = _mm_set1_ps(std::fabs(pl.normal.x));
+                ay[p] = _mm_set1_ps(std::fabs(pl.normal.y));
+                az[p] = _mm_set1_ps(std::fabs(pl.normal.z));
+                pd[p] = _mm_set1_ps(pl.d);
+            }
+            const std::size_t n = boxes.size() & ~std::size_t(3);
+            const __m128 zero = _mm_setzero_ps();
+            std::size_t count = 0;
+            for(std::size_t i = 0; i < n; i += 4){
+                const __m128 cx = _mm_loadu_ps(&boxes.cx[i]);
+                const __m128 cy = _mm_loadu_ps(&boxes.cy[i]);
+                const __m128 cz = _mm_loadu_ps(&boxes.cz[i]);
+                const __m128 ex = _mm_loadu_ps(&boxes.ex[i]);
+                const __m128 ey = _mm_loadu_ps(&boxes.ey[i]);
+                const __m128 ez = _mm_loadu_ps(&boxes.ez[i]);
+                __m128 outside = _mm_setzero_ps();
+                for(int p = 0; p < 6; ++p){
+                    const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], cx), _mm_mul_ps(ny[p], cy)),
+                                                _mm_add_ps(_mm_mul_ps(nz[p], cz), pd[p]));
+                    const __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey)),
+                                                _mm_mul_ps(az[p], ez));
+                    outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(d, r), zero));
+                }
+                const int mask = ~_mm_movemask_ps(outside) & 0xF;
+                visible[i + 0] = static_cast<std::uint8_t>(mask & 1);
+                visible[i + 1] = static_cast<std::uint8_t>((mask >> 1) & 1);
+                visible[i + 2] = static_cast<std::uint8_t>((mask >> 2) & 1);
+                visible[i + 3] = static_cast<std::uint8_t>((mask >> 3) & 1);
+                count += static_cast<std::size_t>((mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1));
+            }
+            done = n;
+            return count;
+        }
+#endif
+    }
+
+    // visible[i] = 1 if box i intersects the frustum, 0 otherwise. Returns the number of visible boxes.
+    template<typename T>
+    std::size_t cull_aabbs(const frustum<T>& f, const aabb_batch<T>& boxes, std::uint8_t* visible){
+        std::size_t done = 0, count = 0;
+#if defined(PLUTOM_SIMD_SSE)
+        if constexpr (std::is_same_v<T, float>) count = detail::cull_aabbs_sse(f, boxes, visible, done);
+#endif
+        return count + detail::cull_aabbs(f, boxes, visible, done, boxes.size());
+    }
+
+    template<typename T>
+    std::size_t cull_aabbs(const frustum<T>& f, const aabb_batch<T>& boxes, std::vector<std::uint8_t>& visible){
+        visible.resize(boxes.size());
+        return cull_aabbs(f, boxes, visible.data());
+    }
+}
@@ -25,11 +25,15 @@ namespace plutom{
         }
         
         constexpr vec2<T>& operator[](std::size_t i) {
+#if PLUTOM_CHECKED_INDEXING
             if(i >= 2) throw std::out_of_range("Index must be 0 or 1");
+#endif
             return columns[i];
         }
         constexpr const vec2<T>& operator[](std::size_t i) const {
+#if PLUTOM_CHECKED_INDEXING
             if(i >= 2) throw std::out_of_range("Index must be 0 or 1");
+#endif
             return columns[i];
         }
 
@@ -61,18 +65,12 @@ namespace plutom{
         }
 
         constexpr vec2<T> operator*(const vec2<T>& v) const{
-            return {columns[0][0] * v.x + columns[1][0] * v.y, columns[0][1] * v.x + columns[1][1] * v.y};
+            return {columns[0].x * v.x + columns[1].x * v.y, columns[0].y * v.x + columns[1].y * v.y};
         }
 
         constexpr mat2 operator*(const mat2& other) const {
-            mat2<T> ret{};
-            for (int i = 0; i < 2; ++i) {
-                const vec2<T> row_i = row(i);
-                for (int j = 0; j < 2; ++j) {
-                    ret[j][i] = row_i.dot(other.columns[j]);
-                }
-            }
-            return ret;
+            return {columns[0] * other.columns[0].x + columns[1] * other.columns[0].y,
+                    columns[0] * other.columns[1].x + columns[1] * other.columns[1].y};
         }
 
         constexpr mat2 transpose() const{
@@ -87,7 +85,9 @@ namespace plutom{
         }
 
         constexpr T minor(const std::size_t row, const std::size_t col) const{
+#if PLUTOM_CHECKED_INDEXING
             if(row >= 2 || col >= 2) throw std::out_of_range("Index out of bounds for 2 by 2 matrix");
+#endif
 
             std::size_t r = 0;
             for(std::size_t i = 0; i < 2; ++i){
@@ -109,7 +109,7 @@ namespace plutom{
                     if((i+j)%2 == 1){
                         mul *= -1;
                     }
-                    output[j][i] = mul * minor(i,j);
+                    output.columns[j][i] = mul * minor(i,j);
                 }
             }
 
@@ -168,7 +168,9 @@ namespace plutom{
         }
 
         constexpr vec2<T> row(std::size_t i) const {
+#if PLUTOM_CHECKED_INDEXING
             if(i >= 2) throw std::out_of_range("Row index must be 0 or 1");
+#endif
             return {columns[0][i], columns[1][i]};
         }
 
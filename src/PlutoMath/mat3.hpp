@@ -1,5 +1,6 @@
 #pragma once
 
+#include <limits>
 #include <ostream>
 #include <stdexcept>
 #include "vec3.hpp"
@@ -29,11 +30,15 @@ namespace plutom{
         }
         
         constexpr vec3<T>& operator[](std::size_t i) {
+#if PLUTOM_CHECKED_INDEXING
             if(i >= 3) throw std::out_of_range("Index must be 0, 1, or 2");
+#endif
             return columns[i];
         }
         constexpr const vec3<T>& operator[](std::size_t i) const {
+#if PLUTOM_CHECKED_INDEXING
             if(i >= 3) throw std::out_of_range("Index must be 0, 1, or 2");
+#endif
             return columns[i];
         }
 
@@ -68,18 +73,14 @@ namespace plutom{
         }
 
         constexpr vec3<T> operator*(const vec3<T>& v) const{
-            return {columns[0][0] * v.x + columns[1][0] * v.y + columns[2][0] * v.z,
-                    columns[0][1] * v.x + columns[1][1] * v.y + columns[2][1] * v.z,
-                    columns[0][2] * v.x + columns[1][2] * v.y + columns[2][2] * v.z};
+            return columns[0] * v.x + columns[1] * v.y + columns[2] * v.z;
         }
 
         constexpr mat3 operator*(const mat3& other) const {
-            mat3<T> ret{};
-            for (int i = 0; i < 3; ++i) {
-                const vec3<T> row_i = row(i);
-                for (int j = 0; j < 3; ++j) {
-                    ret[j][i] = row_i.dot(other.columns[j]);
-                }
+            mat3<T> ret;
+            for (int j = 0; j < 3; ++j) {
+                ret.columns[j] = columns[0] * other.columns[j].x + columns[1] * other.columns[j].y +
+                                 columns[2] * other.columns[j].z;
             }
             return ret;
         }
@@ -93,7 +94,9 @@ namespace plutom{
         }
 
         constexpr mat2<T> minor(const std::size_t row, const std::size_t col) const{
+#if PLUTOM_CHECKED_INDEXING
             if(row >= 3 || col >= 3) throw std::out_of_range("Index out of bounds for 3 by 3 matrix");
+#endif
 
             mat2<T> result;
 
@@ -103,7 +106,7 @@ namespace plutom{
                 if(i == row) continue;
                 for(std::size_t j = 0; j < 3; ++j){
                     if(j == col) continue;
-                    result[c][r] = columns[j][i];
+                    result.columns[c][r] = columns[j][i];
                     ++c;
                 }
                 ++r;
@@ -112,9 +115,7 @@ namespace plutom{
         }
 
         constexpr T determinant() const{
-            return  columns[0][0] * minor(static_cast<std::size_t>(0),static_cast<std::size_t>(0)).determinant() -
-                    columns[1][0] * minor(static_cast<std::size_t>(0),static_cast<std::size_t>(1)).determinant() +
-                    columns[2][0] * minor(static_cast<std::size_t>(0),static_cast<std::size_t>(2)).determinant();
+            return columns[0].dot(columns[1].cross(columns[2]));
         }
 
         constexpr mat3 cofactor() const{
@@ -125,7 +126,7 @@ namespace plutom{
                     if((i+j)%2 == 1){
                         mul *= -1;
                     }
-                    output[j][i] = mul * minor(i,j).determinant();
+                    output.columns[j][i] = mul * minor(i,j).determinant();
                 }
             }
 
@@ -136,10 +137,27 @@ namespace plutom{
             return cofactor().transpose();
         }
 
+        // The rows of the inverse are the cross products of the column pairs divided by the determinant
         constexpr mat3 inverse() const{
-            T det = determinant();
+            return inverse_transpose().transpose();
+        }
+
+        constexpr mat3 inverse_transpose() const{
+            const vec3<T> r0 = columns[1].cross(columns[2]);
+            const T det = columns[0].dot(r0);
             if(det == T(0)) throw std::domain_error("Determinant of matrix must be non zero to calculate inverse");
-            return adjugate() / det;
+            return mat3{r0, columns[2].cross(columns[0]), columns[0].cross(columns[1])} / det;
+        }
+
+        // inverse_transpose() for carrying normals, without the throw: a singular or nearly singular
+        // matrix (a zero scale axis) gives itself back, which keeps the normals of the axes it has
+        constexpr mat3 normal_matrix() const noexcept{
+            const vec3<T> r0 = columns[1].cross(columns[2]);
+            const T det = columns[0].dot(r0);
+            const T epsilon = std::numeric_limits<T>::epsilon();
+            const T scale = columns[0].dot(columns[0]) * columns[1].dot(columns[1]) * columns[2].dot(columns[2]);
+            if(det * det <= epsilon * epsilon * scale) return *this;
+            return mat3{r0, columns[2].cross(columns[0]), columns[0].cross(columns[1])} / det;
         }
 
         constexpr bool operator==(const mat3& other) const{
@@ -190,7 +208,9 @@ namespace plutom{
         }
 
         constexpr vec3<T> row(std::size_t i) const {
+#if PLUTOM_CHECKED_INDEXING
             if(i >= 3) throw std::out_of_range("Row index must be 0, 1, or 2");
+#endif
             return {columns[0][i], columns[1][i], columns[2][i]};
         }
 
@@ -5,6 +5,7 @@
 #include "vec4.hpp"
 #include "mat2.hpp"
 #include "mat3.hpp"
+#include "simd.hpp"
 
 namespace plutom{
 
@@ -33,11 +34,15 @@ namespace plutom{
         }
         
         constexpr vec4<T>& operator[](std::size_t i) {
+#if PLUTOM_CHECKED_INDEXING
             if(i >= 4) throw std::out_of_range("Index must be less than 4");
+#endif
             return columns[i];
         }
         constexpr const vec4<T>& operator[](std::size_t i) const {
+#if PLUTOM_CHECKED_INDEXING
             if(i >= 4) throw std::out_of_range("Index must be less than 4");
+#endif
             return columns[i];
         }
 
@@ -73,31 +78,25 @@ namespace plutom{
         }
 
         constexpr vec4<T> operator*(const vec4<T>& v) const{
-            return columns[0] * v.x + columns[1] * v.y + columns[2] * v.z + columns[3] * v.w;
+            return simd::mat4_kernels<T>::transform(columns, v);
         }
 
         constexpr mat4 operator*(const mat4& other) const {
-            mat4<T> ret{};
-            for (int i = 0; i < 4; ++i) {
-                const vec4<T> row_i = row(i);
-                for (int j = 0; j < 4; ++j) {
-                    ret[j][i] = row_i.dot(other.columns[j]);
-                }
-            }
+            mat4<T> ret;
+            simd::mat4_kernels<T>::multiply(columns, other.columns, ret.columns);
             return ret;
         }
 
         constexpr mat4 transpose() const{
-            return {
-                vec4<T>{columns[0].x, columns[1].x, columns[2].x, columns[3].x},
-                vec4<T>{columns[0].y, columns[1].y, columns[2].y, columns[3].y},
-                vec4<T>{columns[0].z, columns[1].z, columns[2].z, columns[3].z},
-                vec4<T>{columns[0].w, columns[1].w, columns[2].w, columns[3].w}
-            };
+            mat4<T> ret;
+            simd::mat4_kernels<T>::transpose(columns, ret.columns);
+            return ret;
         }
 
         constexpr mat3<T> minor(const std::size_t row, const std::size_t col) const{
+#if PLUTOM_CHECKED_INDEXING
             if(row >= 4 || col >= 4) throw std::out_of_range("Index out of bounds for 4 by 4 matrix");
+#endif
 
             mat3<T> result;
 
@@ -107,7 +106,7 @@ namespace plutom{
                 if(i == row) continue;
                 for(std::size_t j = 0; j < 4; ++j){
                     if(j == col) continue;
-                    result[c][r] = columns[j][i];
+                    result.columns[c][r] = columns[j][i];
                     ++c;
                 }
                 ++r;
@@ -116,10 +115,7 @@ namespace plutom{
         }
 
         constexpr T determinant() const{
-            return  columns[0][0] * minor(static_cast<std::size_t>(0),static_cast<std::size_t>(0)).determinant() -
-                    columns[1][0] * minor(static_cast<std::size_t>(0),static_cast<std::size_t>(1)).determinant() +
-                    columns[2][0] * minor(static_cast<std::size_t>(0),static_cast<std::size_t>(2)).determinant() -
-                    columns[3][0] * minor(static_cast<std::size_t>(0),static_cast<std::size_t>(3)).determinant();
+            return simd::mat4_scalar<T>::determinant(columns);
         }
 
         constexpr mat4 cofactor() const{
@@ -130,7 +126,7 @@ namespace plutom{
                     if((i+j)%2 == 1){
                         mul *= -1;
                     }
-                    output[j][i] = mul * minor(i,j).determinant();
+                    output.columns[j][i] = mul * minor(i,j).determinant();
                 }
             }
 
@@ -142,9 +138,39 @@ namespace plutom{
         }
 
         constexpr mat4 inverse() const{
-            T det = determinant();
-            if(det == T(0)) throw std::domain_error("Determinant of matrix must be non zero to calculate inverse");
-            return adjugate() / det;
+            mat4<T> ret;
+            if(!simd::mat4_kernels<T>::inverse(columns, ret.columns))
+                throw std::domain_error("Determinant of matrix must be non zero to calculate inverse");
+            return ret;
+        }
+
+        // Upper-left 3x3 block (rotation and scale of an affine transform)
+        constexpr mat3<T> upper3x3() const{
+            return {vec3<T>{columns[0].x, columns[0].y, columns[0].z},
+                    vec3<T>{columns[1].x, columns[1].y, columns[1].z},
+                    vec3<T>{columns[2].x, columns[2].y, columns[2].z}};
+        }
+
+        // Inverse of an affine matrix (last row 0, 0, 0, 1) such as translate * rotate * scale.
+        // Inverts the 3x3 block in closed form and maps the translation back through it.
+        constexpr mat4 affine_inverse() const{
+            const mat3<T> inv = upper3x3().inverse();
+            const vec3<T> t = -(inv * vec3<T>{columns[3].x, columns[3].y, columns[3].z});
+            return {vec4<T>{inv.columns[0].x, inv.columns[0].y, inv.columns[0].z, T(0)},
+                    vec4<T>{inv.columns[1].x, inv.columns[1].y, inv.columns[1].z, T(0)},
+                    vec4<T>{inv.columns[2].x, inv.columns[2].y, inv.columns[2].z, T(0)},
+                    vec4<T>{t.x, t.y, t.z, T(1)}};
+        }
+
+        // transpose(inverse(upper3x3())), the matrix that carries normals for this model matrix
+        constexpr mat3<T> inverse_transpose3x3() const{
+            return upper3x3().inverse_transpose();
+        }
+
+        // Same, but never throws, see mat3::normal_matrix(). What the renderer uses, scenes may hold
+        // shapes scaled to zero.
+        constexpr mat3<T> normal_matrix() const noexcept{
+            return upper3x3().normal_matrix();
         }
 
         constexpr bool operator==(const mat4& other) const{
@@ -199,7 +225,9 @@ namespace plutom{
         }
 
         constexpr vec4<T> row(std::size_t i) const {
+#if PLUTOM_CHECKED_INDEXING
             if(i >= 4) throw std::out_of_range("Row index must be less than 4");
+#endif
             return {columns[0][i], columns[1][i], columns[2][i],  columns[3][i]};
         }
 
@@ -7,8 +7,12 @@
 #include "mat2.hpp"
 #include "mat3.hpp"
 #include "mat4.hpp"
+#include "quat.hpp"
 
 #include "transform.hpp"
 #include "projection.hpp"
+#include "bounds.hpp"
+#include "batch.hpp"
+#include "frustum.hpp"
 
 #include "scalar_utils.hpp"
\ No newline at end of file
@@ -62,12 +62,12 @@ namespace plutom{
     template<typename T>
     constexpr mat4<T> ortho(const T left, const T right, const T bottom, const T top, const T near, const T far){
         mat4<T> ret = mat4<T>::identity();
-        ret[0][0] = 2 / (right - left);
-        ret[1][1] = 2 / (top - bottom);
-        ret[2][2] = -2 / (far - near);
-        ret[3][0] = - (right + left) / (right - left);
-        ret[3][1] = - (top + bottom) / (top - bottom);
-        ret[3][2] = - (far + near) / (far - near);
+        ret.columns[0].x = 2 / (right - left);
+        ret.columns[1].y = 2 / (top - bottom);
+        ret.columns[2].z = -2 / (far - near);
+        ret.columns[3].x = - (right + left) / (right - left);
+        ret.columns[3].y = - (top + bottom) / (top - bottom);
+        ret.columns[3].z = - (far + near) / (far - near);
         return ret;
     }
 
@@ -75,12 +75,12 @@ namespace plutom{
     constexpr mat4<T> perspective(const T fovRad, const T aspectRatio, const T near, const T far){
         const T f = 1 / std::tan(fovRad / 2);
         mat4<T> ret = mat4<T>();
-        ret[0][0] = f / aspectRatio;
+        ret.columns[0].x = f / aspectRatio;
         // NOTE: Y-flip applied to match OpenGL's upward Y convention.
-        ret[1][1] = -f;
-        ret[2][2] = (far + near) / (near - far);
-        ret[2][3] = -1;
-        ret[3][2] = (2 * far * near) / (near - far);
+        ret.columns[1].y = -f;
+        ret.columns[2].z = (far + near) / (near - far);
+        ret.columns[2].w = -1;
+        ret.columns[3].z = (2 * far * near) / (near - far);
         return ret;
     }
 
@@ -97,12 +97,12 @@ namespace plutom{
         vec3<T> dir = (cam - tar).normalize();
         vec3<T> right = (up.normalize().cross(dir)).normalize();
         vec3<T> true_up = right.cross(dir);
-        ret[0][0] = right.x; ret[1][0] = right.y; ret[2][0] = right.z;
-        retT[3][0] = -cam.x;
-        ret[0][1] = true_up.x; ret[1][1] = true_up.y; ret[2][1] = true_up.z;
-        retT[3][1] = -cam.y;
-        ret[0][2] = -dir.x; ret[1][2] = -dir.y; ret[2][2] = -dir.z;
-        retT[3][2] = -cam.z;
+        ret.columns[0].x = right.x; ret.columns[1].x = right.y; ret.columns[2].x = right.z;
+        retT.columns[3].x = -cam.x;
+        ret.columns[0].y = true_up.x; ret.columns[1].y = true_up.y; ret.columns[2].y = true_up.z;
+        retT.columns[3].y = -cam.y;
+        ret.columns[0].z = -dir.x; ret.columns[1].z = -dir.y; ret.columns[2].z = -dir.z;
+        retT.columns[3].z = -cam.z;
         return ret * retT;
     }
 
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+#include <stdexcept>
+
+#include "scalar_utils.hpp"
+#include "vec3.hpp"
+#include "vec4.hpp"
+#include "mat3.hpp"
+#include "mat4.hpp"
+
+namespace plutom{
+
+    // Rotation quaternion stored as (x, y, z, w) with w the scalar part. Same 16-byte layout as vec4
+    // so quat<float> can be loaded straight into an SSE register. Rotations follow transform3D::rotate:
+    // counter-clockwise around the axis, angles in radians, and a * b applies b first.
+    template<typename T>
+    struct alignas(std::is_same_v<T, float> ? 16 : alignof(T)) quat{
+        T x, y, z, w;
+
+        constexpr quat() : x(T(0)), y(T(0)), z(T(0)), w(T(1)) {}
+        constexpr quat(T x, T y, T z, T w) : x(x), y(y), z(z), w(w) {}
+        template<typename U>
+        constexpr explicit quat(const quat<U>& other) : x(static_cast<T>(other.x)), y(static_cast<T>(other.y)),
+                                                        z(static_cast<T>(other.z)), w(static_cast<T>(other.w)) {}
+
+        static constexpr quat identity(){
+            return quat();
+        }
+
+        static quat from_axis_angle(T theta, const vec3<T>& axis){
+            static_assert(std::is_floating_point_v<T>, "from_axis_angle() only available for float/double types");
+            const vec3<T> n = axis.normalize();
+            const T s = std::sin(theta * T(0.5));
+            return {n.x * s, n.y * s, n.z * s, std::cos(theta * T(0.5))};
+        }
+
+        // Expects a pure rotation (orthonormal columns). Shepperd's method, picking the largest
+        // diagonal term to stay away from the division by a near zero trace.
+        static quat from_mat3(const mat3<T>& m){
+            static_assert(std::is_floating_point_v<T>, "from_mat3() only available for float/double types");
+            const vec3<T>& c0 = m.columns[0];
+            const vec3<T>& c1 = m.columns[1];
+            const vec3<T>& c2 = m.columns[2];
+            const T trace = c0.x + c1.y + c2.z;
+            if(trace > T(0)){
+                const T s = std::sqrt(trace + T(1)) * T(2);
+                return {(c1.z - c2.y) / s, (c2.x - c0.z) / s, (c0.y - c1.x) / s, T(0.25) * s};
+            }
+            if(c0.x > c1.y && c0.x > c2.z){
+                const T s = std::sqrt(T(1) + c0.x - c1.y - c2.z) * T(2);
+                return {T(0.25) * s, (c1.x + c0.y) / s, (c2.x + c0.z) / s, (c1.z - c2.y) / s};
+            }
+            if(c1.y > c2.z){
+                const T s = std::sqrt(T(1) + c1.y - c0.x - c2.z) * T(2);
+                return {(c1.x + c0.y) / s, T(0.25) * s, (c2.y + c1.z) / s, (c2.x - c0.z) / s};
+            }
+            const T s = std::sqrt(T(1) + c2.z - c0.x - c1.y) * T(2);
+            return {(c2.x + c0.z) / s, (c2.y + c1.z) / s, T(0.25) * s, (c0.y - c1.x) / s};
+        }
+
+        static quat from_mat4(const mat4<T>& m){
+            return from_mat3(m.upper3x3());
+        }
+
+        constexpr quat operator*(const quat& o) const{
+            return {w * o.x + x * o.w + y * o.z - z * o.y,
+                    w * o.y - x * o.z + y * o.w + z * o.x,
+                    w * o.z + x * o.y - y * o.x + z * o.w,
+                    w * o.w - x * o.x - y * o.y - z * o.z};
+        }
+
+        constexpr quat& operator*=(const quat& o){
+            return *this = *this * o;
+        }
+
+        constexpr quat operator*(T scalar) const{
+            return {x * scalar, y * scalar, z * scalar, w * scalar};
+        }
+
+        constexpr quat operator+(const quat& o) const{
+            return {x + o.x, y + o.y, z + o.z, w + o.w};
+        }
+
+        constexpr quat operator-(const quat& o) const{
+            return {x - o.x, y - o.y, z - o.z, w - o.w};
+        }
+
+        constexpr quat operator-() const{
+            return {-x, -y, -z, -w};
+        }
+
+        constexpr T dot(const quat& o) const{
+            return x * o.x + y * o.y + z * o.z + w * o.w;
+        }
+
+        constexpr T length_squared() const{
+            return dot(*this);
+        }
+
+        T length() const{
+            static_assert(std::is_floating_point_v<T>, "length() only available for float/double types");
+            return std::sqrt(dot(*this));
+        }
+
+        quat normalize() const{
+            static_assert(std::is_floating_point_v<T>, "normalize() only available for float/double types");
+            T len = length();
+            return len == T(0) ? quat() : *this * (T(1) / len);
+        }
+
+        constexpr quat conjugate() const{
+            return {-x, -y, -z, w};
+        }
+
+        constexpr quat inverse() const{
+            const T len2 = length_squared();
+            if(len2 == T(0)) throw std::domain_error("Cannot invert a zero quaternion");
+            return conjugate() * (T(1) / len2);
+        }
+
+        // v' = v + 2w(q x v) + 2 q x (q x v), assumes a unit quaternion
+        constexpr vec3<T> rotate(const vec3<T>& v) const{
+            const vec3<T> q{x, y, z};
+            const vec3<T> t = q.cross(v) * T(2);
+            return v + t * w + q.cross(t);
+        }
+
+        void to_axis_angle(T& theta, vec3<T>& axis) const{
+            const quat n = normalize();
+            theta = T(2) * std::acos(clamp_scalar(n.w, T(-1), T(1)));
+            const T s = std::sqrt(std::max(T(0), T(1) - n.w * n.w));
+            axis = s < std::numeric_limits<T>::epsilon() * T(100) ? vec3<T>{T(1), T(0), T(0)}
+                                                                  : vec3<T>{n.x / s, n.y / s, n.z / s};
+        }
+
+        constexpr mat3<T> to_mat3() const{
+            const T xx = x * x, yy = y * y, zz = z * z;
+            const T xy = x * y, xz = x * z, yz = y * z;
+            const T wx = w * x, wy = w * y, wz = w * z;
+            return {vec3<T>{T(1) - T(2) * (yy + zz), T(2) * (xy + wz), T(2) * (xz - wy)},
+                    vec3<T>{T(2) * (xy - wz), T(1) - T(2) * (xx + zz), T(2) * (yz + wx)},
+                    vec3<T>{T(2) * (xz + wy), T(2) * (yz - wx), T(1) - T(2) * (xx + yy)}};
+        }
+
+        constexpr mat4<T> to_mat4() const{
+            const mat3<T> r = to_mat3();
+            return {vec4<T>{r.columns[0].x, r.columns[0].y, r.columns[0].z, T(0)},
+                    vec4<T>{r.columns[1].x, r.columns[1].y, r.columns[1].z, T(0)},
+                    vec4<T>{r.columns[2].x, r.columns[2].y, r.columns[2].z, T(0)},
+                    vec4<T>{T(0), T(0), T(0), T(1)}};
+        }
+
+        // q and -q describe the same rotation
+        constexpr bool operator==(const quat& o) const{
+            return  (almostequal(x, o.x) && almostequal(y, o.y) && almostequal(z, o.z) && almostequal(w, o.w)) ||
+                    (almostequal(x, -o.x) && almostequal(y, -o.y) && almostequal(z, -o.z) && almostequal(w, -o.w));
+        }
+
+        constexpr bool operator!=(const quat& o) const{
+            return !(*this == o);
+        }
+
+        friend std::ostream& operator<<(std::ostream& os, const quat& q) {
+            return os << "(" << q.x << ", " << q.y << ", " << q.z << ", " << q.w << ")";
+        }
+    };
+
+    template<typename T>
+    constexpr const T* value_ptr(const quat<T>& q) {
+        return &q.x;
+    }
+
+    template<typename T>
+    constexpr T* value_ptr(quat<T>& q) {
+        return &q.x;
+    }
+
+    template<typename T>
+    constexpr quat<T> operator*(T scalar, const quat<T>& q) {
+        return q * scalar;
+    }
+
+    // Normalized linear interpolation along the shorter arc. Cheaper than slerp and fine for small steps.
+    template<typename T>
+    quat<T> nlerp(const quat<T>& a, const quat<T>& b, const T t){
+        if (t < T(0) || t > T(1))
+            throw std::invalid_argument("t must be between 0 and 1");
+        const quat<T> end = a.dot(b) < T(0) ? -b : b;
+        return (a * (T(1) - t) + end * t).normalize();
+    }
+
+    // Constant angular velocity interpolation along the shorter arc
+    template<typename T>
+    quat<T> slerp(const quat<T>& a, const quat<T>& b, const T t){
+        if (t < T(0) || t > T(1))
+            throw std::invalid_argument("t must be between 0 and 1");
+        T cosTheta = a.dot(b);
+        quat<T> end = b;
+        if(cosTheta < T(0)){
+            cosTheta = -cosTheta;
+            end = -b;
+        }
+        // Nearly parallel, sin(theta) would vanish
+        if(cosTheta > T(1) - std::numeric_limits<T>::epsilon() * T(10))
+            return (a * (T(1) - t) + end * t).normalize();
+        const T theta = std::acos(cosTheta);
+        const T sinTheta = std::sin(theta);
+        return a * (std::sin((T(1) - t) * theta) / sinTheta) + end * (std::sin(t * theta) / sinTheta);
+    }
+
+    using quatf = quat<float>;
+    using quatd = quat<double>;
+}
@@ -3,6 +3,20 @@
 #include <cstdlib>
 #include <cmath>
 #include <limits>
+
+/*  Bounds checking for operator[], row() and minor() on the vector and matrix types.
+    Defaults to on in debug builds and off when NDEBUG is defined; unchecked access compiles
+    down to plain member selects and stays usable in constant expressions.
+    Define PLUTOM_CHECKED_INDEXING to 0 or 1 to override.
+ */
+#ifndef PLUTOM_CHECKED_INDEXING
+    #ifdef NDEBUG
+        #define PLUTOM_CHECKED_INDEXING 0
+    #else
+        #define PLUTOM_CHECKED_INDEXING 1
+    #endif
+#endif
+
 namespace plutom{
     template<typename T>
 
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include "vec4.hpp"
+
+/*  SIMD backend selection (compile time)
+    PLUTOM_SIMD_SSE  -> SSE2 kernels for mat4<float>: mat * vec, transpose and inverse
+    PLUTOM_SIMD_AVX  -> additionally uses 256-bit lanes for mat4<float> multiply
+    Define PLUTOM_NO_SIMD to force the scalar kernels everywhere.
+
+    vec4<float> has no kernels of its own, only its 16-byte alignment: its component-wise
+    operators already compile to single packed instructions. dot() would gain from a shuffle
+    and add, but it is constexpr and C++17 cannot branch it to intrinsics, and nothing hot
+    takes a vec4 dot product (the frustum and bounds tests are on vec3 and batch.hpp).
+ */
+#if !defined(PLUTOM_NO_SIMD)
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define PLUTOM_SIMD_SSE 1
+    #endif
+    #if defined(PLUTOM_SIMD_SSE) && defined(__AVX__)
+        #define PLUTOM_SIMD_AVX 1
+    #endif
+#endif
+
+#if defined(PLUTOM_SIMD_AVX)
+    #include <immintrin.h>
+#elif defined(PLUTOM_SIMD_SSE)
+    #include <emmintrin.h>
+#endif
+
+namespace plutom{
+namespace simd{
+
+    // Column-major kernels shared by every mat4<T>. Operands are the four column vectors of the matrix,
+    // out must not alias either input.
+    template<typename T>
+    struct mat4_scalar{
+        static constexpr void multiply(const vec4<T>* a, const vec4<T>* b, vec4<T>* out){
+            for(int j = 0; j < 4; ++j){
+                out[j] = a[0] * b[j].x + a[1] * b[j].y + a[2] * b[j].z + a[3] * b[j].w;
+            }
+        }
+
+        static constexpr vec4<T> transform(const vec4<T>* m, const vec4<T>& v){
+            return m[0] * v.x + m[1] * v.y + m[2] * v.z + m[3] * v.w;
+        }
+
+        static constexpr void transpose(const vec4<T>* m, vec4<T>* out){
+            out[0] = {m[0].x, m[1].x, m[2].x, m[3].x};
+            out[1] = {m[0].y, m[1].y, m[2].y, m[3].y};
+            out[2] = {m[0].z, m[1].z, m[2].z, m[3].z};
+            out[3] = {m[0].w, m[1].w, m[2].w, m[3].w};
+        }
+
+        // Laplace expansion over the 2x2 sub-determinants of the first and last pair of columns
+        static constexpr T determinant(const vec4<T>* m){
+            const T s0 = m[0].x * m[1].y - m[1].x * m[0].y;
+            const T s1 = m[0].x * m[1].z - m[1].x * m[0].z;
+            const T s2 = m[0].x * m[1].w - m[1].x * m[0].w;
+            const T s3 = m[0].y * m[1].z - m[1].y * m[0].z;
+            const T s4 = m[0].y * m[1].w - m[1].y * m[0].w;
+            const T s5 = m[0].z * m[1].w - m[1].z * m[0].w;
+            const T c5 = m[2].z * m[3].w - m[3].z * m[2].w;
+            const T c4 = m[2].y * m[3].w - m[3].y * m[2].w;
+            const T c3 = m[2].y * m[3].z - m[3].y * m[2].z;
+            const T c2 = m[2].x * m[3].w - m[3].x * m[2].w;
+            const T c1 = m[2].x * m[3].z - m[3].x * m[2].z;
+            const T c0 = m[2].x * m[3].y - m[3].x * m[2].y;
+            return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        }
+
+        // Closed form inverse using the same 2x2 sub-determinants. Reads the columns as rows; since
+        // inverse(transpose(M)) == transpose(inverse(M)) the rows it produces are the columns of the
+        // inverse. Returns false when the matrix is singular.
+        static constexpr bool inverse(const vec4<T>* m, vec4<T>* out){
+            const vec4<T>& r0 = m[0];
+            const vec4<T>& r1 = m[1];
+            const vec4<T>& r2 = m[2];
+            const vec4<T>& r3 = m[3];
+
+            const T s0 = r0.x * r1.y - r1.x * r0.y;
+            const T s1 = r0.x * r1.z - r1.x * r0.z;
+            const T s2 = r0.x * r1.w - r1.x * r0.w;
+            const T s3 = r0.y * r1.z - r1.y * r0.z;
+            const T s4 = r0.y * r1.w - r1.y * r0.w;
+            const T s5 = r0.z * r1.w - r1.z * r0.w;
+            const T c5 = r2.z * r3.w - r3.z * r2.w;
+            const T c4 = r2.y * r3.w - r3.y * r2.w;
+            const T c3 = r2.y * r3.z - r3.y * r2.z;
+            const T c2 = r2.x * r3.w - r3.x * r2.w;
+            const T c1 = r2.x * r3.z - r3.x * r2.z;
+            const T c0 = r2.x * r3.y - r3.x * r2.y;
+
+            const T det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+            if(det == T(0)) return false;
+
+            const vec4<T> adj[4] = {
+                { r1.y * c5 - r1.z * c4 + r1.w * c3, -r0.y * c5 + r0.z * c4 - r0.w * c3,
+                  r3.y * s5 - r3.z * s4 + r3.w * s3, -r2.y * s5 + r2.z * s4 - r2.w * s3},
+                {-r1.x * c5 + r1.z * c2 - r1.w * c1,  r0.x * c5 - r0.z * c2 + r0.w * c1,
+                 -r3.x * s5 + r3.z * s2 - r3.w * s1,  r2.x * s5 - r2.z * s2 + r2.w * s1},
+                { r1.x * c4 - r1.y * c2 + r1.w * c0, -r0.x * c4 + r0.y * c2 - r0.w * c0,
+                  r3.x * s4 - r3.y * s2 + r3.w * s0, -r2.x * s4 + r2.y * s2 - r2.w * s0},
+                {-r1.x * c3 + r1.y * c1 - r1.z * c0,  r0.x * c3 - r0.y * c1 + r0.z * c0,
+                 -r3.x * s3 + r3.y * s1 - r3.z * s0,  r2.x * s3 - r2.y * s1 + r2.z * s0}
+            };
+            for(int i = 0; i < 4; ++i){
+                if constexpr (std::is_floating_point_v<T>) out[i] = adj[i] * (T(1) / det);
+                else out[i] = adj[i] / det;
+            }
+            return true;
+        }
+    };
+
+    // Generic path, used for double/int and for float when no SIMD backend is enabled
+    template<typename T>
+    struct mat4_kernels : mat4_scalar<T>{
+        static constexpr bool accelerated = false;
+    };
+
+#if defined(PLUTOM_SIMD_SSE)
+    namespace detail{
+        template<int X, int Y, int Z, int W>
+        inline __m128 swizzle(__m128 v){
+            return _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(v), _MM_SHUFFLE(W, Z, Y, X)));
+        }
+
+        template<int X, int Y, int Z, int W>
+        inline __m128 shuffle(__m128 a, __m128 b){
+            return _mm_shuffle_ps(a, b, _MM_SHUFFLE(W, Z, Y, X));
+        }
+
+        // 2x2 blocks packed as (m00, m01, m10, m11)
+        inline __m128 mat2_mul(__m128 a, __m128 b){
+            return _mm_add_ps(_mm_mul_ps(a, swizzle<0, 3, 0, 3>(b)),
+                              _mm_mul_ps(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+        }
+
+        // adj(a) * b
+        inline __m128 mat2_adj_mul(__m128 a, __m128 b){
+            return _mm_sub_ps(_mm_mul_ps(swizzle<3, 3, 0, 0>(a), b),
+                              _mm_mul_ps(swizzle<1, 1, 2, 2>(a), swizzle<2, 3, 0, 1>(b)));
+        }
+
+        // a * adj(b)
+        inline __m128 mat2_mul_adj(__m128 a, __m128 b){
+            return _mm_sub_ps(_mm_mul_ps(a, swizzle<3, 0, 3, 0>(b)),
+                              _mm_mul_ps(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+        }
+
+        inline __m128 hsum_broadcast(__m128 v){
+            v = _mm_add_ps(v, swizzle<1, 0, 3, 2>(v));
+            return _mm_add_ps(v, swizzle<2, 3, 0, 1>(v));
+        }
+
+        inline __m128 select(__m128 mask, __m128 a, __m128 b){
+            return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+        }
+    }
+
+    // Four-wide version of detail::sincos in batch.hpp (same reduction and polynomials)
+    inline void sincos(__m128 x, __m128& s, __m128& c){
+        const __m128i q = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.63661977236758134f)));
+        const __m128 qf = _mm_cvtepi32_ps(q);
+        __m128 r = _mm_sub_ps(x, _mm_mul_ps(qf, _mm_set1_ps(1.5703125f)));
+        r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(4.837512969970703125e-4f)));
+        r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(7.549789948768648e-8f)));
+        const __m128 r2 = _mm_mul_ps(r, r);
+
+        __m128 ps = _mm_add_ps(_mm_set1_ps(8.3321608736e-3f), _mm_mul_ps(r2, _mm_set1_ps(-1.9515295891e-4f)));
+        ps = _mm_add_ps(_mm_set1_ps(-1.6666654611e-1f), _mm_mul_ps(r2, ps));
+        ps = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), ps));
+        __m128 pc = _mm_add_ps(_mm_set1_ps(-1.388731625493765e-3f), _mm_mul_ps(r2, _mm_set1_ps(2.443315711809948e-5f)));
+        pc = _mm_add_ps(_mm_set1_ps(4.166664568298827e-2f), _mm_mul_ps(r2, pc));
+        pc = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), r2)), _mm_mul_ps(_mm_mul_ps(r2, r2), pc));
+
+        // odd quadrants swap sine and cosine, bit 1 of q (and of q + 1) flips the sign
+        const __m128i one = _mm_set1_epi32(1);
+        const __m128i two = _mm_set1_epi32(2);
+        const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, one), one));
+        const __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, two), 30));
+        const __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, one), two), 30));
+        s = _mm_xor_ps(detail::select(swap, pc, ps), sinSign);
+        c = _mm_xor_ps(detail::select(swap, ps, pc), cosSign);
+    }
+
+    template<>
+    struct mat4_kernels<float>{
+        static constexpr bool accelerated = true;
+
+        static void multiply(const vec4<float>* a, const vec4<float>* b, vec4<float>* out){
+#if defined(PLUTOM_SIMD_AVX)
+            // Two output columns per iteration, the columns of a are broadcast into both 128-bit lanes
+            const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[0].x));
+            const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[1].x));
+            const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[2].x));
+            const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[3].x));
+            for(int j = 0; j < 4; j += 2){
+                const __m256 bj = _mm256_loadu_ps(&b[j].x);
+                __m256 r = _mm256_mul_ps(a0, _mm256_shuffle_ps(bj, bj, 0x00));
+                r = _mm256_add_ps(r, _mm256_mul_ps(a1, _mm256_shuffle_ps(bj, bj, 0x55)));
+                r = _mm256_add_ps(r, _mm256_mul_ps(a2, _mm256_shuffle_ps(bj, bj, 0xAA)));
+                r = _mm256_add_ps(r, _mm256_mul_ps(a3, _mm256_shuffle_ps(bj, bj, 0xFF)));
+                _mm256_storeu_ps(&out[j].x, r);
+            }
+#else
+            // No 128-bit kernel: GCC and Clang vectorize mat4_scalar's loop over the aligned
+            // vec4<float> columns into the same shufps/mulps/addps a hand written one issued,
+            // and it measured no faster
+            mat4_scalar<float>::multiply(a, b, out);
+#endif
+        }
+
+        static vec4<float> transform(const vec4<float>* m, const vec4<float>& v){
+            const __m128 vv = _mm_load_ps(&v.x);
+            __m128 r = _mm_mul_ps(_mm_load_ps(&m[0].x), detail::swizzle<0, 0, 0, 0>(vv));
+            r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(&m[1].x), detail::swizzle<1, 1, 1, 1>(vv)));
+            r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(&m[2].x), detail::swizzle<2, 2, 2, 2>(vv)));
+            r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(&m[3].x), detail::swizzle<3, 3, 3, 3>(vv)));
+            vec4<float> ret;
+            _mm_store_ps(&ret.x, r);
+            return ret;
+        }
+
+        static void transpose(const vec4<float>* m, vec4<float>* out){
+            __m128 c0 = _mm_load_ps(&m[0].x);
+            __m128 c1 = _mm_load_ps(&m[1].x);
+            __m128 c2 = _mm_load_ps(&m[2].x);
+            __m128 c3 = _mm_load_ps(&m[3].x);
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            _mm_store_ps(&out[0].x, c0);
+            _mm_store_ps(&out[1].x, c1);
+            _mm_store_ps(&out[2].x, c2);
+            _mm_store_ps(&out[3].x, c3);
+        }
+
+        // Block-wise 2x2 inverse. Works on the columns as if they were rows, which yields the
+        // transposed inverse of the transpose, i.e. the columns of the inverse.
+        // Returns false (and leaves out untouched) when the matrix is singular.
+        static bool inverse(const vec4<float>* m, vec4<float>* out){
+            const __m128 c0 = _mm_load_ps(&m[0].x);
+            const __m128 c1 = _mm_load_ps(&m[1].x);
+            const __m128 c2 = _mm_load_ps(&m[2].x);
+            const __m128 c3 = _mm_load_ps(&m[3].x);
+
+            const __m128 A = _mm_movelh_ps(c0, c1);
+            const __m128 B = _mm_movehl_ps(c1, c0);
+            const __m128 C = _mm_movelh_ps(c2, c3);
+            const __m128 D = _mm_movehl_ps(c3, c2);
+
+            // (|A|, |B|, |C|, |D|)
+            const __m128 detSub = _mm_sub_ps(
+                _mm_mul_ps(detail::shuffle<0, 2, 0, 2>(c0, c2), detail::shuffle<1, 3, 1, 3>(c1, c3)),
+                _mm_mul_ps(detail::shuffle<1, 3, 1, 3>(c0, c2), detail::shuffle<0, 2, 0, 2>(c1, c3)));
+            const __m128 detA = detail::swizzle<0, 0, 0, 0>(detSub);
+            const __m128 detB = detail::swizzle<1, 1, 1, 1>(detSub);
+            const __m128 detC = detail::swizzle<2, 2, 2, 2>(detSub);
+            const __m128 detD = detail::swizzle<3, 3, 3, 3>(detSub);
+
+            const __m128 D_C = detail::mat2_adj_mul(D, C);
+            const __m128 A_B = detail::mat2_adj_mul(A, B);
+            __m128 X_ = _mm_sub_ps(_mm_mul_ps(detD, A), detail::mat2_mul(B, D_C));
+            __m128 W_ = _mm_sub_ps(_mm_mul_ps(detA, D), detail::mat2_mul(C, A_B));
+            __m128 Y_ = _mm_sub_ps(_mm_mul_ps(detB, C), detail::mat2_mul_adj(D, A_B));
+            __m128 Z_ = _mm_sub_ps(_mm_mul_ps(detC, B), detail::mat2_mul_adj(A, D_C));
+
+            __m128 detM = _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC));
+            detM = _mm_sub_ps(detM, detail::hsum_broadcast(_mm_mul_ps(A_B, detail::swizzle<0, 2, 1, 3>(D_C))));
+            if(_mm_cvtss_f32(detM) == 0.0f) return false;
+
+            const __m128 rDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+            X_ = _mm_mul_ps(X_, rDetM);
+            Y_ = _mm_mul_ps(Y_, rDetM);
+            Z_ = _mm_mul_ps(Z_, rDetM);
+            W_ = _mm_mul_ps(W_, rDetM);
+
+            _mm_store_ps(&out[0].x, detail::shuffle<3, 1, 3, 1>(X_, Y_));
+            _mm_store_ps(&out[1].x, detail::shuffle<2, 0, 2, 0>(X_, Y_));
+            _mm_store_ps(&out[2].x, detail::shuffle<3, 1, 3, 1>(Z_, W_));
+            _mm_store_ps(&out[3].x, detail::shuffle<2, 0, 2, 0>(Z_, W_));
+            return true;
+        }
+    };
+#endif
+
+}
+}
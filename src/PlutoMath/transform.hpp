@@ -4,14 +4,15 @@
 #include "vec3.hpp"
 #include "mat3.hpp"
 #include "mat4.hpp"
+#include "quat.hpp"
 
 namespace plutom {
 namespace transform2D{
     template<typename T>
     constexpr mat3<T> scale(const vec2<T>& s){
         mat3<T> iden = mat3<T>::identity();
-        iden[0][0] = s.x;
-        iden[1][1] = s.y;
+        iden.columns[0].x = s.x;
+        iden.columns[1].y = s.y;
         return  iden;
     }
 
@@ -23,8 +24,8 @@ namespace transform2D{
     template<typename T>
     constexpr mat3<T> scale(T s){
         mat3<T> iden = mat3<T>::identity();
-        iden[0][0] = s;
-        iden[1][1] = s;
+        iden.columns[0].x = s;
+        iden.columns[1].y = s;
         return  iden;
     }
 
@@ -36,8 +37,8 @@ namespace transform2D{
     template<typename T>
     constexpr mat3<T> translate(const vec2<T>& s){
         mat3<T> iden = mat3<T>::identity();
-        iden[2][0] = s.x;
-        iden[2][1] = s.y;
+        iden.columns[2].x = s.x;
+        iden.columns[2].y = s.y;
         return  iden;
     }
 
@@ -49,8 +50,8 @@ namespace transform2D{
     template<typename T>
     constexpr mat3<T> translate(T s){
         mat3<T> iden = mat3<T>::identity();
-        iden[2][0] = s;
-        iden[2][1] = s;
+        iden.columns[2].x = s;
+        iden.columns[2].y = s;
         return  iden;
     }
 
@@ -99,9 +100,9 @@ namespace transform3D{
     template<typename T>
     constexpr mat4<T> scale(const vec3<T>& s){
         mat4<T> iden = mat4<T>::identity();
-        iden[0][0] = s.x;
-        iden[1][1] = s.y;
-        iden[2][2] = s.z;
+        iden.columns[0].x = s.x;
+        iden.columns[1].y = s.y;
+        iden.columns[2].z = s.z;
         return  iden;
     }
 
@@ -113,9 +114,9 @@ namespace transform3D{
     template<typename T>
     constexpr mat4<T> scale(T s){
         mat4<T> iden = mat4<T>::identity();
-        iden[0][0] = s;
-        iden[1][1] = s;
-        iden[2][2] = s;
+        iden.columns[0].x = s;
+        iden.columns[1].y = s;
+        iden.columns[2].z = s;
         return  iden;
     }
 
@@ -127,9 +128,9 @@ namespace transform3D{
     template<typename T>
     constexpr mat4<T> translate(const vec3<T>& s){
         mat4<T> iden = mat4<T>::identity();
-        iden[3][0] = s.x;
-        iden[3][1] = s.y;
-        iden[3][2] = s.z;
+        iden.columns[3].x = s.x;
+        iden.columns[3].y = s.y;
+        iden.columns[3].z = s.z;
         return  iden;
     }
 
@@ -141,9 +142,9 @@ namespace transform3D{
     template<typename T>
     constexpr mat4<T> translate(T s){
         mat4<T> iden = mat4<T>::identity();
-        iden[3][0] = s;
-        iden[3][1] = s;
-        iden[3][2] = s;
+        iden.columns[3].x = s;
+        iden.columns[3].y = s;
+        iden.columns[3].z = s;
         return  iden;
     }
 
@@ -201,5 +202,30 @@ namespace transform3D{
     constexpr mat4<T> rotate(const mat4<T>& mat, T theta, const vec3<T>& axis){
         return mat * rotate(theta, axis);
     }
+
+    template<typename T>
+    constexpr mat4<T> rotate(const quat<T>& q){
+        return q.to_mat4();
+    }
+
+    template<typename T>
+    constexpr mat4<T> rotate(const mat4<T>& mat, const quat<T>& q){
+        return mat * rotate(q);
+    }
+
+    // translate(t) * rotate(q) * scale(s), written directly instead of through two 4x4 products
+    template<typename T>
+    constexpr mat4<T> trs(const vec3<T>& t, const quat<T>& q, const vec3<T>& s){
+        const mat3<T> r = q.to_mat3();
+        return {vec4<T>{r.columns[0].x * s.x, r.columns[0].y * s.x, r.columns[0].z * s.x, T(0)},
+                vec4<T>{r.columns[1].x * s.y, r.columns[1].y * s.y, r.columns[1].z * s.y, T(0)},
+                vec4<T>{r.columns[2].x * s.z, r.columns[2].y * s.z, r.columns[2].z * s.z, T(0)},
+                vec4<T>{t.x, t.y, t.z, T(1)}};
+    }
+
+    template<typename T>
+    constexpr mat4<T> trs(const mat4<T>& mat, const vec3<T>& t, const quat<T>& q, const vec3<T>& s){
+        return mat * trs(t, q, s);
+    }
 }
 }
\ No newline at end of file
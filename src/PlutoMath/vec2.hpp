@@ -19,15 +19,17 @@ namespace plutom{
         template<typename U>
         constexpr explicit vec2(const vec2<U>& other) : x(static_cast<T>(other.x)), y(static_cast<T>(other.y)) {}
 
-        T& operator[](const std::size_t i) {
-            if (i == 0) return x;
-            if (i == 1) return y;
-            throw std::out_of_range("vec2 index must be 0 or 1");
+        constexpr T& operator[](const std::size_t i) {
+#if PLUTOM_CHECKED_INDEXING
+            if (i > 1) throw std::out_of_range("vec2 index must be 0 or 1");
+#endif
+            return i == 0 ? x : y;
         }
-        const T& operator[](const std::size_t i) const {
-            if (i == 0) return x;
-            if (i == 1) return y;
-            throw std::out_of_range("vec2 index must be 0 or 1");
+        constexpr const T& operator[](const std::size_t i) const {
+#if PLUTOM_CHECKED_INDEXING
+            if (i > 1) throw std::out_of_range("vec2 index must be 0 or 1");
+#endif
+            return i == 0 ? x : y;
         }
 
         // Assignment from same type
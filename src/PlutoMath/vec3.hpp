@@ -19,17 +19,17 @@ namespace plutom{
         template<typename U>
         constexpr explicit vec3(const vec3<U>& other) : x(static_cast<T>(other.x)), y(static_cast<T>(other.y)), z(static_cast<T>(other.z)) {}
 
-        T& operator[](const std::size_t i) {
-            if (i == 0) return x;
-            if (i == 1) return y;
-            if (i == 2) return z;
-            throw std::out_of_range("vec3 index must be 0, 1, or 2");
+        constexpr T& operator[](const std::size_t i) {
+#if PLUTOM_CHECKED_INDEXING
+            if (i > 2) throw std::out_of_range("vec3 index must be 0, 1, or 2");
+#endif
+            return i == 0 ? x : i == 1 ? y : z;
         }
-        const T& operator[](const std::size_t i) const {
-            if (i == 0) return x;
-            if (i == 1) return y;
-            if (i == 2) return z;
-            throw std::out_of_range("vec3 index must be 0, 1, or 2");
+        constexpr const T& operator[](const std::size_t i) const {
+#if PLUTOM_CHECKED_INDEXING
+            if (i > 2) throw std::out_of_range("vec3 index must be 0, 1, or 2");
+#endif
+            return i == 0 ? x : i == 1 ? y : z;
         }
 
         // Assignment from same type
@@ -9,8 +9,9 @@
 
 namespace plutom{
 
+    // vec4<float> is 16-byte aligned so the SIMD kernels in simd.hpp can use aligned loads
     template<typename T>
-    struct vec4{
+    struct alignas(std::is_same_v<T, float> ? 16 : alignof(T)) vec4{
         T x, y, z, w;
 
         constexpr vec4() : x(T(0)), y(T(0)), z(T(0)), w(T(0)) {}
@@ -20,19 +21,17 @@ namespace plutom{
         constexpr explicit vec4(const vec4<U>& other) : x(static_cast<T>(other.x)), y(static_cast<T>(other.y)),
                                                         z(static_cast<T>(other.z)), w(static_cast<T>(other.w)) {}
 
-        T& operator[](const std::size_t i) {
-            if (i == 0) return x;
-            if (i == 1) return y;
-            if (i == 2) return z;
-            if (i == 3) return w;
-            throw std::out_of_range("vec4 index must be 0, 1, 2, or 3");
+        constexpr T& operator[](const std::size_t i) {
+#if PLUTOM_CHECKED_INDEXING
+            if (i > 3) throw std::out_of_range("vec4 index must be 0, 1, 2, or 3");
+#endif
+            return i == 0 ? x : i == 1 ? y : i == 2 ? z : w;
         }
-        const T& operator[](const std::size_t i) const {
-            if (i == 0) return x;
-            if (i == 1) return y;
-            if (i == 2) return z;
-            if (i == 3) return w;
-            throw std::out_of_range("vec4 index must be 0, 1, 2, or 3");
+        constexpr const T& operator[](const std::size_t i) const {
+#if PLUTOM_CHECKED_INDEXING
+            if (i > 3) throw std::out_of_range("vec4 index must be 0, 1, 2, or 3");
+#endif
+            return i == 0 ? x : i == 1 ? y : i == 2 ? z : w;
         }
 
         // Assignment from same type
@@ -0,0 +1,114 @@
+#include "frame_loop.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace app {
+
+    FrameLoop::FrameLoop(const FrameLoopSettings& settings) : settings(settings) {
+        history.reserve(std::max<std::size_t>(settings.historySize, 1));
+    }
+
+    void FrameLoop::begin_frame() {
+        const auto now = clock::now();
+        if (!started) {
+            // The first frame simulates one step so there is something to draw
+            started = true;
+            lastFrame = now;
+            deadline = now;
+            accumulator = settings.step;
+        } else {
+            delta = std::chrono::duration<double>(now - lastFrame).count();
+            lastFrame = now;
+            accumulator += delta;
+
+            const double ms = delta * 1000.0;
+            // reserve() may round the capacity up, the size asked for is the limit
+            if (history.size() < std::max<std::size_t>(settings.historySize, 1)) {
+                history.push_back(ms);
+            } else {
+                history[historyNext] = ms;
+                historyNext = (historyNext + 1) % history.size();
+            }
+        }
+        frame += 1;
+
+        stepsDue = static_cast<int>(std::floor(accumulator / settings.step));
+        if (stepsDue > settings.maxStepsPerFrame) {
+            droppedSteps += static_cast<std::uint64_t>(stepsDue - settings.maxStepsPerFrame);
+            accumulator -= (stepsDue - settings.maxStepsPerFrame) * settings.step;
+            stepsDue = settings.maxStepsPerFrame;
+        }
+    }
+
+    bool FrameLoop::step() {
+        if (stepsDue <= 0) return false;
+        stepsDue -= 1;
+        accumulator -= settings.step;
+        return true;
+    }
+
+    int FrameLoop::get_pending_steps() const {
+        return stepsDue;
+    }
+
+    void FrameLoop::end_frame() {
+        if (settings.targetFrameRate <= 0.0) return;
+        const auto period = std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<double>(1.0 / settings.targetFrameRate));
+        deadline += period;
+        const auto now = clock::now();
+        // Missed by a whole frame, pace from here rather than rushing the next ones to catch up
+        if (now > deadline + period) {
+            deadline = now;
+            return;
+        }
+        const auto spin = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(settings.spinTime));
+        if (deadline - now > spin) std::this_thread::sleep_until(deadline - spin);
+        while (clock::now() < deadline) std::this_thread::yield();
+    }
+
+    float FrameLoop::get_step() const {
+        return static_cast<float>(settings.step);
+    }
+
+    float FrameLoop::get_alpha() const {
+        return static_cast<float>(std::clamp(accumulator / settings.step, 0.0, 1.0));
+    }
+
+    float FrameLoop::get_delta() const {
+        return static_cast<float>(delta);
+    }
+
+    std::uint64_t FrameLoop::get_frame() const {
+        return frame;
+    }
+
+    std::uint64_t FrameLoop::get_dropped_steps() const {
+        return droppedSteps;
+    }
+
+    FrameTimeStats FrameLoop::get_stats() const {
+        FrameTimeStats stats;
+        if (history.empty()) return stats;
+        std::vector<double> sorted = history;
+        std::sort(sorted.begin(), sorted.end());
+        const auto at = [&](const double q) {
+            return sorted[static_cast<std::size_t>(q * static_cast<double>(sorted.size() - 1) + 0.5)];
+        };
+        stats.frames = sorted.size();
+        for (const double ms : sorted) stats.mean += ms;
+        stats.mean /= static_cast<double>(sorted.size());
+        stats.p50 = at(0.50);
+        stats.p90 = at(0.90);
+        stats.p99 = at(0.99);
+        stats.max = sorted.back();
+        return stats;
+    }
+
+    void FrameLoop::set_target_frame_rate(const double rate) {
+        settings.targetFrameRate = rate;
+        deadline = clock::now();
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef FRAME_LOOP_HPP
+#define FRAME_LOOP_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace app {
+
+    struct FrameLoopSettings {
+        double step = 1.0 / 60.0;        // fixed simulation step in seconds
+        int maxStepsPerFrame = 5;        // more than this and the backlog is dropped
+        double targetFrameRate = 0.0;    // 0 leaves pacing to vsync
+        double spinTime = 0.002;         // end_frame() busy waits this last stretch, sleep overshoots
+        std::size_t historySize = 240;   // frames kept for the percentiles
+    };
+
+    // Frame times in milliseconds over the last historySize frames
+    struct FrameTimeStats {
+        std::size_t frames = 0;
+        double mean = 0.0;
+        double p50 = 0.0;
+        double p90 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    /*  Fixed timestep loop. begin_frame() adds the real time since the previous frame to an
+        accumulator, step() hands it out in fixed steps, and get_alpha() is how far the leftover
+        time reaches into the next step, to blend the last two simulated states with:
+
+            loop.begin_frame();
+            while (loop.step()) simulate(loop.get_step());
+            render(previous, current, loop.get_alpha());
+            loop.end_frame();
+
+        The simulation then runs at the same rate on every machine, whatever the frame rate.
+        A frame that falls more than maxStepsPerFrame steps behind drops the rest instead of
+        simulating it, otherwise each slow frame would make the next one slower still.
+     */
+    class FrameLoop {
+    public:
+        explicit FrameLoop(const FrameLoopSettings& settings = {});
+
+        void begin_frame();
+        // True while a step is due this frame, consumes it
+        bool step();
+        // Steps still due this frame after the current one
+        int get_pending_steps() const;
+        // Sleeps, then spins, until the frame has lasted 1 / targetFrameRate
+        void end_frame();
+
+        float get_step() const;
+        float get_alpha() const;
+        // Real time between the last two begin_frame() calls, in seconds
+        float get_delta() const;
+        std::uint64_t get_frame() const;
+        std::uint64_t get_dropped_steps() const;
+        FrameTimeStats get_stats() const;
+
+        void set_target_frame_rate(double rate);
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        FrameLoopSettings settings;
+        clock::time_point lastFrame;
+        clock::time_point deadline;
+        double accumulator = 0.0;
+        double delta = 0.0;
+        int stepsDue = 0;
+        bool started = false;
+        std::uint64_t frame = 0;
+        std::uint64_t droppedSteps = 0;
+
+        // Ring of frame times in ms
+        std::vector<double> history;
+        std::size_t historyNext = 0;
+    };
+}
+
+#endif //FRAME_LOOP_HPP
@@ -0,0 +1,98 @@
+#include "simulation_thread.hpp"
+
+#include <algorithm>
+
+#include "../util/profiler.hpp"
+
+SimulationThread::SimulationThread(Renderer& renderer, const double tick, const unsigned int jobThreads)
+    : renderer(renderer),
+      tick(std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(tick))),
+      jobThreads(jobThreads != 0 ? jobThreads : std::max(1u, std::thread::hardware_concurrency() / 2)) {}
+
+SimulationThread::~SimulationThread() {
+    stop();
+}
+
+void SimulationThread::start(const Camera& cam) {
+    if (running.load()) return;
+    initialCamera = SnapshotCamera::from(cam);
+    hasSnapshot = false;
+    epoch = clock::now();
+    running.store(true);
+    thread = std::thread([this] { run(); });
+}
+
+void SimulationThread::stop() {
+    running.store(false);
+    if (thread.joinable()) thread.join();
+}
+
+void SimulationThread::set_camera(const Camera& cam) {
+    cameras.write_buffer() = SnapshotCamera::from(cam);
+    cameras.publish();
+}
+
+void SimulationThread::run() {
+    const float step = std::chrono::duration<float>(tick).count();
+    SnapshotCamera cam = initialCamera;
+    clock::time_point next = epoch;
+    std::uint64_t count = 0;
+    PLUTO_PROFILE_THREAD("Simulation");
+    // Built here so this thread owns its first queue
+    JobSystem jobs(jobThreads);
+    renderer.set_simulation_jobs(&jobs);
+    while (running.load()) {
+        {
+            PLUTO_PROFILE_SCOPE("tick");
+            if (cameras.acquire()) cam = cameras.read();
+            renderer.simulate(step);
+            next += tick;
+            count += 1;
+
+            // The snapshot shows the world as of the end of this tick
+            FrameSnapshot& snapshot = snapshots.write_buffer();
+            renderer.capture(snapshot, cam);
+            snapshot.tick = count;
+            snapshot.time = std::chrono::duration<double>(next - epoch).count();
+            snapshots.publish();
+            ticks.store(count, std::memory_order_relaxed);
+        }
+
+        // Too far behind to catch up without stalling for several ticks, give the time up instead
+        const auto now = clock::now();
+        if (now - next > tick * MAX_LAG_TICKS) {
+            dropped.fetch_add(static_cast<std::uint64_t>((now - next) / tick), std::memory_order_relaxed);
+            next = now;
+        }
+        std::this_thread::sleep_until(next);
+    }
+    renderer.set_simulation_jobs(nullptr);
+}
+
+void SimulationThread::render(const float ratio) {
+    if (snapshots.acquire()) {
+        if (hasSnapshot) {
+            std::swap(previous, current);
+            current = snapshots.read();
+        } else {
+            current = snapshots.read();
+            previous = current;
+            hasSnapshot = true;
+        }
+    }
+    if (!hasSnapshot) return;
+
+    // One tick behind real time there are usually two snapshots around the moment drawn
+    const double shown = std::chrono::duration<double>(clock::now() - epoch - tick).count();
+    const double span = current.time - previous.time;
+    const double alpha = span > 0.0 ? (shown - previous.time) / span : 1.0;
+    renderer.render(previous, current, static_cast<float>(std::clamp(alpha, 0.0, 1.0)), ratio);
+}
+
+std::uint64_t SimulationThread::get_ticks() const {
+    return ticks.load(std::memory_order_relaxed);
+}
+
+std::uint64_t SimulationThread::get_dropped_ticks() const {
+    return dropped.load(std::memory_order_relaxed);
+}
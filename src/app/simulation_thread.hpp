@@ -0,0 +1,71 @@
+#ifndef SIMULATION_THREAD_HPP
+#define SIMULATION_THREAD_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "../render/render.hpp"
+#include "../util/triple_buffer.hpp"
+
+/*  Runs Renderer::simulate() at a fixed tick on its own thread and hands every tick to the GL
+    thread as a FrameSnapshot through a triple buffer. Neither side ever blocks on the other: a
+    slow simulation leaves the GL thread redrawing the last snapshot, a vsync stall leaves the
+    simulation overwriting snapshots nobody looked at.
+    The GL thread draws one tick in the past, blending the two newest snapshots it holds, so
+    motion stays smooth whatever the ratio between tick and frame rate.
+    The camera goes the other way through a second triple buffer, input is polled on the GL thread.
+    The thread spreads its ticks over a JobSystem of its own: a wait() runs whatever its system
+    has queued, so sharing the renderer's would let either thread stall on the other's jobs.
+ */
+class SimulationThread {
+public:
+    // tick is the fixed simulation step in seconds. jobThreads counts the simulation thread,
+    // 0 takes half the hardware threads and leaves the rest to the renderer's jobs.
+    SimulationThread(Renderer& renderer, double tick, unsigned int jobThreads = 0);
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    // The scene must be complete, shapes cannot be added while the thread runs
+    void start(const Camera& cam);
+    void stop();
+
+    // GL thread only
+    void set_camera(const Camera& cam);
+    // Draws nothing until the first snapshot has arrived
+    void render(float ratio);
+
+    std::uint64_t get_ticks() const;
+    // Ticks dropped because the simulation fell more than MAX_LAG_TICKS behind
+    std::uint64_t get_dropped_ticks() const;
+
+    static constexpr int MAX_LAG_TICKS = 5;
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    Renderer& renderer;
+    clock::duration tick;
+    unsigned int jobThreads;
+    clock::time_point epoch;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<std::uint64_t> ticks{0};
+    std::atomic<std::uint64_t> dropped{0};
+
+    TripleBuffer<FrameSnapshot> snapshots;
+    TripleBuffer<SnapshotCamera> cameras;
+    SnapshotCamera initialCamera;
+
+    // Owned by the GL thread, copies of the two newest snapshots
+    FrameSnapshot previous;
+    FrameSnapshot current;
+    bool hasSnapshot = false;
+
+    void run();
+};
+
+#endif //SIMULATION_THREAD_HPP
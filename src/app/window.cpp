@@ -1,19 +1,35 @@
 #include "window.hpp"
 #include <iostream>
 
-window::window(float width, float height) {
+window::window(float width, float height, bool headless) {
     this->width = width;
     this->height = height;
+    this->headless = headless;
 }
 
 int window::initialize() {
     //Intializes GLFW and set ups window
+    if (this->headless) glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
     glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-    GLFWwindow* window = glfwCreateWindow(this->width, this->height, "LearnOpenGL", nullptr, nullptr);
+    GLFWwindow* window = nullptr;
+    if (this->headless) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        // Surfaceless EGL first, OSMesa for Mesa builds without it
+        const int apis[] = {GLFW_EGL_CONTEXT_API, GLFW_OSMESA_CONTEXT_API};
+        for (const int api : apis) {
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, api);
+            window = glfwCreateWindow(this->width, this->height, "PlutoEngine", nullptr, nullptr);
+            if (window) break;
+        }
+        // Every shader is #version 460 and reads gl_BaseInstance, a 4.5 context would only draw nothing
+        if (window == nullptr) std::cout << "Headless rendering needs an OpenGL 4.6 context, older Mesa builds stop at 4.5" << std::endl;
+    } else {
+        window = glfwCreateWindow(this->width, this->height, "LearnOpenGL", nullptr, nullptr);
+    }
     this->wind = window;
     if (window == nullptr){
         std::cout << "Failed to create GLFW window" << std::endl;
@@ -38,3 +54,7 @@ int window::initialize() {
 GLFWwindow* window::get_window() const {
     return this->wind;
 }
+
+bool window::is_headless() const {
+    return this->headless;
+}
@@ -11,13 +11,18 @@
 
 class window {
 public:
-    window(float width, float height);
+    // headless creates no visible window: GLFW's null platform with an EGL context, or OSMesa
+    // when EGL is missing, both of which Mesa can run on the CPU. It needs GL 4.6 like the windowed
+    // path, initialize() fails without it. Draw into an OffscreenTarget then.
+    window(float width, float height, bool headless = false);
     int initialize();
     GLFWwindow* get_window() const;
+    bool is_headless() const;
 private:
     GLFWwindow* wind;
     float width;
     float height;
+    bool headless;
 };
 
 
@@ -1,21 +1,92 @@
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include "app/frame_loop.hpp"
+#include "app/simulation_thread.hpp"
 #include "app/window.hpp"
 #include "input/input.hpp"
 #include "render/shader.hpp"
 #include "PlutoMath/plutomath.hpp"
+#include "render/offscreen_target.hpp"
 #include "render/render.hpp"
-
-float deltaTime = 0.0f;	// Time between current frame and last frame
-float lastFrame = 0.0f; // Time of last frame
+#include "util/profiler.hpp"
 
 constexpr GLuint WIDTH = 800, HEIGHT = 600;
 constexpr float WID = 800.0, HIGH = 600.0f;
+constexpr double SIMULATION_TICK = 1.0 / 60.0;
+
+// Renders frames into an offscreen target and writes the last one to output. Time advances one
+// SIMULATION_TICK per frame rather than with the clock, so every run draws the same images.
+int run_headless(Renderer& renderer, const Camera& cam, const int frames, const char* output){
+    OffscreenTarget target(WIDTH, HEIGHT);
+    if (!target.is_complete()) {
+        std::fprintf(stderr, "Offscreen framebuffer is incomplete\n");
+        return 1;
+    }
+    target.bind();
+    // Textures stream in over several frames otherwise, and which frame they land on would vary
+    renderer.get_textures().finish();
+
+    app::FrameLoopSettings settings;
+    settings.step = SIMULATION_TICK;
+    settings.historySize = static_cast<std::size_t>(std::max(frames, 1));
+    app::FrameLoop loop(settings);
+    for (int frame = 0; frame < frames; ++frame) {
+        loop.begin_frame();
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        renderer.visualize(cam, WID/HIGH, static_cast<float>(SIMULATION_TICK));
+        // Nothing is presented, finishing the frame is what keeps the GPU time in the numbers
+        glFinish();
+        PLUTO_PROFILE_COLLECT();
+    }
+    // Closes the last frame's time
+    loop.begin_frame();
+
+    const auto stats = loop.get_stats();
+    std::printf("frames %d  mean %.3f ms  p50 %.3f ms  p90 %.3f ms  p99 %.3f ms  max %.3f ms  gl calls %u\n",
+                frames, stats.mean, stats.p50, stats.p90, stats.p99, stats.max, renderer.get_frame_stats().gl_calls());
+    if (output && !target.write_png(output)) {
+        std::fprintf(stderr, "Could not write %s\n", output);
+        return 1;
+    }
+    return 0;
+}
 
-int main(){
+// --sim-thread runs the simulation on its own thread at a fixed tick, decoupled from vsync
+// --fps <n> caps the frame rate, on top of whatever vsync does
+// --profile <file> writes a Chrome trace of the whole run, needs a PLUTO_ENABLE_PROFILER build
+// --headless renders --frames <n> frames (300) without a window, --output <file.png> saves the last
+int main(int argc, char** argv){
+    bool simThread = false;
+    bool headless = false;
+    int headlessFrames = 300;
+    const char* tracePath = nullptr;
+    const char* outputPath = nullptr;
+    app::FrameLoopSettings loopSettings;
+    loopSettings.step = SIMULATION_TICK;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--sim-thread") == 0) simThread = true;
+        else if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc) loopSettings.targetFrameRate = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc) tracePath = argv[++i];
+        else if (std::strcmp(argv[i], "--headless") == 0) headless = true;
+        else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) headlessFrames = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) outputPath = argv[++i];
+    }
+#ifndef PLUTO_PROFILE
+    if (tracePath) std::fprintf(stderr, "--profile ignored, built without PLUTO_ENABLE_PROFILER\n");
+    tracePath = nullptr;
+#endif
+    PLUTO_PROFILE_THREAD("Main");
+    if (tracePath) profiler().start_capture();
 
-    window win(WID,HIGH);
+    window win(WID,HIGH,headless);
     if (win.initialize() != 0) throw std::runtime_error("Initialization failed");
     auto control = input(win.get_window(),WID,HIGH,plutom::vec3f(0.0f,0.0f,-3.0f));
 
@@ -38,17 +109,56 @@ int main(){
         .scalingVector = plutom::vec3f(0.1f)
     });
 
-    while(!glfwWindowShouldClose(win.get_window())){
+    if (headless) {
+        const int result = run_headless(renderer, control.get_camera(), headlessFrames, outputPath);
+        if (tracePath) {
+            profiler().stop_capture();
+            if (!profiler().write_chrome_trace(tracePath)) std::fprintf(stderr, "Could not write %s\n", tracePath);
+        }
+        glfwTerminate();
+        return result;
+    }
 
-        const auto currentFrame = static_cast<float>(glfwGetTime());
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
-        control.update_delta(deltaTime);
+    std::unique_ptr<SimulationThread> simulation;
+    if (simThread) {
+        simulation = std::make_unique<SimulationThread>(renderer, SIMULATION_TICK);
+        simulation->start(control.get_camera());
+    }
+
+    // Without the simulation thread the loop steps the scene itself and draws the last two steps
+    // blended straight from it, the same way the thread's snapshots are drawn
+    app::FrameLoop loop(loopSettings);
+    while(!glfwWindowShouldClose(win.get_window())){
+        loop.begin_frame();
+        control.update_delta(loop.get_delta());
         glfwPollEvents();
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        renderer.visualize(control.get_camera(),WID/HIGH,deltaTime);
+        if (simulation) {
+            simulation->set_camera(control.get_camera());
+            simulation->render(WID/HIGH);
+        } else {
+            while (loop.step()) renderer.simulate(loop.get_step());
+            // The camera follows input events rather than steps, draw with where it is now
+            renderer.draw(control.get_camera(), WID/HIGH, loop.get_alpha());
+        }
         glfwSwapBuffers(win.get_window());
+        loop.end_frame();
+        PLUTO_PROFILE_COLLECT();
+
+        if (loop.get_frame() % 240 == 0) {
+            const auto stats = loop.get_stats();
+            char title[128];
+            std::snprintf(title, sizeof(title), "PlutoEngine  %.2f ms p50  %.2f ms p99  %.2f ms max", stats.p50,
+                          stats.p99, stats.max);
+            glfwSetWindowTitle(win.get_window(), title);
+        }
+    }
+    if (simulation) simulation->stop();
+    if (tracePath) {
+        profiler().collect();
+        profiler().stop_capture();
+        if (!profiler().write_chrome_trace(tracePath)) std::fprintf(stderr, "Could not write %s\n", tracePath);
     }
     //glDeleteVertexArrays(1, &VAO);
     //glDeleteBuffers(1, &VBO);
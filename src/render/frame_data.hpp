@@ -0,0 +1,53 @@
+#ifndef FRAME_DATA_HPP
+#define FRAME_DATA_HPP
+
+#include <cstdint>
+
+#include "../PlutoMath/plutomath.hpp"
+
+// CPU mirrors of the buffer blocks declared in the shaders. Everything is made of vec4/mat4
+// so std140 and std430 agree with the C++ layout without manual padding.
+
+constexpr unsigned int FRAME_DATA_BINDING = 0;   // uniform block FrameData
+constexpr unsigned int OBJECT_DATA_BINDING = 1;  // shader storage block ObjectBuffer
+constexpr unsigned int MAX_LIGHTS = 8;
+constexpr unsigned int MATERIAL_TEXTURE_UNIT = 0;   // sampler2DArray materialTextures
+constexpr std::uint32_t MATERIAL_TEXTURED = 1;      // MaterialTexture::flags
+
+struct GpuLight {
+    plutom::vec4f position;  // xyz, w unused
+    plutom::vec4f color;     // rgb, w unused
+};
+
+// std140, uploaded once per frame
+struct FrameData {
+    plutom::mat4f view;
+    plutom::mat4f projection;
+    plutom::mat4f viewProj;
+    plutom::vec4f viewPos;
+    GpuLight lights[MAX_LIGHTS];
+    int lightCount;
+    int padding[3];
+};
+
+// Where the shader samples an object's texture, filled by the MaterialSystem
+struct MaterialTexture {
+    std::uint32_t layer;       // layer of materialTextures, unused with bindless handles
+    std::uint32_t handleLow;   // ARB_bindless_texture handle, 0 without
+    std::uint32_t handleHigh;
+    std::uint32_t flags;
+};
+
+// std430, one entry per draw, indexed with gl_BaseInstance + gl_InstanceID
+struct ObjectData {
+    plutom::mat4f model;
+    plutom::mat4f normalMatrix;  // upper 3x3 used, kept as mat4 to avoid mat3 padding rules
+    plutom::vec4f color;         // rgb, shininess in w
+    MaterialTexture texture;
+};
+
+static_assert(sizeof(GpuLight) == 32, "GpuLight must match the std140 layout");
+static_assert(sizeof(FrameData) == 3 * 64 + 16 + MAX_LIGHTS * 32 + 16, "FrameData must match the std140 layout");
+static_assert(sizeof(ObjectData) == 160, "ObjectData must match the std430 layout");
+
+#endif //FRAME_DATA_HPP
@@ -0,0 +1,57 @@
+#ifndef FRAME_SNAPSHOT_HPP
+#define FRAME_SNAPSHOT_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "../PlutoMath/plutomath.hpp"
+#include "../input/camera.hpp"
+#include "../scene/mesh_handle.hpp"
+
+// Everything the render thread needs to draw one simulation tick, copied out of the scene by
+// Renderer::capture() so the simulation can move on while it is drawn. Renderer::render()
+// blends two of them, so all of it is plain values.
+
+struct SnapshotCamera {
+    plutom::vec3f position{0.0f};
+    plutom::vec3f front{0.0f, 0.0f, -1.0f};
+    plutom::vec3f up{0.0f, 1.0f, 0.0f};
+    float zoom = ZOOM;
+    bool showDebugAxis = false;
+
+    static SnapshotCamera from(const Camera& cam) {
+        return {cam.Position, cam.Front, cam.Up, cam.Zoom, cam.show_debug_axis};
+    }
+
+    plutom::mat4f get_view_matrix() const {
+        return plutom::lookAt(position, position + front, up);
+    }
+};
+
+struct SnapshotLight {
+    plutom::vec3f position;
+    plutom::vec3f color;
+};
+
+// One per shape, indexed like the Renderer's shapes
+struct SnapshotObject {
+    plutom::mat4f model;
+    plutom::vec4f color;  // rgb, shininess in w
+    MeshHandle mesh;
+    unsigned int program = 0;
+    unsigned int texture = 0;  // MaterialSystem texture id
+    bool wireframe = false;
+    bool visible = true;
+};
+
+struct FrameSnapshot {
+    std::uint64_t tick = 0;
+    double time = 0.0;  // simulation time of the tick in seconds
+    SnapshotCamera view;
+    std::vector<SnapshotLight> lights;
+    std::vector<SnapshotObject> objects;
+    // World bounds of objects[i], kept apart so culling streams through them
+    plutom::aabb_batchf bounds;
+};
+
+#endif //FRAME_SNAPSHOT_HPP
@@ -0,0 +1,32 @@
+#ifndef FRAME_STATS_HPP
+#define FRAME_STATS_HPP
+
+// Counts the GL calls issued by the renderer in one frame. Only calls made through
+// Shader and Renderer are tracked, buffer clears and swaps in the main loop are not.
+struct FrameStats {
+    unsigned int uniformLookups = 0;   // glGetUniformLocation
+    unsigned int uniformUploads = 0;   // glUniform*
+    unsigned int programBinds = 0;
+    unsigned int vertexArrayBinds = 0;
+    unsigned int textureBinds = 0;
+    unsigned int bufferBinds = 0;      // glBindBufferRange
+    unsigned int bufferMaps = 0;       // glMapBufferRange
+    unsigned int stateChanges = 0;     // glPolygonMode, glActiveTexture, ...
+    unsigned int drawCalls = 0;
+
+    unsigned int gl_calls() const {
+        return uniformLookups + uniformUploads + programBinds + vertexArrayBinds +
+               textureBinds + bufferBinds + bufferMaps + stateChanges + drawCalls;
+    }
+
+    void reset() {
+        *this = FrameStats{};
+    }
+};
+
+inline FrameStats& frame_stats() {
+    static FrameStats stats;
+    return stats;
+}
+
+#endif //FRAME_STATS_HPP
@@ -0,0 +1,222 @@
+#include "geometry_registry.hpp"
+#include "../util/mapped_file.hpp"
+#include "../util/mesh_optimizer.hpp"
+#include "../util/profiler.hpp"
+
+#include <glad/gl.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+
+namespace {
+    unsigned int create_buffer(const GLenum target, const std::size_t bytes) {
+        unsigned int buffer;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(target, buffer);
+        glBufferData(target, static_cast<GLsizeiptr>(bytes), nullptr, GL_STATIC_DRAW);
+        return buffer;
+    }
+
+    // Replaces buffer with a larger one holding the first used bytes
+    void resize_buffer(unsigned int& buffer, const std::size_t used, const std::size_t bytes) {
+        unsigned int larger;
+        glGenBuffers(1, &larger);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, larger);
+        glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(used));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glDeleteBuffers(1, &buffer);
+        buffer = larger;
+    }
+}
+
+GeometryRegistry::GeometryRegistry(const std::size_t vertexCapacity, const std::size_t indexCapacity)
+    : vertexCapacity(vertexCapacity), indexCapacity(indexCapacity) {
+    glGenVertexArrays(1, &VAO);
+    VBO = create_buffer(GL_ARRAY_BUFFER, vertexCapacity * VERTEX_STRIDE);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(VAO);
+    EBO = create_buffer(GL_ELEMENT_ARRAY_BUFFER, indexCapacity * sizeof(unsigned int));
+    bind_layout();
+    glBindVertexArray(0);
+}
+
+GeometryRegistry::~GeometryRegistry() {
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+}
+
+void GeometryRegistry::bind_layout() const {
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, VERTEX_STRIDE,
+                          reinterpret_cast<void*>(offsetof(PackedVertex, position)));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, VERTEX_STRIDE,
+                          reinterpret_cast<void*>(offsetof(PackedVertex, normal)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, VERTEX_STRIDE,
+                          reinterpret_cast<void*>(offsetof(PackedVertex, uv)));
+    glEnableVertexAttribArray(2);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void GeometryRegistry::grow(const std::size_t vertices, const std::size_t indices) {
+    if (vertexCount + vertices > vertexCapacity) {
+        const std::size_t capacity = std::max(vertexCapacity * 2, vertexCount + vertices);
+        resize_buffer(VBO, vertexCount * VERTEX_STRIDE, capacity * VERTEX_STRIDE);
+        vertexCapacity = capacity;
+    }
+    if (indexCount + indices > indexCapacity) {
+        const std::size_t capacity = std::max(indexCapacity * 2, indexCount + indices);
+        resize_buffer(EBO, indexCount * sizeof(unsigned int), capacity * sizeof(unsigned int));
+        indexCapacity = capacity;
+    }
+    // The VAO still points at the old buffers
+    bind_layout();
+}
+
+MeshHandle GeometryRegistry::add_mesh(const std::string& name, const primative& mesh) {
+    return add_mesh(name, mesh.vertices.data(), mesh.vertices.size() / 8, mesh.indices.data(), mesh.indices.size());
+}
+
+MeshHandle GeometryRegistry::add_mesh(const std::string& name, const float* vertices, const std::size_t vertexCount,
+                                      const unsigned int* indices, const std::size_t indexCount) {
+    if (const auto it = byName.find(name); it != byName.end()) return meshes[it->second].handle;
+
+    std::vector<PackedVertex> packed(vertexCount);
+    plutom::aabbf bounds;
+    for (std::size_t v = 0; v < vertexCount; ++v) {
+        const float* vertex = vertices + v * 8;
+        packed[v] = pack_vertex(vertex);
+        bounds.expand(plutom::vec3f{vertex[0], vertex[1], vertex[2]});
+    }
+    std::size_t packedCount = vertexCount;
+    std::vector<unsigned int> reordered;
+    if (optimize) {
+        reordered.assign(indices, indices + indexCount);
+        packedCount = mesh_optimizer::optimize(packed.data(), vertexCount, VERTEX_STRIDE, reordered.data(), indexCount);
+        indices = reordered.data();
+    }
+    const MeshHandle handle = reserve(name, packedCount, indexCount, bounds);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(handle.baseVertex * VERTEX_STRIDE),
+                    static_cast<GLsizeiptr>(packedCount * VERTEX_STRIDE), packed.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // The element buffer binding is VAO state, bind it through a neutral target instead
+    glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(handle.firstIndex * sizeof(unsigned int)),
+                    static_cast<GLsizeiptr>(indexCount * sizeof(unsigned int)), indices);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return handle;
+}
+
+MeshHandle GeometryRegistry::load_mesh(const std::string& path) {
+    if (const auto it = byName.find(path); it != byName.end()) return meshes[it->second].handle;
+    PLUTO_PROFILE_FUNCTION();
+
+    const MappedFile file(path);
+    PmeshView view;
+    if (!file.is_open() || !view.parse(file.data(), file.size())) {
+        std::cout << "Failed to load mesh " << path << std::endl;
+        return {};
+    }
+    const PmeshHeader& header = *view.header;
+    const plutom::aabbf bounds(plutom::vec3f{header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]},
+                               plutom::vec3f{header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]});
+    const MeshHandle handle = reserve(path, header.vertexCount, header.indexCount, bounds);
+
+    // GL copies out of the mapping, the pages come in from the OS cache as it reads them
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(handle.baseVertex * VERTEX_STRIDE),
+                    static_cast<GLsizeiptr>(header.vertexCount * VERTEX_STRIDE), view.vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    const auto indexOffset = static_cast<GLintptr>(handle.firstIndex * sizeof(unsigned int));
+    const auto indexBytes = static_cast<GLsizeiptr>(header.indexCount * sizeof(unsigned int));
+    glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+    if (header.indexSize == sizeof(unsigned int)) {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, indexOffset, indexBytes, view.indices);
+    } else {
+        // 16 bit indices are widened as they are written into the arena, nothing is staged
+        auto* out = static_cast<unsigned int*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, indexOffset, indexBytes,
+                                                                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT));
+        const auto* in = reinterpret_cast<const std::uint16_t*>(view.indices);
+        bool written = false;
+        if (out) {
+            for (std::uint32_t i = 0; i < header.indexCount; ++i) out[i] = in[i];
+            // GL_FALSE means the store was lost while mapped and the range holds garbage
+            written = glUnmapBuffer(GL_COPY_WRITE_BUFFER) == GL_TRUE;
+        }
+        if (!written) {
+            // The handle is already out in the arena, widen through a staging copy rather than fail
+            const std::vector<unsigned int> widened(in, in + header.indexCount);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, indexOffset, indexBytes, widened.data());
+        }
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return handle;
+}
+
+MeshHandle GeometryRegistry::reserve(const std::string& name, const std::size_t vertices, const std::size_t indices,
+                                     const plutom::aabbf& bounds) {
+    if (vertexCount + vertices > vertexCapacity || indexCount + indices > indexCapacity)
+        grow(vertices, indices);
+
+    MeshHandle handle;
+    handle.id = static_cast<unsigned int>(meshes.size());
+    handle.baseVertex = static_cast<int>(vertexCount);
+    handle.firstIndex = static_cast<unsigned int>(indexCount);
+    handle.indexCount = static_cast<unsigned int>(indices);
+    meshes.push_back({name, handle, static_cast<unsigned int>(vertices), vertices * VERTEX_STRIDE,
+                      indices * sizeof(unsigned int), bounds});
+    byName.emplace(name, handle.id);
+
+    vertexCount += vertices;
+    indexCount += indices;
+    return handle;
+}
+
+void GeometryRegistry::set_optimize(const bool enabled) {
+    optimize = enabled;
+}
+
+MeshHandle GeometryRegistry::find(const std::string& name) const {
+    const auto it = byName.find(name);
+    return it == byName.end() ? MeshHandle{} : meshes[it->second].handle;
+}
+
+const plutom::aabbf& GeometryRegistry::get_bounds(const MeshHandle& handle) const {
+    return meshes[handle.id].bounds;
+}
+
+unsigned int GeometryRegistry::get_vao() const {
+    return VAO;
+}
+
+const std::vector<MeshInfo>& GeometryRegistry::get_meshes() const {
+    return meshes;
+}
+
+std::size_t GeometryRegistry::get_used_bytes() const {
+    return vertexCount * VERTEX_STRIDE + indexCount * sizeof(unsigned int);
+}
+
+std::size_t GeometryRegistry::get_capacity_bytes() const {
+    return vertexCapacity * VERTEX_STRIDE + indexCapacity * sizeof(unsigned int);
+}
+
+void GeometryRegistry::print_memory_usage() const {
+    for (const auto& mesh : meshes) {
+        std::cout << mesh.name << ": " << mesh.vertexCount << " vertices, " << mesh.handle.indexCount
+                  << " indices, " << mesh.vertexBytes + mesh.indexBytes << " bytes" << std::endl;
+    }
+    std::cout << "Geometry arena: " << get_used_bytes() << " / " << get_capacity_bytes() << " bytes used" << std::endl;
+}
@@ -0,0 +1,77 @@
+#ifndef GEOMETRY_REGISTRY_HPP
+#define GEOMETRY_REGISTRY_HPP
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../PlutoMath/bounds.hpp"
+#include "../scene/mesh_handle.hpp"
+#include "../util/pmesh_format.hpp"
+#include "../util/primativegenerator.hpp"
+
+struct MeshInfo {
+    std::string name;
+    MeshHandle handle;
+    unsigned int vertexCount;
+    std::size_t vertexBytes;
+    std::size_t indexBytes;
+    // Object space bounds of the vertex positions
+    plutom::aabbf bounds;
+};
+
+// Uploads every mesh once into one vertex buffer and one index buffer behind a single VAO.
+// Meshes are appended, the arenas double (copying on the GPU) when they run out of space.
+// Vertices are stored as PackedVertex: float position, 10 bit normal and half float uv in 20
+// bytes, where the 8 floats of the primative layout take 32. Cooked .pmesh files are already in
+// that layout and go to GL straight from their mapping.
+class GeometryRegistry {
+public:
+    GeometryRegistry(std::size_t vertexCapacity = 1 << 16, std::size_t indexCapacity = 1 << 18);
+    ~GeometryRegistry();
+
+    GeometryRegistry(const GeometryRegistry&) = delete;
+    GeometryRegistry& operator=(const GeometryRegistry&) = delete;
+
+    // Returns the existing handle if a mesh with this name was already added
+    MeshHandle add_mesh(const std::string& name, const primative& mesh);
+    MeshHandle add_mesh(const std::string& name, const float* vertices, std::size_t vertexCount,
+                        const unsigned int* indices, std::size_t indexCount);
+    // Maps a .pmesh written by pluto_cook, named by its path. Invalid handle if it cannot be read.
+    MeshHandle load_mesh(const std::string& path);
+    // Runs the mesh_optimizer over meshes passed to add_mesh() from then on, off by default.
+    // Cooked .pmesh files were optimized by pluto_cook and go in as they are.
+    void set_optimize(bool enabled);
+    // Invalid handle if the name is unknown
+    MeshHandle find(const std::string& name) const;
+    const plutom::aabbf& get_bounds(const MeshHandle& handle) const;
+
+    unsigned int get_vao() const;
+    const std::vector<MeshInfo>& get_meshes() const;
+    std::size_t get_used_bytes() const;
+    std::size_t get_capacity_bytes() const;
+    void print_memory_usage() const;
+
+    static constexpr std::size_t VERTEX_STRIDE = sizeof(PackedVertex);
+
+private:
+    unsigned int VAO = 0;
+    unsigned int VBO = 0;
+    unsigned int EBO = 0;
+    std::size_t vertexCapacity;
+    std::size_t indexCapacity;
+    std::size_t vertexCount = 0;
+    std::size_t indexCount = 0;
+    bool optimize = false;
+
+    std::vector<MeshInfo> meshes;
+    std::unordered_map<std::string, unsigned int> byName;
+
+    void grow(std::size_t vertices, std::size_t indices);
+    // Makes room for a mesh and records it, the caller then writes its data at the handle
+    MeshHandle reserve(const std::string& name, std::size_t vertices, std::size_t indices, const plutom::aabbf& bounds);
+    void bind_layout() const;
+};
+
+#endif //GEOMETRY_REGISTRY_HPP
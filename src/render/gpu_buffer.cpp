@@ -0,0 +1,138 @@
+#include "gpu_buffer.hpp"
+#include "frame_stats.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+GpuRingBuffer::GpuRingBuffer(const GLenum target, const std::size_t regionSize, const unsigned int frameCount)
+    : target(target), frameCount(std::clamp(frameCount, 1u, MAX_FRAMES)), regionSize(regionSize) {
+    int uniformAlignment = 0, storageAlignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+    alignment = static_cast<std::size_t>(std::max({uniformAlignment, storageAlignment, 16}));
+    this->regionSize = (regionSize + alignment - 1) / alignment * alignment;
+    persistent = GLAD_GL_VERSION_4_4 != 0;
+    create();
+}
+
+GpuRingBuffer::~GpuRingBuffer() {
+    destroy();
+}
+
+void GpuRingBuffer::create() {
+    const auto total = static_cast<GLsizeiptr>(regionSize * frameCount);
+    glGenBuffers(1, &buffer);
+    glBindBuffer(target, buffer);
+    if (persistent) {
+        constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(target, total, nullptr, flags);
+        mapped = static_cast<unsigned char*>(glMapBufferRange(target, 0, total, flags));
+        if (mapped == nullptr) throw std::runtime_error("Failed to persistently map ring buffer");
+    } else {
+        glBufferData(target, total, nullptr, GL_DYNAMIC_DRAW);
+    }
+    glBindBuffer(target, 0);
+}
+
+void GpuRingBuffer::destroy() {
+    for (unsigned int i = 0; i < frameCount; ++i) {
+        if (fences[i] != nullptr) glDeleteSync(fences[i]);
+        fences[i] = nullptr;
+    }
+    if (buffer != 0) {
+        if (mapped != nullptr) {
+            glBindBuffer(target, buffer);
+            glUnmapBuffer(target);
+            glBindBuffer(target, 0);
+        }
+        glDeleteBuffers(1, &buffer);
+    }
+    buffer = 0;
+    mapped = nullptr;
+}
+
+void GpuRingBuffer::wait(const unsigned int index) {
+    if (fences[index] == nullptr) return;
+    // Flush on the first wait only, the fence may not have been submitted yet
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (true) {
+        const GLenum result = glClientWaitSync(fences[index], flags, 1000000);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) break;
+        if (result == GL_WAIT_FAILED) throw std::runtime_error("glClientWaitSync failed on ring buffer fence");
+        flags = 0;
+    }
+    glDeleteSync(fences[index]);
+    fences[index] = nullptr;
+}
+
+void GpuRingBuffer::reserve(const std::size_t bytes) {
+    if (bytes <= regionSize) return;
+    for (unsigned int i = 0; i < frameCount; ++i) wait(i);
+    destroy();
+    regionSize = (std::max(bytes, regionSize * 2) + alignment - 1) / alignment * alignment;
+    create();
+}
+
+void GpuRingBuffer::begin_frame() {
+    region = (region + 1) % frameCount;
+    head = 0;
+    wait(region);
+    if (!persistent) {
+        constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+        glBindBuffer(target, buffer);
+        mapped = static_cast<unsigned char*>(glMapBufferRange(target, static_cast<GLintptr>(region * regionSize),
+                                                              static_cast<GLsizeiptr>(regionSize), flags));
+        glBindBuffer(target, 0);
+        if (mapped == nullptr) throw std::runtime_error("Failed to map ring buffer region");
+        frame_stats().bufferMaps += 1;
+    }
+}
+
+GpuRingBuffer::Allocation GpuRingBuffer::allocate(const std::size_t bytes) {
+    if (head + bytes > regionSize) throw std::length_error("Ring buffer region exhausted, reserve() more space");
+    const std::size_t offset = head;
+    head = (head + bytes + alignment - 1) / alignment * alignment;
+    // A persistent mapping covers every region, a per-frame mapping only the current one
+    unsigned char* base = persistent ? mapped + region * regionSize : mapped;
+    return {base + offset, offset};
+}
+
+void GpuRingBuffer::flush() {
+    if (persistent || mapped == nullptr) return;
+    glBindBuffer(target, buffer);
+    glUnmapBuffer(target);
+    glBindBuffer(target, 0);
+    mapped = nullptr;
+}
+
+void GpuRingBuffer::end_frame() {
+    flush();
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void GpuRingBuffer::bind_range(const GLuint index, const std::size_t offset, const std::size_t bytes) const {
+    glBindBufferRange(target, index, buffer, static_cast<GLintptr>(region * regionSize + offset),
+                      static_cast<GLsizeiptr>(bytes));
+    frame_stats().bufferBinds += 1;
+}
+
+void GpuRingBuffer::bind() const {
+    glBindBuffer(target, buffer);
+    frame_stats().bufferBinds += 1;
+}
+
+std::size_t GpuRingBuffer::buffer_offset(const std::size_t offset) const {
+    return region * regionSize + offset;
+}
+
+unsigned int GpuRingBuffer::get_id() const {
+    return buffer;
+}
+
+std::size_t GpuRingBuffer::get_region_size() const {
+    return regionSize;
+}
+
+bool GpuRingBuffer::is_persistent() const {
+    return persistent;
+}
@@ -0,0 +1,68 @@
+#ifndef GPU_BUFFER_HPP
+#define GPU_BUFFER_HPP
+
+#include <glad/gl.h>
+
+#include <cstddef>
+
+// Streaming buffer split into frameCount regions, one written by the CPU while the GPU
+// may still be reading the others. A fence per region keeps the CPU from overwriting data
+// in flight. On GL 4.4+ the buffer is persistently mapped once, older contexts map the
+// current region each frame with GL_MAP_UNSYNCHRONIZED_BIT since the fences already order it.
+class GpuRingBuffer {
+public:
+    struct Allocation {
+        void* data;
+        std::size_t offset; // relative to the start of the current region, pass to bind_range
+    };
+
+    GpuRingBuffer(GLenum target, std::size_t regionSize, unsigned int frameCount = 3);
+    ~GpuRingBuffer();
+
+    GpuRingBuffer(const GpuRingBuffer&) = delete;
+    GpuRingBuffer& operator=(const GpuRingBuffer&) = delete;
+
+    // Grows every region to hold at least bytes. Waits for the GPU when it has to reallocate,
+    // so call it before begin_frame with the frame's worst case.
+    void reserve(std::size_t bytes);
+
+    // Moves to the next region, waiting on its fence if the GPU is still using it
+    void begin_frame();
+    // Suballocates from the current region, offsets are aligned for glBindBufferRange
+    Allocation allocate(std::size_t bytes);
+    // Ends CPU writes for the frame. Without persistent mapping the region has to be unmapped
+    // before any draw reads from it, so call this between filling and drawing.
+    void flush();
+    // Fences the region so it is not reused until the draws reading it have finished
+    void end_frame();
+
+    void bind_range(GLuint index, std::size_t offset, std::size_t bytes) const;
+    // For non-indexed targets such as GL_DRAW_INDIRECT_BUFFER, where the offset goes to the draw call
+    void bind() const;
+    // Offset of an allocation from the start of the whole buffer
+    std::size_t buffer_offset(std::size_t offset) const;
+
+    unsigned int get_id() const;
+    std::size_t get_region_size() const;
+    bool is_persistent() const;
+
+private:
+    static constexpr unsigned int MAX_FRAMES = 4;
+
+    GLenum target;
+    unsigned int buffer = 0;
+    unsigned int frameCount;
+    unsigned int region = 0;
+    std::size_t regionSize;
+    std::size_t head = 0;
+    std::size_t alignment = 256;
+    bool persistent = false;
+    unsigned char* mapped = nullptr;
+    GLsync fences[MAX_FRAMES] = {};
+
+    void create();
+    void destroy();
+    void wait(unsigned int index);
+};
+
+#endif //GPU_BUFFER_HPP
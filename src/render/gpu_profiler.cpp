@@ -0,0 +1,80 @@
+#include "gpu_profiler.hpp"
+
+#include <algorithm>
+
+GpuProfiler::GpuProfiler(const unsigned int frameCount) : frameCount(std::clamp(frameCount, 1u, MAX_FRAMES)) {}
+
+GpuProfiler::~GpuProfiler() {
+    for (auto& frame : frames) {
+        if (!frame.queries.empty()) glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+    }
+}
+
+void GpuProfiler::begin_frame() {
+    if (track == ~0u) track = profiler().add_track("GPU");
+    current = (current + 1) % frameCount;
+    Frame& frame = frames[current];
+    if (frame.pending) read_back(frame);
+
+    frame.scopes.clear();
+    frame.used = 0;
+    frame.last = 0;
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    frame.clockOffset = static_cast<std::int64_t>(profiler().now()) - gpuNow;
+    recording = true;
+}
+
+void GpuProfiler::end_frame() {
+    frames[current].pending = !frames[current].scopes.empty();
+    recording = false;
+}
+
+unsigned int GpuProfiler::begin(const char* name) {
+    if (!recording) return ~0u;
+    Frame& frame = frames[current];
+    if (frame.used + 2 > frame.queries.size()) {
+        // Grows in chunks, a frame usually needs the same handful every time
+        const std::size_t added = std::max<std::size_t>(16, frame.queries.size());
+        frame.queries.resize(frame.queries.size() + added);
+        glGenQueries(static_cast<GLsizei>(added), frame.queries.data() + frame.queries.size() - added);
+    }
+    const unsigned int first = frame.used;
+    frame.used += 2;
+    glQueryCounter(frame.queries[first], GL_TIMESTAMP);
+    frame.last = first;
+    frame.scopes.push_back({name, first});
+    return static_cast<unsigned int>(frame.scopes.size() - 1);
+}
+
+void GpuProfiler::end(const unsigned int scope) {
+    if (!recording || scope == ~0u) return;
+    Frame& frame = frames[current];
+    frame.last = frame.scopes[scope].first + 1;
+    glQueryCounter(frame.queries[frame.last], GL_TIMESTAMP);
+}
+
+void GpuProfiler::read_back(Frame& frame) {
+    frame.pending = false;
+    // Timestamps land in issue order, if the last one issued has landed so have the others
+    GLuint available = 0;
+    glGetQueryObjectuiv(frame.queries[frame.last], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return;
+
+    std::uint64_t frameStart = ~0ull, frameEnd = 0;
+    for (const auto& scope : frame.scopes) {
+        GLuint64 start = 0, end = 0;
+        glGetQueryObjectui64v(frame.queries[scope.first], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(frame.queries[scope.first + 1], GL_QUERY_RESULT, &end);
+        end = std::max(end, start);
+        frameStart = std::min<std::uint64_t>(frameStart, start);
+        frameEnd = std::max<std::uint64_t>(frameEnd, end);
+        profiler().record(track, scope.name, static_cast<std::uint64_t>(static_cast<std::int64_t>(start) + frame.clockOffset),
+                          static_cast<std::uint64_t>(static_cast<std::int64_t>(end) + frame.clockOffset));
+    }
+    lastFrameMs = static_cast<double>(frameEnd - frameStart) / 1e6;
+}
+
+double GpuProfiler::get_last_frame_ms() const {
+    return lastFrameMs;
+}
@@ -0,0 +1,86 @@
+#ifndef GPU_PROFILER_HPP
+#define GPU_PROFILER_HPP
+
+#include <glad/gl.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "../util/profiler.hpp"
+
+/*  Times GPU passes with GL_TIMESTAMP queries and hands them to the Profiler on a "GPU" track,
+    shifted onto the CPU clock. Queries are pooled per frame in flight and read back frameCount
+    frames later, once GL_QUERY_RESULT_AVAILABLE says so, so profiling never stalls the pipeline;
+    a frame whose results are still not in by then is dropped. Timestamps rather than
+    GL_TIME_ELAPSED so scopes can nest. No GL object is created until the first begin_frame().
+    Use the PLUTO_PROFILE_GPU_* macros, they compile out with the CPU ones.
+ */
+class GpuProfiler {
+public:
+    explicit GpuProfiler(unsigned int frameCount = 3);
+    ~GpuProfiler();
+
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    void begin_frame();
+    void end_frame();
+    // Returns the scope to pass to end()
+    unsigned int begin(const char* name);
+    void end(unsigned int scope);
+
+    // GPU time of the last frame read back, in milliseconds
+    double get_last_frame_ms() const;
+
+private:
+    static constexpr unsigned int MAX_FRAMES = 4;
+
+    struct Scope {
+        const char* name;
+        unsigned int first;  // query pair first, first + 1
+    };
+    struct Frame {
+        std::vector<GLuint> queries;
+        std::vector<Scope> scopes;
+        unsigned int used = 0;
+        unsigned int last = 0;         // query issued last, an outer scope's end comes after its inner ones
+        std::int64_t clockOffset = 0;  // CPU minus GPU time when the frame started
+        bool pending = false;
+    };
+
+    Frame frames[MAX_FRAMES];
+    unsigned int frameCount;
+    unsigned int current = 0;
+    bool recording = false;
+    std::uint32_t track = ~0u;
+    double lastFrameMs = 0.0;
+
+    void read_back(Frame& frame);
+};
+
+class GpuProfileScope {
+public:
+    GpuProfileScope(GpuProfiler& gpu, const char* name) : gpu(gpu), scope(gpu.begin(name)) {}
+    ~GpuProfileScope() {
+        gpu.end(scope);
+    }
+
+    GpuProfileScope(const GpuProfileScope&) = delete;
+    GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+    GpuProfiler& gpu;
+    unsigned int scope;
+};
+
+#ifdef PLUTO_PROFILE
+#define PLUTO_PROFILE_GPU_BEGIN_FRAME(gpu) (gpu).begin_frame()
+#define PLUTO_PROFILE_GPU_END_FRAME(gpu) (gpu).end_frame()
+#define PLUTO_PROFILE_GPU_SCOPE(gpu, name) GpuProfileScope PLUTO_PROFILE_CONCAT(gpuProfileScope, __LINE__)(gpu, name)
+#else
+#define PLUTO_PROFILE_GPU_BEGIN_FRAME(gpu) ((void)0)
+#define PLUTO_PROFILE_GPU_END_FRAME(gpu) ((void)0)
+#define PLUTO_PROFILE_GPU_SCOPE(gpu, name) ((void)0)
+#endif
+
+#endif //GPU_PROFILER_HPP
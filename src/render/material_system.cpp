@@ -0,0 +1,98 @@
+#include "material_system.hpp"
+#include "frame_stats.hpp"
+#include "gl_extensions.hpp"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+
+namespace {
+    MaterialTexture handle_texture(const GLuint64 handle) {
+        return {0, static_cast<std::uint32_t>(handle), static_cast<std::uint32_t>(handle >> 32), MATERIAL_TEXTURED};
+    }
+}
+
+MaterialSystem::MaterialSystem(TextureManager& textures, const bool allowBindless) : textures(textures), bindless(false) {
+    entries.emplace_back();  // NO_TEXTURE
+    if (allowBindless && has_gl_extension("GL_ARB_bindless_texture")) {
+        getTextureHandle = reinterpret_cast<GetTextureHandle>(glfwGetProcAddress("glGetTextureHandleARB"));
+        makeResident = reinterpret_cast<MakeTextureHandleResident>(glfwGetProcAddress("glMakeTextureHandleResidentARB"));
+        makeNonResident = reinterpret_cast<MakeTextureHandleNonResident>(glfwGetProcAddress("glMakeTextureHandleNonResidentARB"));
+        bindless = getTextureHandle && makeResident && makeNonResident;
+    }
+
+    if (bindless) {
+        // Taking a handle freezes a texture, so the TextureManager's own placeholders cannot be used
+        constexpr unsigned char white[4] = {255, 255, 255, 255};
+        glGenTextures(1, &placeholder);
+        glBindTexture(GL_TEXTURE_2D, placeholder);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        placeholderTexture = make_handle(placeholder);
+    } else {
+        placeholderTexture = {TextureManager::PLACEHOLDER_LAYER, 0, 0, MATERIAL_TEXTURED};
+    }
+}
+
+MaterialSystem::~MaterialSystem() {
+    if (!bindless) return;
+    for (const auto& entry : entries) {
+        if (entry.ready) makeNonResident(static_cast<GLuint64>(entry.gpu.handleHigh) << 32 | entry.gpu.handleLow);
+    }
+    makeNonResident(static_cast<GLuint64>(placeholderTexture.handleHigh) << 32 | placeholderTexture.handleLow);
+    glDeleteTextures(1, &placeholder);
+}
+
+std::uint32_t MaterialSystem::add_texture(const std::string& path, const bool flip) {
+    const std::string key = flip ? path + "#flipped" : path;
+    if (const auto found = idOf.find(key); found != idOf.end()) return found->second;
+
+    const auto id = static_cast<std::uint32_t>(entries.size());
+    Entry entry;
+    entry.texture = bindless ? textures.load(path, flip) : textures.load_layer(path, flip);
+    entry.gpu = placeholderTexture;
+    entries.push_back(entry);
+    idOf.emplace(key, id);
+    pending.push_back(id);
+    return id;
+}
+
+void MaterialSystem::update() {
+    pending.erase(std::remove_if(pending.begin(), pending.end(), [this](const std::uint32_t id) {
+        Entry& entry = entries[id];
+        // A texture that failed keeps the placeholder, there is nothing left to wait for
+        if (bindless ? textures.is_failed(entry.texture) : textures.is_layer_failed(entry.texture)) return true;
+        if (bindless ? !textures.is_resident(entry.texture) : !textures.is_layer_resident(entry.texture)) return false;
+        entry.gpu = bindless ? make_handle(entry.texture) : MaterialTexture{entry.texture, 0, 0, MATERIAL_TEXTURED};
+        entry.ready = true;
+        return true;
+    }), pending.end());
+}
+
+void MaterialSystem::bind() const {
+    if (bindless || !textures.get_array()) return;
+    glActiveTexture(GL_TEXTURE0 + MATERIAL_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textures.get_array());
+    frame_stats().stateChanges += 1;
+    frame_stats().textureBinds += 1;
+}
+
+MaterialTexture MaterialSystem::get(const std::uint32_t id) const {
+    return id < entries.size() ? entries[id].gpu : MaterialTexture{};
+}
+
+bool MaterialSystem::is_bindless() const {
+    return bindless;
+}
+
+std::string MaterialSystem::get_shader_defines() const {
+    return bindless ? "#define PLUTO_BINDLESS_TEXTURES 1\n" : "";
+}
+
+MaterialTexture MaterialSystem::make_handle(const unsigned int texture) {
+    const GLuint64 handle = getTextureHandle(texture);
+    makeResident(handle);
+    return handle_texture(handle);
+}
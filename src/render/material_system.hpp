@@ -0,0 +1,75 @@
+#ifndef MATERIAL_SYSTEM_HPP
+#define MATERIAL_SYSTEM_HPP
+
+#include <glad/gl.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "frame_data.hpp"
+#include "texture_manager.hpp"
+
+/*  Gives every textured shape a MaterialTexture, written into its ObjectData next to its color
+    and shininess, so the shader finds the texture per instance and no draw binds one. Shapes
+    with different textures then batch into the same draw.
+    With ARB_bindless_texture each texture keeps its own size and format (a cooked .ptex stays
+    block compressed) and the shader gets its 64-bit handle. Without it every texture is a layer
+    of the TextureManager's array, bound once a frame to MATERIAL_TEXTURE_UNIT.
+    Until a texture is resident its shapes sample a white placeholder, for good if it fails to
+    load. Shaders that sample materials must be built with get_shader_defines(), see
+    shaders/material.fs.
+ */
+class MaterialSystem {
+public:
+    // Texture ids start at 1, 0 is untextured like Renderable::texture
+    static constexpr std::uint32_t NO_TEXTURE = 0;
+
+    MaterialSystem(TextureManager& textures, bool allowBindless = true);
+    ~MaterialSystem();
+
+    MaterialSystem(const MaterialSystem&) = delete;
+    MaterialSystem& operator=(const MaterialSystem&) = delete;
+
+    // Same path, same id
+    std::uint32_t add_texture(const std::string& path, bool flip);
+    // Once a frame on the GL thread, after TextureManager::update(): switches textures that just
+    // became resident from the placeholder to their own data and stops waiting on ones that failed
+    void update();
+    // Binds the layer array, nothing to do with bindless handles
+    void bind() const;
+    // Safe to call from jobs between update() calls
+    MaterialTexture get(std::uint32_t id) const;
+
+    bool is_bindless() const;
+    // Prepended to shader sources after #version
+    std::string get_shader_defines() const;
+
+private:
+    struct Entry {
+        unsigned int texture = 0;  // bindless: GL texture, array: layer
+        bool ready = false;
+        MaterialTexture gpu{};
+    };
+
+    TextureManager& textures;
+    bool bindless;
+    std::vector<Entry> entries;
+    std::unordered_map<std::string, std::uint32_t> idOf;
+    std::vector<std::uint32_t> pending;
+
+    // ARB_bindless_texture entry points, the GL loader is generated without extensions
+    using GetTextureHandle = GLuint64 (GLAD_API_PTR*)(GLuint texture);
+    using MakeTextureHandleResident = void (GLAD_API_PTR*)(GLuint64 handle);
+    using MakeTextureHandleNonResident = void (GLAD_API_PTR*)(GLuint64 handle);
+    GetTextureHandle getTextureHandle = nullptr;
+    MakeTextureHandleResident makeResident = nullptr;
+    MakeTextureHandleNonResident makeNonResident = nullptr;
+    unsigned int placeholder = 0;
+    MaterialTexture placeholderTexture{};
+
+    MaterialTexture make_handle(unsigned int texture);
+};
+
+#endif //MATERIAL_SYSTEM_HPP
@@ -0,0 +1,65 @@
+#include "offscreen_target.hpp"
+
+#include <algorithm>
+
+#include "../util/png_writer.hpp"
+
+OffscreenTarget::OffscreenTarget(const int width, const int height) : width(width), height(height) {
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+    glGenRenderbuffers(1, &color);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+}
+
+OffscreenTarget::~OffscreenTarget() {
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &color);
+    glDeleteRenderbuffers(1, &depth);
+}
+
+void OffscreenTarget::bind() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+}
+
+void OffscreenTarget::read_pixels(std::vector<std::uint8_t>& out) const {
+    const std::size_t rowBytes = static_cast<std::size_t>(width) * 4;
+    out.resize(rowBytes * height);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, out.data());
+    // GL returns the bottom row first
+    for (int y = 0; y < height / 2; ++y) {
+        std::swap_ranges(out.begin() + y * rowBytes, out.begin() + (y + 1) * rowBytes,
+                         out.begin() + (height - 1 - y) * rowBytes);
+    }
+}
+
+bool OffscreenTarget::write_png(const std::string& path) const {
+    std::vector<std::uint8_t> pixels;
+    read_pixels(pixels);
+    return png_writer::write(path, pixels.data(), width, height, 4);
+}
+
+bool OffscreenTarget::is_complete() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+int OffscreenTarget::get_width() const {
+    return width;
+}
+
+int OffscreenTarget::get_height() const {
+    return height;
+}
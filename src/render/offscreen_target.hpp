@@ -0,0 +1,38 @@
+#ifndef OFFSCREEN_TARGET_HPP
+#define OFFSCREEN_TARGET_HPP
+
+#include <glad/gl.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Framebuffer object with an RGBA8 color and a depth/stencil renderbuffer, for rendering without
+// a window to draw into. bind() it and everything the Renderer draws lands here.
+class OffscreenTarget {
+public:
+    OffscreenTarget(int width, int height);
+    ~OffscreenTarget();
+
+    OffscreenTarget(const OffscreenTarget&) = delete;
+    OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+
+    // Binds the framebuffer and sets the viewport to cover it
+    void bind() const;
+    // RGBA rows top to bottom. Waits for the GPU to finish the frame.
+    void read_pixels(std::vector<std::uint8_t>& out) const;
+    bool write_png(const std::string& path) const;
+
+    bool is_complete() const;
+    int get_width() const;
+    int get_height() const;
+
+private:
+    int width;
+    int height;
+    unsigned int framebuffer = 0;
+    unsigned int color = 0;
+    unsigned int depth = 0;
+};
+
+#endif //OFFSCREEN_TARGET_HPP
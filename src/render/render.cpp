@@ -1,10 +1,41 @@
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb/stb_image.h>
-
 #include "render.hpp"
 #include "../PlutoMath/plutomath.hpp"
 
-Renderer::Renderer(GLFWwindow *window): window(window) {
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+
+namespace {
+    // Items per job, small enough that a few thousand shapes still spread over every thread
+    constexpr std::size_t ANIMATION_GRAIN = 512;
+    constexpr std::size_t BOUNDS_GRAIN = 256;
+    constexpr std::size_t OBJECT_DATA_GRAIN = 512;
+    constexpr float NEAR_PLANE = 0.1f, FAR_PLANE = 100.0f;
+
+    // Shapes whose type is a path load a cooked mesh instead of a primitive
+    bool is_mesh_file(const std::string& type) {
+        constexpr std::string_view extension = ".pmesh";
+        return type.size() > extension.size() && type.compare(type.size() - extension.size(), extension.size(), extension) == 0;
+    }
+
+    plutom::vec3f world_position(const plutom::mat4f& model) {
+        return {model.columns[3].x, model.columns[3].y, model.columns[3].z};
+    }
+
+    // Linear blend of two model matrices. Not a true rotation interpolation, but a shape turns
+    // little over one tick, so the shear it introduces stays invisible.
+    plutom::mat4f blend_model(const plutom::mat4f& a, const plutom::mat4f& b, const float t) {
+        plutom::mat4f out;
+        for (int c = 0; c < 4; ++c) out.columns[c] = plutom::lerp(a.columns[c], b.columns[c], t);
+        return out;
+    }
+}
+
+Renderer::Renderer(GLFWwindow *window): window(window),
+    frameUniforms(GL_UNIFORM_BUFFER, sizeof(FrameData)),
+    objectData(GL_SHADER_STORAGE_BUFFER, 256 * sizeof(ObjectData)),
+    drawCommands(GL_DRAW_INDIRECT_BUFFER, 256 * sizeof(DrawCommand)),
+    materials(textures) {
     constexpr float axis_lines[] = {
         // X axis (red)
         0.0f, 0.0f, 0.0f,  1.0f, 0.0f, 0.0f,
@@ -33,160 +64,398 @@ Renderer::Renderer(GLFWwindow *window): window(window) {
     axisShader = std::make_shared<Shader>("shaders/axis.vs", "shaders/axis.fs");
 }
 
-void Renderer::add_shape(const ShapeDescriptor& desc) {
-    Shape shape;
+Entity Renderer::add_shape(const ShapeDescriptor& desc) {
     if (this->lastShader < 0) throw std::range_error("No shaders have been added, create one before adding shapes");
-    shape.shaderID = this->lastShader;
-    shape.sType = desc.sType;
-    shape.id = this->currentID;
-    this->currentID += 1;
-    shape.type = desc.type;
-    shape.position = desc.position;
-    shape.scalingVector = desc.scalingVector;
-    shape.rotationAngle = desc.rotationAngle;
-    shape.rotationSpeed = desc.rotationSpeed;
-    shape.rotationAxis = desc.rotationAxis;
-    shape.color = desc.color;
-    shape.shininess = desc.shininess;
-    shape.visible = desc.visible;
-    shape.wireframe = desc.wireframe;
-    shape.hasTexture = desc.hasTexture;
-
-    if (desc.type == "cube" || desc.type == "square" || desc.type == "circle"){ // || desc.type == "sphere") {
-        create_shape(shape, desc.texturePath.c_str());
-    }else {
+    auto& entities = world.get_entities();
+    auto& transforms = world.get_transforms();
+
+    if (desc.type != "cube" && desc.type != "square" && desc.type != "circle" && !is_mesh_file(desc.type)){ // && desc.type != "sphere") {
         std::cout << "This shape is not currently supported" << std::endl;
+        return Entity{};
     }
+    // A .pmesh that could not be read has already said why
+    const MeshHandle mesh = load_mesh(desc.type);
+    if (!mesh.valid()) return Entity{};
 
-    this->shapes.emplace_back(shape);
-}
+    const Entity entity = entities.create();
+    const bool hasParent = desc.parent.valid() && entities.alive(desc.parent);
+    const bool dynamic = desc.rotationSpeed != 0.0f || desc.sType == ShaderType::Source ||
+                         (hasParent && world.is_dynamic(entities.get<Renderable>(desc.parent).object));
 
+    const auto rotation = plutom::quatf::from_axis_angle(plutom::radians(desc.rotationAngle), desc.rotationAxis);
+    const auto node = transforms.create(desc.position, rotation, desc.scalingVector,
+                                        hasParent ? entities.get<Transform>(desc.parent).node : TransformGraph::NONE);
+    // Real bounds are set once the first world matrix exists
+    const auto object = world.add_object(plutom::aabbf(desc.position, desc.position), dynamic);
+    entityOf.push_back(entity);
+    localBounds.push_back(geometry.get_bounds(mesh));
+    normalMatrices.emplace_back(1.0f);
 
-void Renderer::create_shape(Shape &shape, const char* file) {
-    if (file == "temp") file = "../../res/awesomeface.png";
-    glGenVertexArrays(1,&shape.VAO);
-    glGenBuffers(1, &shape.VBO);
-    glGenBuffers(1, &shape.EBO);
-    glBindVertexArray(shape.VAO);
-    glBindBuffer(GL_ARRAY_BUFFER,shape.VBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, shape.EBO);
-    //TODO This needs to change when support moves to include more than cubes
-    primative currentShape;
-    if (shape.type == "cube") currentShape = primative_generator::get_cube();
-    if (shape.type == "square") currentShape = primative_generator::get_square();
-    if (shape.type == "circle") currentShape = primative_generator::get_circle();
-    glBufferData(GL_ARRAY_BUFFER,static_cast<long>(currentShape.vertices.size() * sizeof(float)), currentShape.vertices.data(), GL_STATIC_DRAW);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<long>(currentShape.indices.size() * sizeof(unsigned int)), currentShape.indices.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), static_cast<void*>(nullptr));
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void*>(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), reinterpret_cast<void*>(2 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    glBindBuffer(GL_ARRAY_BUFFER,0);
-    glBindVertexArray(0);
-    shape.indicesCount = currentShape.indices.size();
-    if (shape.hasTexture) shape.textureID = load_texture(file, true);
-}
-
-unsigned int Renderer::load_texture(const char* filepath, bool flip) {
-    unsigned int tex;
-    glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(flip);
-    unsigned char *data = stbi_load(filepath,&width, &height, &nrChannels, 0);
-    if(data){
-        GLenum format = GL_RGB;
-        if (nrChannels == 1)
-            format = GL_RED;
-        else if (nrChannels == 3)
-            format = GL_RGB;
-        else if (nrChannels == 4)
-            format = GL_RGBA;
-
-        glTexImage2D(GL_TEXTURE_2D, 0, static_cast<int>(format), width, height, 0,
-                     format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }else {
-        std::cout << "Failed to load texture" << std::endl;
-    }
-    stbi_image_free(data);
-
-    return tex;
+    entities.add(entity, Transform{node});
+    entities.add(entity, Renderable{
+        .mesh = mesh,
+        .program = shaders[this->lastShader]->ID,
+        .texture = desc.hasTexture ? materials.add_texture(desc.texturePath, true) : MaterialSystem::NO_TEXTURE,
+        .object = object,
+        .wireframe = desc.wireframe,
+        .visible = desc.visible
+    });
+    entities.add(entity, Material{desc.color, desc.shininess});
+    if (desc.rotationSpeed != 0.0f) entities.add(entity, Spin{desc.rotationAxis, desc.rotationSpeed, desc.rotationAngle});
+    if (desc.sType == ShaderType::Source)
+        entities.add(entity, LightSource{entities.pool<LightSource>().empty()});
+    entities.add(entity, ShapeInfo{desc.type, desc.tag});
+    return entity;
+}
+
+MeshHandle Renderer::load_mesh(const std::string& type) {
+    // Shapes of the same type share one mesh in the geometry arena so they can be drawn instanced
+    MeshHandle mesh = geometry.find(type);
+    if (!mesh.valid() && is_mesh_file(type)) return geometry.load_mesh(type);
+    if (!mesh.valid()) {
+        //TODO This needs to change when support moves to include more than cubes
+        if (type == "cube") mesh = geometry.add_mesh(type, primative_generator::get_cube());
+        if (type == "square") mesh = geometry.add_mesh(type, primative_generator::get_square());
+        if (type == "circle") mesh = geometry.add_mesh(type, primative_generator::get_circle());
+    }
+    return mesh;
 }
 
 void Renderer::visualize(const Camera &cam, const float ratio, const float deltaTime) {
-    plutom::vec3f lightPos, lightColor;
-
-    for (auto& shape : this->shapes) {
-        if (shape.sType == ShaderType::Source) { // your light cube type
-            const auto time = static_cast<float>(glfwGetTime());
-            shape.position = plutom::vec3f(sin(time)*2.0f, sin(time)*1.0f, cos(time)*2.0f);
-            shape.color = plutom::vec3f(cos(time)*0.5f + 0.5f, sin(time)*0.5f + 0.5f, sin(time)*0.5f + 0.5f); // white light
-            lightPos = shape.position;
-            lightColor = shape.color;
-            //cam.Position = lightPos + plutom::vec3f{0.0f, 0.3f, 0.0f};
-            break;
+    PLUTO_PROFILE_FUNCTION();
+    simulate(deltaTime);
+    draw(cam, ratio);
+}
+
+void Renderer::draw(const Camera &cam, const float ratio, const float alpha) {
+    PLUTO_PROFILE_FUNCTION();
+    frame_stats().reset();
+    const float t = std::clamp(alpha, 0.0f, 1.0f);
+    const auto blended = [&](const TransformGraph::node_id node) {
+        const auto& model = world.get_transforms().get_world(node);
+        return t < 1.0f ? blend_model(previousModels[node], model, t) : model;
+    };
+
+    auto& entities = world.get_entities();
+    const auto& transforms = world.get_transforms();
+    const auto view = SnapshotCamera::from(cam);
+    const auto frameAlloc = begin_frame(view, ratio, entityOf.size());
+    auto* frame = static_cast<FrameData*>(frameAlloc.data);
+    const auto& lights = entities.pool<LightSource>();
+    int lightCount = 0;
+    for (std::size_t k = 0; k < lights.size() && lightCount < static_cast<int>(MAX_LIGHTS); ++k) {
+        const Entity light = lights.entities()[k];
+        if (!entities.get<Renderable>(light).visible) continue;
+        const auto& color = entities.get<Material>(light).color;
+        frame->lights[lightCount].position = blended(entities.get<Transform>(light).node).columns[3];
+        frame->lights[lightCount].color = plutom::vec4f(color.x, color.y, color.z, 1.0f);
+        lightCount += 1;
+    }
+    frame->lightCount = lightCount;
+
+    visibleShapes.clear();
+    if (frustumCulling) {
+        PLUTO_PROFILE_SCOPE("cull");
+        world.cull(plutom::frustumf::from_matrix(frame->viewProj), visibleShapes, &jobs);
+    } else {
+        for (std::size_t i = 0; i < entityOf.size(); ++i) visibleShapes.push_back(static_cast<scene::object_id>(i));
+    }
+
+    cullStats = CullStats{};
+    // Indexed by shape, see entityOf
+    const Renderable* renderables = entities.pool<Renderable>().data();
+    const Material* shapeMaterials = entities.pool<Material>().data();
+    for (std::size_t i = 0; i < entityOf.size(); ++i) cullStats.tested += renderables[i].visible ? 1 : 0;
+    queue.clear();
+    queue.reserve(visibleShapes.size());
+    for (const auto i : visibleShapes) {
+        const auto& renderable = renderables[i];
+        if (!renderable.visible) continue;
+        cullStats.visible += 1;
+        const auto& model = transforms.get_world(i);
+        const auto position = t < 1.0f ? plutom::lerp(world_position(previousModels[i]), world_position(model), t)
+                                       : world_position(model);
+        submit(i, renderable, position, view.position);
+    }
+    cullStats.culled = cullStats.tested - cullStats.visible;
+
+    draw_queue(frameAlloc, view.showDebugAxis, [&](const unsigned int i, ObjectData& object) {
+        const auto& material = shapeMaterials[i];
+        object.model = blended(i);
+        object.normalMatrix = t < 1.0f ? blend_model(previousNormals[i], normalMatrices[i], t) : normalMatrices[i];
+        object.color = plutom::vec4f(material.color.x, material.color.y, material.color.z, material.shininess);
+        object.texture = materials.get(renderables[i].texture);
+    });
+}
+
+void Renderer::simulate(const float deltaTime) {
+    PLUTO_PROFILE_FUNCTION();
+    JobSystem& workers = simulation_jobs();
+    auto& entities = world.get_entities();
+    auto& transforms = world.get_transforms();
+    auto& lights = entities.pool<LightSource>();
+    simulatedTime += deltaTime;
+    const auto time = static_cast<float>(simulatedTime);
+    for (std::size_t k = 0; k < lights.size(); ++k) {
+        if (!lights.data()[k].animated) continue; // your light cube type
+        const Entity light = lights.entities()[k];
+        transforms.set_position(entities.get<Transform>(light).node, plutom::vec3f(sin(time)*2.0f, sin(time)*1.0f, cos(time)*2.0f));
+        entities.get<Material>(light).color = plutom::vec3f(cos(time)*0.5f + 0.5f, sin(time)*0.5f + 0.5f, sin(time)*0.5f + 0.5f); // white light
+        //cam.Position = lightPos + plutom::vec3f{0.0f, 0.3f, 0.0f};
+    }
+    // Only spinning shapes touch their transform, update() then recomputes just those subtrees.
+    // Rotations are computed in jobs, marking the nodes dirty is not thread safe and stays here.
+    // Where the last step left every model matrix it changed is where draw() blends them from
+    for (const auto i : transforms.get_updated()) {
+        previousModels[i] = transforms.get_world(i);
+        previousNormals[i] = normalMatrices[i];
+    }
+
+    auto& spins = entities.pool<Spin>();
+    spinRotations.resize(spins.size());
+    workers.parallel_for(0, spins.size(), ANIMATION_GRAIN, [&](const std::size_t first, const std::size_t last) {
+        for (std::size_t k = first; k < last; ++k) {
+            if (!entities.get<Renderable>(spins.entities()[k]).visible) continue;
+            Spin& spin = spins.data()[k];
+            spin.angle = std::fmod(spin.angle + spin.speed * deltaTime, 360.0f);
+            spinRotations[k] = plutom::quatf::from_axis_angle(plutom::radians(spin.angle), spin.axis);
         }
+    });
+    for (std::size_t k = 0; k < spins.size(); ++k) {
+        const Entity owner = spins.entities()[k];
+        if (!entities.get<Renderable>(owner).visible) continue;
+        transforms.set_rotation(entities.get<Transform>(owner).node, spinRotations[k]);
     }
-    for (auto & shape : this->shapes) {
-        if (!shape.visible) continue;
-        auto& shader = *shaders[shape.shaderID];
-        shader.use();
-        if (shape.wireframe)
-            glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        else
-            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        if (shape.hasTexture) {
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, shape.textureID);
+    {
+        PLUTO_PROFILE_SCOPE("transforms");
+        transforms.update(&workers);
+    }
+
+    // World bounds and normal matrices follow the model matrices that changed, the BVH then
+    // skips whole subtrees that are outside or fully inside the frustum
+    const auto& updated = transforms.get_updated();
+    updatedBounds.resize(updated.size());
+    workers.parallel_for(0, updated.size(), BOUNDS_GRAIN, [&](const std::size_t first, const std::size_t last) {
+        for (std::size_t k = first; k < last; ++k) {
+            const auto i = updated[k];
+            const auto& model = transforms.get_world(i);
+            updatedBounds[k] = plutom::transform_aabb(model, localBounds[i]);
+            const auto normal = model.normal_matrix();
+            for (int c = 0; c < 3; ++c)
+                normalMatrices[i].columns[c] = {normal.columns[c].x, normal.columns[c].y, normal.columns[c].z, 0.0f};
         }
-        const auto value = plutom::perspective(plutom::radians(cam.Zoom), ratio, 0.1f, 100.0f);
-        const auto view = cam.get_view_matrix();
-        auto model = plutom::transform3D::translate(plutom::mat4f(1.0f), shape.position);
-        shape.rotationAngle += shape.rotationSpeed * deltaTime;
-        model = plutom::transform3D::rotate(model ,plutom::radians(shape.rotationAngle), shape.rotationAxis);
-        model = plutom::transform3D::scale(model,shape.scalingVector);
-        glBindVertexArray(shape.VAO);
-        shader.setMat4f("projection", value);
-        shader.setMat4f("view", view);
-        shader.setMat4f("model", model);
-        switch (shape.sType) {
-            case ShaderType::Lighting:
-                shader.setVec3f("viewPos", cam.Position);
-                shader.setVec3f("lightColor", lightColor);
-                shader.setVec3f("lightPos", lightPos);
-                shader.setVec3f("objectColor", shape.color);
-                shader.setFloat("shine",shape.shininess);
-                break;
-            case ShaderType::Basic:
-                shader.setVec3f("color", shape.color);
-                break;
-            case ShaderType::Source:
-                shader.setVec3f("color", shape.color);
-                break;
+    });
+    for (std::size_t k = 0; k < updated.size(); ++k) world.set_bounds(updated[k], updatedBounds[k]);
+    // Shapes added since the last step have nothing to blend from
+    for (std::size_t i = previousModels.size(); i < entityOf.size(); ++i) {
+        previousModels.push_back(transforms.get_world(static_cast<TransformGraph::node_id>(i)));
+        previousNormals.push_back(normalMatrices[i]);
+    }
+    PLUTO_PROFILE_SCOPE("scene update");
+    world.update(&workers);
+}
+
+void Renderer::capture(FrameSnapshot& snapshot, const SnapshotCamera& cam) {
+    PLUTO_PROFILE_FUNCTION();
+    JobSystem& workers = simulation_jobs();
+    auto& entities = world.get_entities();
+    const auto& transforms = world.get_transforms();
+    snapshot.view = cam;
+
+    snapshot.lights.clear();
+    const auto& lights = entities.pool<LightSource>();
+    for (std::size_t k = 0; k < lights.size() && snapshot.lights.size() < MAX_LIGHTS; ++k) {
+        const Entity light = lights.entities()[k];
+        if (!entities.get<Renderable>(light).visible) continue;
+        snapshot.lights.push_back({world_position(transforms.get_world(entities.get<Transform>(light).node)),
+                                   entities.get<Material>(light).color});
+    }
+
+    snapshot.objects.resize(entityOf.size());
+    snapshot.bounds.resize(entityOf.size());
+    const Renderable* renderables = entities.pool<Renderable>().data();
+    const Material* shapeMaterials = entities.pool<Material>().data();
+    workers.parallel_for(0, entityOf.size(), OBJECT_DATA_GRAIN, [&](const std::size_t first, const std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            const auto& renderable = renderables[i];
+            const auto& material = shapeMaterials[i];
+            SnapshotObject& object = snapshot.objects[i];
+            object.model = transforms.get_world(static_cast<TransformGraph::node_id>(i));
+            object.color = plutom::vec4f(material.color.x, material.color.y, material.color.z, material.shininess);
+            object.mesh = renderable.mesh;
+            object.program = renderable.program;
+            object.texture = renderable.texture;
+            object.wireframe = renderable.wireframe;
+            object.visible = renderable.visible;
+            snapshot.bounds.set(i, world.get_bounds(static_cast<scene::object_id>(i)));
         }
-        //glDrawArrays(GL_TRIANGLES,0,shape.indicesCount);
-        glDrawElements(GL_TRIANGLES,static_cast<int>(shape.indicesCount),GL_UNSIGNED_INT,nullptr);
-        //std::cout << "Shape ID: " << shape.id << ", Shader ID: " << shape.shaderID << std::endl;
+    });
+}
+
+void Renderer::render(const FrameSnapshot& previous, const FrameSnapshot& current, const float alpha, const float ratio) {
+    PLUTO_PROFILE_FUNCTION();
+    frame_stats().reset();
+
+    // Shapes added between the two snapshots have nothing to blend from, those frames show current as is
+    const std::size_t count = current.objects.size();
+    const bool blend = previous.objects.size() == count;
+    const float t = blend ? std::clamp(alpha, 0.0f, 1.0f) : 1.0f;
+
+    SnapshotCamera view = current.view;
+    view.position = plutom::lerp(previous.view.position, current.view.position, t);
+    view.front = plutom::lerp(previous.view.front, current.view.front, t).normalize();
+    view.up = plutom::lerp(previous.view.up, current.view.up, t).normalize();
+    view.zoom = previous.view.zoom + (current.view.zoom - previous.view.zoom) * t;
+    const auto frameAlloc = begin_frame(view, ratio, count);
+    auto* frame = static_cast<FrameData*>(frameAlloc.data);
+    const bool blendLights = previous.lights.size() == current.lights.size();
+    int lightCount = 0;
+    for (std::size_t k = 0; k < current.lights.size() && lightCount < static_cast<int>(MAX_LIGHTS); ++k) {
+        const auto& light = current.lights[k];
+        const auto position = blendLights ? plutom::lerp(previous.lights[k].position, light.position, t) : light.position;
+        const auto color = blendLights ? plutom::lerp(previous.lights[k].color, light.color, t) : light.color;
+        frame->lights[lightCount].position = plutom::vec4f(position.x, position.y, position.z, 1.0f);
+        frame->lights[lightCount].color = plutom::vec4f(color.x, color.y, color.z, 1.0f);
+        lightCount += 1;
     }
+    frame->lightCount = lightCount;
 
-    if (cam.show_debug_axis) {
-        axisShader->use();
-        axisShader->setMat4f("model", plutom::mat4f::identity());
-        axisShader->setMat4f("view", cam.get_view_matrix());
-        axisShader->setMat4f("projection", plutom::perspective(
-            plutom::radians(cam.Zoom), ratio, 0.1f, 100.0f));
+    // No BVH on this side, the tree belongs to the simulation thread. The flat SoA test over both
+    // snapshots' bounds keeps every shape whose blended position can be on screen.
+    cullFlags.resize(count);
+    if (frustumCulling) {
+        PLUTO_PROFILE_SCOPE("cull");
+        const auto frustum = plutom::frustumf::from_matrix(frame->viewProj);
+        plutom::cull_aabbs(frustum, current.bounds, cullFlags.data());
+        if (blend) {
+            previousCullFlags.resize(count);
+            plutom::cull_aabbs(frustum, previous.bounds, previousCullFlags.data());
+            for (std::size_t i = 0; i < count; ++i) cullFlags[i] |= previousCullFlags[i];
+        }
+    } else {
+        std::fill(cullFlags.begin(), cullFlags.end(), std::uint8_t{1});
+    }
+
+    cullStats = CullStats{};
+    blendedModels.resize(count);
+    queue.clear();
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto& object = current.objects[i];
+        if (!object.visible) continue;
+        cullStats.tested += 1;
+        if (!cullFlags[i]) continue;
+        cullStats.visible += 1;
+        blendedModels[i] = blend ? blend_model(previous.objects[i].model, object.model, t) : object.model;
+        submit(static_cast<unsigned int>(i), object, world_position(blendedModels[i]), view.position);
+    }
+    cullStats.culled = cullStats.tested - cullStats.visible;
+
+    draw_queue(frameAlloc, view.showDebugAxis, [&](const unsigned int i, ObjectData& object) {
+        const auto normal = blendedModels[i].normal_matrix();
+        object.model = blendedModels[i];
+        for (int c = 0; c < 3; ++c)
+            object.normalMatrix.columns[c] = {normal.columns[c].x, normal.columns[c].y, normal.columns[c].z, 0.0f};
+        object.normalMatrix.columns[3] = {0.0f, 0.0f, 0.0f, 1.0f};
+        object.color = current.objects[i].color;
+        object.texture = materials.get(current.objects[i].texture);
+    });
+}
+
+GpuRingBuffer::Allocation Renderer::begin_frame(const SnapshotCamera& cam, const float ratio, const std::size_t shapeCount) {
+    PLUTO_PROFILE_GPU_BEGIN_FRAME(gpuProfiler);
+    textures.update();
+    materials.update();
+    frameUniforms.begin_frame();
+    objectData.reserve(shapeCount * sizeof(ObjectData));
+    objectData.begin_frame();
+
+    const auto frameAlloc = frameUniforms.allocate(sizeof(FrameData));
+    auto* frame = static_cast<FrameData*>(frameAlloc.data);
+    frame->projection = plutom::perspective(plutom::radians(cam.zoom), ratio, NEAR_PLANE, FAR_PLANE);
+    frame->view = cam.get_view_matrix();
+    frame->viewProj = frame->projection * frame->view;
+    frame->viewPos = plutom::vec4f(cam.position.x, cam.position.y, cam.position.z, 1.0f);
+    frame->lightCount = 0;
+    return frameAlloc;
+}
+
+template<typename Shape>
+void Renderer::submit(const unsigned int index, const Shape& shape, const plutom::vec3f& position,
+                      const plutom::vec3f& eye) {
+    queue.submit({
+        .program = shape.program,
+        .vao = geometry.get_vao(),
+        .texture = 0,   // sampled through ObjectData, see MaterialSystem
+        .mesh = shape.mesh.id,
+        .indexCount = shape.mesh.indexCount,
+        .firstIndex = shape.mesh.firstIndex,
+        .baseVertex = shape.mesh.baseVertex,
+        .userIndex = index,
+        .wireframe = shape.wireframe,
+        .depth = (position - eye).length() / FAR_PLANE
+    });
+}
+
+template<typename Fill>
+void Renderer::draw_queue(const GpuRingBuffer::Allocation& frameAlloc, const bool showDebugAxis, Fill&& fill) {
+    PLUTO_PROFILE_FUNCTION();
+    {
+        PLUTO_PROFILE_SCOPE("sort");
+        queue.sort();
+    }
 
+    // Per-object data is written in sorted order, so every batch the queue merges reads a
+    // contiguous range starting at its first item's position
+    const auto objectCount = static_cast<unsigned int>(queue.size());
+    const auto objectAlloc = objectData.allocate(objectCount * sizeof(ObjectData));
+    auto* objects = static_cast<ObjectData*>(objectAlloc.data);
+    {
+        PLUTO_PROFILE_SCOPE("object data");
+        jobs.parallel_for(0, objectCount, OBJECT_DATA_GRAIN, [&](const std::size_t first, const std::size_t last) {
+            for (std::size_t k = first; k < last; ++k) fill(queue[k].userIndex, objects[k]);
+        });
+    }
+
+    // One command per batch, the whole frame goes out in one multi-draw per state change
+    GpuRingBuffer::Allocation commandAlloc{};
+    if (useIndirect) {
+        drawCommands.reserve(objectCount * sizeof(DrawCommand));
+        drawCommands.begin_frame();
+        commandAlloc = drawCommands.allocate(objectCount * sizeof(DrawCommand));
+        queue.build_commands(static_cast<DrawCommand*>(commandAlloc.data));
+        drawCommands.flush();
+    }
+
+    frameUniforms.flush();
+    objectData.flush();
+    frameUniforms.bind_range(FRAME_DATA_BINDING, frameAlloc.offset, sizeof(FrameData));
+    if (objectCount > 0)
+        objectData.bind_range(OBJECT_DATA_BINDING, objectAlloc.offset, objectCount * sizeof(ObjectData));
+
+    {
+        PLUTO_PROFILE_SCOPE("draw");
+        PLUTO_PROFILE_GPU_SCOPE(gpuProfiler, "draw");
+        materials.bind();
+        if (useIndirect) {
+            drawCommands.bind();
+            queue.execute_indirect(device, drawCommands.buffer_offset(commandAlloc.offset));
+            drawCommands.end_frame();
+        } else {
+            queue.execute(device);
+        }
+    }
+
+    if (showDebugAxis) {
+        axisShader->use();
         glBindVertexArray(axisVAO);
         glDrawArrays(GL_LINES, 0, 6);
+        frame_stats().vertexArrayBinds += 1;
+        frame_stats().drawCalls += 1;
     }
+
+    frameUniforms.end_frame();
+    objectData.end_frame();
+    PLUTO_PROFILE_GPU_END_FRAME(gpuProfiler);
 }
 
 void Renderer::add_shader(const std::shared_ptr<Shader>& shader) {
@@ -194,3 +463,50 @@ void Renderer::add_shader(const std::shared_ptr<Shader>& shader) {
     this->lastShader += 1;
 }
 
+const FrameStats& Renderer::get_frame_stats() const {
+    return frame_stats();
+}
+
+const RenderQueueStats& Renderer::get_queue_stats() const {
+    return queue.get_stats();
+}
+
+void Renderer::set_indirect(const bool enabled) {
+    useIndirect = enabled;
+}
+
+bool Renderer::is_indirect() const {
+    return useIndirect;
+}
+
+void Renderer::set_simulation_jobs(JobSystem* simulation) {
+    simulationJobs = simulation;
+}
+
+JobSystem& Renderer::simulation_jobs() {
+    return simulationJobs ? *simulationJobs : jobs;
+}
+
+void Renderer::set_mesh_optimization(const bool enabled) {
+    geometry.set_optimize(enabled);
+}
+
+const GeometryRegistry& Renderer::get_geometry() const {
+    return geometry;
+}
+
+const CullStats& Renderer::get_cull_stats() const {
+    return cullStats;
+}
+
+TextureManager& Renderer::get_textures() {
+    return textures;
+}
+
+MaterialSystem& Renderer::get_materials() {
+    return materials;
+}
+
+void Renderer::set_frustum_culling(const bool enabled) {
+    frustumCulling = enabled;
+}
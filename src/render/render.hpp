@@ -8,41 +8,26 @@
 #include <vector>
 #include "../PlutoMath/plutomath.hpp"
 #include "shader.hpp"
+#include "frame_stats.hpp"
+#include "frame_data.hpp"
+#include "frame_snapshot.hpp"
+#include "gpu_buffer.hpp"
+#include "render_device.hpp"
+#include "render_queue.hpp"
+#include "geometry_registry.hpp"
+#include "gpu_profiler.hpp"
+#include "texture_manager.hpp"
+#include "material_system.hpp"
 #include "../input/camera.hpp"
+#include "../scene/scene.hpp"
+#include "../util/job_system.hpp"
 #include "../util/primativegenerator.hpp"
 #include "GLFW/glfw3.h"
 
 enum class ShaderType { Basic, Lighting, Source };
 
-struct Shape {
-    ShaderType sType;
-    std::string type;
-    std::string tag;
-    unsigned int shaderID;
-    unsigned int id;
-    unsigned int indicesCount;
-
-    unsigned int VAO;
-    unsigned int VBO;
-    unsigned int EBO;
-    unsigned int textureID;
-
-    plutom::vec3f color;
-    plutom::vec3f position;
-    plutom::vec3f rotationAxis;
-    plutom::vec3f scalingVector;
-
-    bool wireframe;
-    bool visible;
-    bool hasTexture;
-
-    float shininess;
-    float rotationSpeed;
-    float rotationAngle;
-};
-
 struct ShapeDescriptor {
-    std::string type = "cube";
+    std::string type = "cube";     // a primitive, or the path of a mesh cooked to .pmesh
     ShaderType sType = ShaderType::Basic;
     plutom::vec3f color = {1.0f, 1.0f, 1.0f};
     plutom::vec3f position = {0.0f, 0.0f, 0.0f};
@@ -56,6 +41,16 @@ struct ShapeDescriptor {
     bool hasTexture = false;
     std::string tag = "none";
     std::string texturePath = "res/awesomeface.png";
+    // Entity returned by add_shape; position, rotation and scale are then relative to it
+    Entity parent{};
+};
+
+// Frustum culling results for the last draw() or render() call. Hidden shapes are not counted,
+// tested is every candidate even though the scene BVH skips whole subtrees of them.
+struct CullStats {
+    unsigned int tested = 0;
+    unsigned int visible = 0;
+    unsigned int culled = 0;
 };
 
 class Renderer {
@@ -63,21 +58,114 @@ public:
     explicit Renderer(GLFWwindow* window);
 
     void add_shader(const std::shared_ptr<Shader>& shader);
-    void add_shape(const ShapeDescriptor& desc);
+    // Creates an entity with the components the descriptor asks for. Nothing is created, and the
+    // Entity is invalid, when the type is not supported or its mesh cannot be loaded.
+    Entity add_shape(const ShapeDescriptor& desc);
+    // simulate() and draws the result straight from the scene
     void visualize(const Camera &cam, float ratio, float deltaTime);
+    // Draws the scene as the last simulate() left it, with the BVH cull and the normal matrices it
+    // cached. Both are blended toward it by alpha from where the step before left them, so a
+    // single threaded loop at a fixed step draws the same as render() does from two snapshots.
+    void draw(const Camera &cam, float ratio, float alpha = 1.0f);
+
+    // Split form of visualize() for running the simulation on its own thread. simulate() and
+    // capture() touch only the scene, render() only its snapshots and GL, so the first two may run
+    // on another thread while render() runs on the GL thread. Shapes must not be added meanwhile.
+    void simulate(float deltaTime);
+    void capture(FrameSnapshot& snapshot, const SnapshotCamera& cam);
+    // Draws previous blended toward current by alpha, 0 being previous and 1 current
+    void render(const FrameSnapshot& previous, const FrameSnapshot& current, float alpha, float ratio);
+
+    const FrameStats& get_frame_stats() const;
+    const RenderQueueStats& get_queue_stats() const;
+    const GeometryRegistry& get_geometry() const;
+    const CullStats& get_cull_stats() const;
+    // Textured shapes draw with a placeholder until theirs is decoded and uploaded
+    TextureManager& get_textures();
+    // Textures sampled per instance, textured shapes need a shader built with its defines
+    MaterialSystem& get_materials();
+    void set_frustum_culling(bool enabled);
+    // Multi-draw indirect submission, always available on the 4.6 context the window asks for.
+    // Turning it off draws one instanced call per batch instead, for debugging.
+    void set_indirect(bool enabled);
+    bool is_indirect() const;
+    // Vertex cache and overdraw ordering for primitives added from then on, see GeometryRegistry
+    void set_mesh_optimization(bool enabled);
+    // Job system simulate() and capture() spread their work over instead of the renderer's own,
+    // nullptr to go back to it. A thread calling them while another draws needs its own, see
+    // SimulationThread.
+    void set_simulation_jobs(JobSystem* simulation);
 
 private:
     GLFWwindow* window;
     std::vector<std::shared_ptr<Shader>> shaders;
-    std::vector<Shape> shapes;
-    unsigned int currentID = 0;
     unsigned int lastShader = -1;
 
+    // Animation, transform propagation, bounds, culling and per-object data are spread over the
+    // job threads; anything that calls GL, queue submission included, stays on this thread.
+    // simulate() and capture() use simulationJobs instead when one is set.
+    JobSystem jobs;
+    JobSystem* simulationJobs = nullptr;
+
+    // Shapes are entities in the scene. Each gets one transform node and one BVH object, created
+    // together so the two share an index; the per-shape arrays below and entityOf use it too.
+    // Shapes are never removed and each adds one Renderable and one Material, so those pools'
+    // data() arrays are in the same order and systems index them by shape directly.
+    // Model matrices and world bounds are only recomputed for shapes whose transform (or a
+    // parent's) changed; dynamic shapes spin, move or hang off one that does.
+    scene world;
+    std::vector<Entity> entityOf;
+    std::vector<plutom::aabbf> localBounds;
+    std::vector<plutom::mat4f> normalMatrices;
+    std::vector<scene::object_id> visibleShapes;
+    // Model and normal matrices as of the step before the last, for draw()
+    std::vector<plutom::mat4f> previousModels;
+    std::vector<plutom::mat4f> previousNormals;
+    // Sum of the steps simulate() took, what animated lights follow instead of the clock
+    double simulatedTime = 0.0;
+    // Per-frame scratch the jobs write into before the results go to the scene serially
+    std::vector<plutom::quatf> spinRotations;
+    std::vector<plutom::aabbf> updatedBounds;
+    // render() scratch, per shape
+    std::vector<std::uint8_t> cullFlags;
+    std::vector<std::uint8_t> previousCullFlags;
+    std::vector<plutom::mat4f> blendedModels;
+    CullStats cullStats;
+    bool frustumCulling = true;
+
+    // Camera and lights go to the FrameData uniform block once per frame, per-object data to the
+    // ObjectBuffer storage block. Both are ring buffered so the CPU never waits on the previous frame.
+    GpuRingBuffer frameUniforms;
+    GpuRingBuffer objectData;
+    GpuRingBuffer drawCommands;
+    bool useIndirect = true;
+
+    // Decoded on its own threads, uploaded a slice per frame in begin_frame()
+    TextureManager textures;
+    // Shapes find their texture through ObjectData, so different textures still share a draw
+    MaterialSystem materials;
+
+    // Every primitive is uploaded once into the shared arena, shapes keep a MeshHandle into it
+    GeometryRegistry geometry;
+
+    GLRenderDevice device;
+    RenderQueue queue;
+    // Only issues queries when built with PLUTO_PROFILE
+    GpuProfiler gpuProfiler;
+
     unsigned int axisVAO{}, axisVBO{};
     std::shared_ptr<Shader> axisShader;
 
-    static unsigned int load_texture(const char* filepath, bool flip);
-    static void create_shape(Shape &shape,const char *file = "temp");
+    MeshHandle load_mesh(const std::string& type);
+    JobSystem& simulation_jobs();
+
+    // Shared by draw() and render(): frame uniforms, queue submission, and sorting the queue,
+    // filling per-object data through fill(shape, ObjectData&) and issuing the draws
+    GpuRingBuffer::Allocation begin_frame(const SnapshotCamera& cam, float ratio, std::size_t shapeCount);
+    template<typename Shape>
+    void submit(unsigned int index, const Shape& shape, const plutom::vec3f& position, const plutom::vec3f& eye);
+    template<typename Fill>
+    void draw_queue(const GpuRingBuffer::Allocation& frameAlloc, bool showDebugAxis, Fill&& fill);
 };
 
 
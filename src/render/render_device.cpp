@@ -0,0 +1,40 @@
+#include "render_device.hpp"
+#include "frame_stats.hpp"
+
+#include <glad/gl.h>
+
+void GLRenderDevice::use_program(const unsigned int program) {
+    glUseProgram(program);
+    frame_stats().programBinds += 1;
+}
+
+void GLRenderDevice::set_wireframe(const bool wireframe) {
+    glPolygonMode(GL_FRONT_AND_BACK, wireframe ? GL_LINE : GL_FILL);
+    frame_stats().stateChanges += 1;
+}
+
+void GLRenderDevice::bind_texture(const unsigned int unit, const unsigned int texture) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    frame_stats().stateChanges += 1;
+    frame_stats().textureBinds += 1;
+}
+
+void GLRenderDevice::bind_vertex_array(const unsigned int vao) {
+    glBindVertexArray(vao);
+    frame_stats().vertexArrayBinds += 1;
+}
+
+void GLRenderDevice::draw_indexed(const unsigned int indexCount, const unsigned int firstIndex, const int baseVertex,
+                                  const unsigned int instanceCount, const unsigned int baseInstance) {
+    glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, static_cast<int>(indexCount), GL_UNSIGNED_INT,
+                                                  reinterpret_cast<void*>(firstIndex * sizeof(unsigned int)),
+                                                  static_cast<int>(instanceCount), baseVertex, baseInstance);
+    frame_stats().drawCalls += 1;
+}
+
+void GLRenderDevice::multi_draw_indirect(const std::size_t commandOffset, const unsigned int drawCount) {
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<void*>(commandOffset),
+                                static_cast<int>(drawCount), 0);
+    frame_stats().drawCalls += 1;
+}
@@ -0,0 +1,35 @@
+#ifndef RENDER_DEVICE_HPP
+#define RENDER_DEVICE_HPP
+
+#include <cstddef>
+
+// The GL calls the render queue issues, behind an interface so the queue can run against a
+// recording implementation without a context. Calls are forwarded as-is, redundant state
+// filtering is the queue's job.
+class RenderDevice {
+public:
+    virtual ~RenderDevice() = default;
+
+    virtual void use_program(unsigned int program) = 0;
+    virtual void set_wireframe(bool wireframe) = 0;
+    virtual void bind_texture(unsigned int unit, unsigned int texture) = 0;
+    virtual void bind_vertex_array(unsigned int vao) = 0;
+    // Indexed triangles from the bound VAO, baseInstance selects the per-object data slot
+    virtual void draw_indexed(unsigned int indexCount, unsigned int firstIndex, int baseVertex,
+                              unsigned int instanceCount, unsigned int baseInstance) = 0;
+    // drawCount DrawCommands read from the bound GL_DRAW_INDIRECT_BUFFER at commandOffset bytes
+    virtual void multi_draw_indirect(std::size_t commandOffset, unsigned int drawCount) = 0;
+};
+
+class GLRenderDevice final : public RenderDevice {
+public:
+    void use_program(unsigned int program) override;
+    void set_wireframe(bool wireframe) override;
+    void bind_texture(unsigned int unit, unsigned int texture) override;
+    void bind_vertex_array(unsigned int vao) override;
+    void draw_indexed(unsigned int indexCount, unsigned int firstIndex, int baseVertex,
+                      unsigned int instanceCount, unsigned int baseInstance) override;
+    void multi_draw_indirect(std::size_t commandOffset, unsigned int drawCount) override;
+};
+
+#endif //RENDER_DEVICE_HPP
@@ -0,0 +1,199 @@
+#include "render_queue.hpp"
+
+#include <algorithm>
+
+namespace {
+    constexpr unsigned int PROGRAM_BITS = 12;
+    constexpr unsigned int TEXTURE_BITS = 14;
+    constexpr unsigned int MESH_BITS = 14;
+    constexpr unsigned int DEPTH_BITS = 23;
+
+    constexpr unsigned int DEPTH_SHIFT = 0;
+    constexpr unsigned int MESH_SHIFT = DEPTH_SHIFT + DEPTH_BITS;
+    constexpr unsigned int TEXTURE_SHIFT = MESH_SHIFT + MESH_BITS;
+    constexpr unsigned int WIREFRAME_SHIFT = TEXTURE_SHIFT + TEXTURE_BITS;
+    constexpr unsigned int PROGRAM_SHIFT = WIREFRAME_SHIFT + 1;
+    static_assert(PROGRAM_SHIFT + PROGRAM_BITS == 64, "sort key fields must fill 64 bits");
+
+    constexpr std::uint64_t field(const std::uint64_t value, const unsigned int bits, const unsigned int shift) {
+        return (value & ((std::uint64_t(1) << bits) - 1)) << shift;
+    }
+}
+
+void RenderQueue::clear() {
+    items.clear();
+    keys.clear();
+    order.clear();
+}
+
+void RenderQueue::reserve(const std::size_t count) {
+    items.reserve(count);
+    keys.reserve(count);
+    order.reserve(count);
+}
+
+std::uint64_t RenderQueue::make_key(const DrawItem& item) {
+    const float depth = std::clamp(item.depth, 0.0f, 1.0f);
+    const auto quantized = static_cast<std::uint64_t>(depth * static_cast<float>((1u << DEPTH_BITS) - 1));
+    return field(item.program, PROGRAM_BITS, PROGRAM_SHIFT) |
+           field(item.wireframe ? 1 : 0, 1, WIREFRAME_SHIFT) |
+           field(item.texture, TEXTURE_BITS, TEXTURE_SHIFT) |
+           field(item.mesh, MESH_BITS, MESH_SHIFT) |
+           field(quantized, DEPTH_BITS, DEPTH_SHIFT);
+}
+
+void RenderQueue::submit(const DrawItem& item) {
+    order.push_back(static_cast<std::uint32_t>(items.size()));
+    keys.push_back(make_key(item));
+    items.push_back(item);
+}
+
+void RenderQueue::sort() {
+    const std::size_t count = keys.size();
+    if (count < 2) return;
+    scratchKeys.resize(count);
+    scratchOrder.resize(count);
+
+    // One histogram pass for all eight digits
+    std::uint32_t histograms[8][256] = {};
+    for (const std::uint64_t key : keys) {
+        for (unsigned int d = 0; d < 8; ++d)
+            histograms[d][(key >> (d * 8)) & 0xFF] += 1;
+    }
+
+    for (unsigned int d = 0; d < 8; ++d) {
+        auto& histogram = histograms[d];
+        // Every key shares this byte, the pass would not move anything
+        if (histogram[(keys[0] >> (d * 8)) & 0xFF] == count) continue;
+
+        std::uint32_t offset = 0;
+        for (auto& bucket : histogram) {
+            const std::uint32_t n = bucket;
+            bucket = offset;
+            offset += n;
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::uint32_t dst = histogram[(keys[i] >> (d * 8)) & 0xFF]++;
+            scratchKeys[dst] = keys[i];
+            scratchOrder[dst] = order[i];
+        }
+        keys.swap(scratchKeys);
+        order.swap(scratchOrder);
+    }
+}
+
+void RenderQueue::apply_state(RenderDevice& device, const DrawItem& item, BoundState& bound) {
+    if (item.program != bound.program) {
+        device.use_program(item.program);
+        bound.program = item.program;
+        stats.programChanges += 1;
+    } else {
+        stats.redundantSkipped += 1;
+    }
+    const unsigned int mode = item.wireframe ? 1 : 0;
+    if (mode != bound.wireframe) {
+        device.set_wireframe(item.wireframe);
+        bound.wireframe = mode;
+        stats.wireframeChanges += 1;
+    } else {
+        stats.redundantSkipped += 1;
+    }
+    if (item.texture != 0) {
+        if (item.texture != bound.texture) {
+            device.bind_texture(0, item.texture);
+            bound.texture = item.texture;
+            stats.textureChanges += 1;
+        } else {
+            stats.redundantSkipped += 1;
+        }
+    }
+    if (item.vao != bound.vao) {
+        device.bind_vertex_array(item.vao);
+        bound.vao = item.vao;
+        stats.vertexArrayChanges += 1;
+    } else {
+        stats.redundantSkipped += 1;
+    }
+}
+
+void RenderQueue::execute(RenderDevice& device) {
+    stats = RenderQueueStats{};
+    stats.items = static_cast<unsigned int>(items.size());
+
+    BoundState bound;
+    const std::size_t count = order.size();
+    std::size_t first = 0;
+    while (first < count) {
+        const DrawItem& item = items[order[first]];
+        std::size_t last = first + 1;
+        while (last < count && same_batch(item, items[order[last]])) ++last;
+
+        apply_state(device, item, bound);
+        const auto instances = static_cast<unsigned int>(last - first);
+        device.draw_indexed(item.indexCount, item.firstIndex, item.baseVertex, instances, static_cast<unsigned int>(first));
+        stats.drawCalls += 1;
+        stats.drawCommands += 1;
+        stats.instances += instances;
+        first = last;
+    }
+}
+
+std::size_t RenderQueue::build_commands(DrawCommand* out) {
+    batchStarts.clear();
+    const std::size_t count = order.size();
+    std::size_t first = 0;
+    while (first < count) {
+        const DrawItem& item = items[order[first]];
+        std::size_t last = first + 1;
+        while (last < count && same_batch(item, items[order[last]])) ++last;
+
+        out[batchStarts.size()] = {item.indexCount, static_cast<unsigned int>(last - first), item.firstIndex,
+                                   item.baseVertex, static_cast<unsigned int>(first)};
+        batchStarts.push_back(static_cast<std::uint32_t>(first));
+        first = last;
+    }
+    return batchStarts.size();
+}
+
+void RenderQueue::execute_indirect(RenderDevice& device, const std::size_t commandOffset) {
+    stats = RenderQueueStats{};
+    stats.items = static_cast<unsigned int>(items.size());
+    stats.instances = stats.items;
+
+    BoundState bound;
+    const std::size_t batches = batchStarts.size();
+    std::size_t first = 0;
+    while (first < batches) {
+        const DrawItem& item = items[order[batchStarts[first]]];
+        std::size_t last = first + 1;
+        while (last < batches && same_state(item, items[order[batchStarts[last]]])) ++last;
+
+        apply_state(device, item, bound);
+        const auto commands = static_cast<unsigned int>(last - first);
+        device.multi_draw_indirect(commandOffset + first * sizeof(DrawCommand), commands);
+        stats.drawCalls += 1;
+        stats.drawCommands += commands;
+        first = last;
+    }
+}
+
+bool RenderQueue::same_batch(const DrawItem& a, const DrawItem& b) {
+    return same_state(a, b) && a.indexCount == b.indexCount &&
+           a.firstIndex == b.firstIndex && a.baseVertex == b.baseVertex;
+}
+
+bool RenderQueue::same_state(const DrawItem& a, const DrawItem& b) {
+    return a.program == b.program && a.vao == b.vao && a.texture == b.texture && a.wireframe == b.wireframe;
+}
+
+std::size_t RenderQueue::size() const {
+    return items.size();
+}
+
+const DrawItem& RenderQueue::operator[](const std::size_t i) const {
+    return items[order[i]];
+}
+
+const RenderQueueStats& RenderQueue::get_stats() const {
+    return stats;
+}
@@ -0,0 +1,100 @@
+#ifndef RENDER_QUEUE_HPP
+#define RENDER_QUEUE_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "render_device.hpp"
+
+struct DrawItem {
+    unsigned int program;
+    unsigned int vao;
+    unsigned int texture;      // 0 leaves the texture binding untouched
+    unsigned int mesh;         // sorts draws of the same mesh together when meshes share a VAO
+    unsigned int indexCount;
+    unsigned int firstIndex;
+    int baseVertex;
+    unsigned int userIndex;    // caller's index, returned with the item after sorting
+    bool wireframe;
+    float depth;               // view distance normalized to [0, 1], nearer draws first within a state bucket
+};
+
+// Matches the layout glMultiDrawElementsIndirect reads
+struct DrawCommand {
+    unsigned int count;
+    unsigned int instanceCount;
+    unsigned int firstIndex;
+    int baseVertex;
+    unsigned int baseInstance;
+};
+
+struct RenderQueueStats {
+    unsigned int items = 0;
+    unsigned int programChanges = 0;
+    unsigned int wireframeChanges = 0;
+    unsigned int textureChanges = 0;
+    unsigned int vertexArrayChanges = 0;
+    unsigned int redundantSkipped = 0;  // binds filtered out because the state was already set
+    unsigned int drawCalls = 0;         // GL draw calls, a multi-draw counts once
+    unsigned int drawCommands = 0;      // instanced draws, issued directly or as indirect commands
+    unsigned int instances = 0;
+
+    unsigned int state_changes() const {
+        return programChanges + wireframeChanges + textureChanges + vertexArrayChanges;
+    }
+};
+
+// Collects the frame's draws, orders them by a 64-bit key so the most expensive state changes
+// happen least often, and replays them through a RenderDevice while skipping binds of state
+// that is already current. Runs of sorted items sharing all state and index range become one
+// instanced draw whose baseInstance is the run's first sorted position, so per-object data must
+// be laid out in sorted order.
+//
+// Key layout, most significant first:
+//   63..52 program   51 wireframe   50..37 texture   36..23 mesh   22..0 depth
+// GL names wider than their field only lose ordering, the bound-state check still compares full names.
+class RenderQueue {
+public:
+    void clear();
+    void reserve(std::size_t count);
+    void submit(const DrawItem& item);
+    // LSD radix sort of the keys, passes where every key has the same byte are skipped
+    void sort();
+    // Assumes nothing about the GL state on entry
+    void execute(RenderDevice& device);
+
+    // Multi-draw path. build_commands writes one command per batch into out, which must hold size()
+    // commands, and returns how many it wrote. execute_indirect then issues one multi-draw per run
+    // of batches sharing program, wireframe, texture and VAO, reading the commands from the bound
+    // indirect buffer starting at commandOffset bytes.
+    std::size_t build_commands(DrawCommand* out);
+    void execute_indirect(RenderDevice& device, std::size_t commandOffset);
+
+    static std::uint64_t make_key(const DrawItem& item);
+    static bool same_batch(const DrawItem& a, const DrawItem& b);
+    static bool same_state(const DrawItem& a, const DrawItem& b);
+
+    std::size_t size() const;
+    const DrawItem& operator[](std::size_t i) const;  // in sorted order once sort() has run
+    const RenderQueueStats& get_stats() const;
+
+private:
+    std::vector<DrawItem> items;
+    std::vector<std::uint64_t> keys;
+    std::vector<std::uint32_t> order;
+    std::vector<std::uint64_t> scratchKeys;
+    std::vector<std::uint32_t> scratchOrder;
+    // Sorted position of the first item of each batch, filled by build_commands
+    std::vector<std::uint32_t> batchStarts;
+    RenderQueueStats stats;
+
+    struct BoundState {
+        unsigned int program = ~0u;
+        unsigned int texture = ~0u;
+        unsigned int vao = ~0u;
+        unsigned int wireframe = ~0u;
+    };
+    void apply_state(RenderDevice& device, const DrawItem& item, BoundState& bound);
+};
+
+#endif //RENDER_QUEUE_HPP
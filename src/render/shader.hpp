@@ -4,15 +4,36 @@
 #include <glad/gl.h>
 
 #include <string>
+#include <string_view>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
+#include "frame_stats.hpp"
+
+// Pre-resolved uniform location. An invalid handle (uniform missing or optimized out) makes the setters a no-op.
+struct UniformHandle {
+    int location = -1;
+
+    bool valid() const {
+        return location >= 0;
+    }
+};
+
+struct UniformInfo {
+    std::string name;
+    int location;
+    GLenum type;
+    int size;
+};
+
 class Shader{
 public:
     unsigned int ID;
 
-    Shader(const char* vertexPath, const char* fragmentPath){
+    // defines go in right after the #version line of both stages, e.g. MaterialSystem::get_shader_defines()
+    Shader(const char* vertexPath, const char* fragmentPath, const std::string& defines = ""){
 
         std::string vertexCode;
         std::string fragmentCode;
@@ -33,8 +54,8 @@ public:
             vShaderFile.close();
             fShaderFile.close();
 
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
+            vertexCode = insert_defines(vShaderStream.str(), defines);
+            fragmentCode = insert_defines(fShaderStream.str(), defines);
         }
         catch([[maybe_unused]] std::ifstream::failure &e){
             std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
@@ -86,32 +107,126 @@ public:
         glDeleteShader(vertex);
         glDeleteShader(fragment);
 
+        reflect_uniforms();
     }
 
     void use() const{
         glUseProgram(ID);
+        frame_stats().programBinds += 1;
+    }
+
+    // Resolves a uniform against the table built at link time, no GL call is made.
+    // Meant to be called once at setup, the handle is then reused every frame.
+    // Returns an invalid handle if the program has no such active uniform.
+    UniformHandle uniform(const std::string_view name) const{
+        for (const auto& info : uniforms) {
+            if (info.name == name) return {info.location};
+        }
+        return {};
+    }
+
+    const std::vector<UniformInfo>& get_uniforms() const{
+        return uniforms;
+    }
+
+    void setBool(const UniformHandle handle, const bool value) const{
+        setInt(handle, static_cast<int>(value));
+    }
+
+    void setInt(const UniformHandle handle, const int value) const{
+        if (!handle.valid()) return;
+        glUniform1i(handle.location, value);
+        frame_stats().uniformUploads += 1;
+    }
+
+    void setFloat(const UniformHandle handle, const float value) const{
+        if (!handle.valid()) return;
+        glUniform1f(handle.location, value);
+        frame_stats().uniformUploads += 1;
+    }
+
+    void setMat4f(const UniformHandle handle, const plutom::mat4f& value) const{
+        if (!handle.valid()) return;
+        glUniformMatrix4fv(handle.location, 1, GL_FALSE, plutom::value_ptr(value));
+        frame_stats().uniformUploads += 1;
+    }
+
+    void setMat3f(const UniformHandle handle, const plutom::mat3f& value) const{
+        if (!handle.valid()) return;
+        glUniformMatrix3fv(handle.location, 1, GL_FALSE, plutom::value_ptr(value));
+        frame_stats().uniformUploads += 1;
+    }
+
+    void setVec3f(const UniformHandle handle, const plutom::vec3f& value) const{
+        if (!handle.valid()) return;
+        glUniform3fv(handle.location, 1, plutom::value_ptr(value));
+        frame_stats().uniformUploads += 1;
+    }
+
+    // Name based setters, kept for one-off uploads. They go through the reflected table
+    // instead of glGetUniformLocation but still do a string compare per call.
+    void setBool(const std::string_view name, const bool value) const{
+        setBool(checked_uniform(name), value);
     }
 
-    void setBool(const std::string &name, const bool value) const{
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), static_cast<int>(value));
+    void setInt(const std::string_view name, const int value) const{
+        setInt(checked_uniform(name), value);
     }
 
-    void setInt(const std::string &name, const int value) const{
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    void setFloat(const std::string_view name, const float value) const{
+        setFloat(checked_uniform(name), value);
     }
 
-    void setFloat(const std::string &name, const float value) const{
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    void setMat4f(const std::string_view name, const plutom::mat4f& value) const{
+        setMat4f(checked_uniform(name), value);
     }
 
-    void setMat4f(const std::string &name, plutom::mat4f value) const{
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, plutom::value_ptr(value));
+    void setMat3f(const std::string_view name, const plutom::mat3f& value) const{
+        setMat3f(checked_uniform(name), value);
     }
 
-    void setVec3f(const std::string &name, plutom::vec3f value) const{
-        if (glGetUniformLocation(ID, name.c_str()) == -1)
+    void setVec3f(const std::string_view name, const plutom::vec3f& value) const{
+        setVec3f(checked_uniform(name), value);
+    }
+
+private:
+    std::vector<UniformInfo> uniforms;
+
+    static std::string insert_defines(std::string code, const std::string& defines){
+        if (defines.empty()) return code;
+        const auto versionEnd = code.rfind("#version", 0) == 0 ? code.find('\n') : std::string::npos;
+        if (versionEnd == std::string::npos) return defines + code;
+        return code.insert(versionEnd + 1, defines);
+    }
+
+    UniformHandle checked_uniform(const std::string_view name) const{
+        const UniformHandle handle = uniform(name);
+        if (!handle.valid())
             std::cout << "Name not found " << name << std::endl;
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, plutom::value_ptr(value));
+        return handle;
+    }
+
+    // Builds the flat uniform table once after linking
+    void reflect_uniforms(){
+        int count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::string buffer(static_cast<std::size_t>(maxLength), '\0');
+        uniforms.reserve(static_cast<std::size_t>(count));
+        for (int i = 0; i < count; ++i) {
+            int length = 0, size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(ID, static_cast<GLuint>(i), maxLength, &length, &size, &type, buffer.data());
+            std::string name(buffer.data(), static_cast<std::size_t>(length));
+            // Arrays are reported as "name[0]", store the base name
+            if (size > 1 && name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+                name.resize(name.size() - 3);
+            const int location = glGetUniformLocation(ID, name.c_str());
+            frame_stats().uniformLookups += 1;
+            // Members of uniform blocks have no location
+            if (location < 0) continue;
+            uniforms.push_back({std::move(name), location, type, size});
+        }
     }
 };
 
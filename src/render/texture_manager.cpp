@@ -0,0 +1,498 @@
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+#include "texture_manager.hpp"
+#include "gl_extensions.hpp"
+#include "../util/profiler.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+namespace {
+    // Shown until the image is resident. One texel is a complete mip chain, so the sampler
+    // state can be the final one from the start.
+    constexpr unsigned char PLACEHOLDER_TEXEL[4] = {255, 255, 255, 255};
+
+    // EXT_texture_compression_s3tc is not core GL, so the loader does not define these
+    constexpr GLenum COMPRESSED_RGB_S3TC_DXT1 = 0x83F0;
+    constexpr GLenum COMPRESSED_RGBA_S3TC_DXT5 = 0x83F3;
+
+    bool is_ptex(const std::string& path) {
+        constexpr char extension[] = ".ptex";
+        constexpr std::size_t length = sizeof(extension) - 1;
+        return path.size() > length && path.compare(path.size() - length, length, extension) == 0;
+    }
+
+    // Bilinear, after halving with a box filter while that stays at or above size, so large
+    // reductions still average every texel
+    std::vector<std::uint8_t> scale_to(std::vector<std::uint8_t> rgba, int width, int height, const int size) {
+        while (width / 2 >= size && height / 2 >= size) {
+            rgba = block_codec::downsample(rgba.data(), width, height);
+            width /= 2;
+            height /= 2;
+        }
+        if (width == size && height == size) return rgba;
+
+        std::vector<std::uint8_t> out(static_cast<std::size_t>(size) * size * 4);
+        const float sx = static_cast<float>(width) / static_cast<float>(size);
+        const float sy = static_cast<float>(height) / static_cast<float>(size);
+        for (int y = 0; y < size; ++y) {
+            const float fy = std::clamp((static_cast<float>(y) + 0.5f) * sy - 0.5f, 0.0f, static_cast<float>(height - 1));
+            const int y0 = static_cast<int>(fy), y1 = std::min(y0 + 1, height - 1);
+            const float ty = fy - static_cast<float>(y0);
+            for (int x = 0; x < size; ++x) {
+                const float fx = std::clamp((static_cast<float>(x) + 0.5f) * sx - 0.5f, 0.0f, static_cast<float>(width - 1));
+                const int x0 = static_cast<int>(fx), x1 = std::min(x0 + 1, width - 1);
+                const float tx = fx - static_cast<float>(x0);
+                for (int c = 0; c < 4; ++c) {
+                    const auto at = [&](const int px, const int py) {
+                        return static_cast<float>(rgba[(static_cast<std::size_t>(py) * width + px) * 4 + c]);
+                    };
+                    const float top = at(x0, y0) + (at(x1, y0) - at(x0, y0)) * tx;
+                    const float bottom = at(x0, y1) + (at(x1, y1) - at(x0, y1)) * tx;
+                    out[(static_cast<std::size_t>(y) * size + x) * 4 + c] =
+                        static_cast<std::uint8_t>(std::lround(top + (bottom - top) * ty));
+                }
+            }
+        }
+        return out;
+    }
+
+    std::size_t ptex_bytes(const PtexView& ptex) {
+        std::size_t bytes = 0;
+        for (std::uint32_t level = 0; level < ptex.header->mipCount; ++level) bytes += ptex.mips[level].size;
+        return bytes;
+    }
+
+    GLenum pixel_format(const int channels) {
+        switch (channels) {
+            case 1: return GL_RED;
+            case 2: return GL_RG;
+            case 3: return GL_RGB;
+            default: return GL_RGBA;
+        }
+    }
+
+    GLint internal_format(const int channels) {
+        switch (channels) {
+            case 1: return GL_R8;
+            case 2: return GL_RG8;
+            case 3: return GL_RGB8;
+            default: return GL_RGBA8;
+        }
+    }
+}
+
+TextureManager::TextureManager(const std::size_t uploadBudget, unsigned int decodeThreads)
+    : uploadBudget(uploadBudget), s3tc(has_gl_extension("GL_EXT_texture_compression_s3tc")) {
+    if (decodeThreads == 0) decodeThreads = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    decodeThreads = std::max(decodeThreads, 1u);
+    for (unsigned int i = 0; i < decodeThreads; ++i) {
+        workers.emplace_back([this, i] {
+            PLUTO_PROFILE_THREAD("Texture decoder " + std::to_string(i));
+            decode_loop();
+        });
+    }
+}
+
+TextureManager::~TextureManager() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+
+    for (auto& upload : uploads) {
+        if (upload.mapped) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload.buffer);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+        if (upload.buffer) glDeleteBuffers(1, &upload.buffer);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    for (const auto& texture : textures) {
+        if (texture.id) glDeleteTextures(1, &texture.id);
+    }
+    if (array) glDeleteTextures(1, &array);
+}
+
+unsigned int TextureManager::load(const std::string& path, const bool flip) {
+    stats.requested += 1;
+    const std::string key = flip ? path + "#flipped" : path;
+    if (const auto found = slotOf.find(key); found != slotOf.end()) {
+        stats.shared += 1;
+        return textures[found->second].id;
+    }
+
+    unsigned int id;
+    glGenTextures(1, &id);
+    glBindTexture(GL_TEXTURE_2D, id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, PLACEHOLDER_TEXEL);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    const std::size_t slot = textures.size();
+    textures.push_back({id, path});
+    slotOf.emplace(key, slot);
+    slotOfName.emplace(id, slot);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.push_back({slot, path, flip, 0});
+    }
+    wake.notify_one();
+    return id;
+}
+
+std::uint32_t TextureManager::load_layer(const std::string& path, const bool flip) {
+    stats.requested += 1;
+    const std::string key = (flip ? path + "#flipped" : path) + "#layer";
+    if (const auto found = slotOf.find(key); found != slotOf.end()) {
+        stats.shared += 1;
+        return textures[found->second].layer;
+    }
+
+    if (slotOfLayer.empty()) slotOfLayer.push_back(NO_SLOT);  // the placeholder
+    const auto layer = static_cast<std::uint32_t>(slotOfLayer.size());
+    if (layer >= layerCapacity) grow_array(std::max(INITIAL_LAYERS, layerCapacity * 2));
+
+    const std::size_t slot = textures.size();
+    textures.push_back({0, path, false, layer});
+    slotOf.emplace(key, slot);
+    slotOfLayer.push_back(slot);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.push_back({slot, path, flip, layerSize});
+    }
+    wake.notify_one();
+    return layer;
+}
+
+void TextureManager::update() {
+    PLUTO_PROFILE_FUNCTION();
+    take_decoded();
+    stats.uploadedBytes = 0;
+    const std::size_t fullBudget = uploadBudget == 0 ? std::numeric_limits<std::size_t>::max() : uploadBudget;
+    std::size_t budget = fullBudget;
+    while (!uploads.empty() && budget > 0) {
+        Upload& upload = uploads.front();
+        std::size_t copied;
+        if (upload.image.ptex.header) {
+            // Goes to GL whole, so one that does not fit what is left waits unless it is the first
+            copied = ptex_bytes(upload.image.ptex);
+            if (copied > budget && budget < fullBudget) break;
+            upload_compressed(upload);
+        } else {
+            copied = stream(upload, budget);
+        }
+        budget -= std::min(copied, budget);
+        stats.uploadedBytes += copied;
+        if (textures[upload.image.slot].resident) uploads.pop_front();
+    }
+}
+
+void TextureManager::finish() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        decodedReady.wait(lock, [this] { return requests.empty() && decoding == 0; });
+    }
+    const std::size_t budget = uploadBudget;
+    uploadBudget = 0;
+    update();
+    uploadBudget = budget;
+}
+
+void TextureManager::decode_loop() {
+    while (true) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return !requests.empty() || !running; });
+            if (!running) return;
+            request = std::move(requests.front());
+            requests.pop_front();
+            decoding += 1;
+        }
+
+        Decoded image;
+        image.slot = request.slot;
+        {
+            PLUTO_PROFILE_SCOPE("decode texture");
+            if (request.layerSize > 0) {
+                read_layer(request, image);
+            } else if (is_ptex(request.path)) {
+                read_ptex(request.path, image);
+            } else {
+                stbi_set_flip_vertically_on_load_thread(request.flip);
+                image.pixels = {stbi_load(request.path.c_str(), &image.width, &image.height, &image.channels, 0),
+                                stbi_image_free};
+                image.size = static_cast<std::size_t>(image.width) * image.height * image.channels;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            decoded.push_back(std::move(image));
+            decoding -= 1;
+        }
+        decodedReady.notify_all();
+    }
+}
+
+void TextureManager::read_ptex(const std::string& path, Decoded& image) const {
+    MappedFile file(path);
+    PtexView ptex;
+    if (!file.is_open() || !ptex.parse(file.data(), file.size())) return;
+    image.width = static_cast<int>(ptex.header->width);
+    image.height = static_cast<int>(ptex.header->height);
+
+    if (s3tc) {
+        // Fault the pages in on this thread rather than in the middle of update()
+        file.prefetch();
+        // Moving the mapping keeps its address, the view stays valid
+        image.file = std::move(file);
+        image.ptex = ptex;
+        return;
+    }
+
+    auto rgba = block_codec::decompress(ptex.get_format(), ptex.get_level(0), image.width, image.height);
+    auto* pixels = static_cast<unsigned char*>(std::malloc(rgba.size()));
+    if (!pixels) return;
+    std::memcpy(pixels, rgba.data(), rgba.size());
+    image.pixels = {pixels, std::free};
+    image.channels = 4;
+    image.size = rgba.size();
+}
+
+void TextureManager::read_layer(const Request& request, Decoded& image) {
+    std::vector<std::uint8_t> rgba;
+    int width = 0, height = 0;
+    if (is_ptex(request.path)) {
+        const MappedFile file(request.path);
+        PtexView ptex;
+        if (!file.is_open() || !ptex.parse(file.data(), file.size())) return;
+        width = static_cast<int>(ptex.header->width);
+        height = static_cast<int>(ptex.header->height);
+        rgba = block_codec::decompress(ptex.get_format(), ptex.get_level(0), width, height);
+    } else {
+        int channels;
+        stbi_set_flip_vertically_on_load_thread(request.flip);
+        std::uint8_t* pixels = stbi_load(request.path.c_str(), &width, &height, &channels, 4);
+        if (!pixels) return;
+        rgba.assign(pixels, pixels + static_cast<std::size_t>(width) * height * 4);
+        stbi_image_free(pixels);
+    }
+
+    int size = request.layerSize;
+    auto level = scale_to(std::move(rgba), width, height, size);
+    image.width = image.height = size;
+    image.channels = 4;
+    image.levels = block_codec::mip_count(size, size);
+    for (int mip = 0, s = size; mip < image.levels; ++mip, s = std::max(s / 2, 1))
+        image.size += static_cast<std::size_t>(s) * s * 4;
+
+    auto* pixels = static_cast<unsigned char*>(std::malloc(image.size));
+    if (!pixels) return;
+    image.pixels = {pixels, std::free};
+    for (int mip = 0; mip < image.levels; ++mip) {
+        std::memcpy(pixels, level.data(), level.size());
+        pixels += level.size();
+        if (mip + 1 < image.levels) {
+            level = block_codec::downsample(level.data(), size, size);
+            size = std::max(size / 2, 1);
+        }
+    }
+}
+
+void TextureManager::grow_array(const std::uint32_t capacity) {
+    unsigned int grown;
+    glGenTextures(1, &grown);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, grown);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    const int levels = block_codec::mip_count(layerSize, layerSize);
+    for (int level = 0, size = layerSize; level < levels; ++level, size = std::max(size / 2, 1)) {
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, size, size, static_cast<GLsizei>(capacity), 0, GL_RGBA,
+                     GL_UNSIGNED_BYTE, nullptr);
+    }
+
+    for (int level = 0, size = layerSize; level < levels; ++level, size = std::max(size / 2, 1)) {
+        if (!array) {
+            const std::vector<std::uint8_t> white(static_cast<std::size_t>(size) * size * 4, 255);
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, static_cast<GLint>(PLACEHOLDER_LAYER), size, size, 1,
+                            GL_RGBA, GL_UNSIGNED_BYTE, white.data());
+        } else if (GLAD_GL_VERSION_4_3) {
+            glCopyImageSubData(array, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, grown, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+                               size, size, static_cast<GLsizei>(layerCapacity));
+        } else {
+            // Round trip through memory, it only happens while the scene loads
+            std::vector<std::uint8_t> layers(static_cast<std::size_t>(size) * size * 4 * layerCapacity);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, array);
+            glGetTexImage(GL_TEXTURE_2D_ARRAY, level, GL_RGBA, GL_UNSIGNED_BYTE, layers.data());
+            glBindTexture(GL_TEXTURE_2D_ARRAY, grown);
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, size, size, static_cast<GLsizei>(layerCapacity), GL_RGBA,
+                            GL_UNSIGNED_BYTE, layers.data());
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    if (array) glDeleteTextures(1, &array);
+    array = grown;
+    layerCapacity = capacity;
+}
+
+void TextureManager::take_decoded() {
+    std::vector<Decoded> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.swap(decoded);
+    }
+    for (auto& image : ready) {
+        if (!image.pixels && !image.ptex.header) {
+            std::cout << "Failed to load texture " << textures[image.slot].path << std::endl;
+            textures[image.slot].failed = true;
+            stats.failed += 1;
+            continue;
+        }
+        uploads.push_back({std::move(image)});
+    }
+}
+
+std::size_t TextureManager::stream(Upload& upload, const std::size_t budget) {
+    const std::size_t size = upload.image.size;
+    if (!upload.buffer) {
+        glGenBuffers(1, &upload.buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload.buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_DRAW);
+    } else {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload.buffer);
+    }
+    // Stays mapped across frames while it fills, the buffer is unbound whenever GL could use it
+    if (!upload.mapped) {
+        upload.mapped = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0,
+            static_cast<GLsizeiptr>(size), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        upload.copied = 0;
+    }
+
+    const std::size_t count = std::min(size - upload.copied, budget);
+    std::memcpy(upload.mapped + upload.copied, upload.image.pixels.get() + upload.copied, count);
+    upload.copied += count;
+    if (upload.copied == size) complete(upload);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return count;
+}
+
+void TextureManager::complete(Upload& upload) {
+    upload.mapped = nullptr;
+    // The contents are lost if the mapping was, the next update() copies them again
+    if (!glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER)) return;
+
+    const auto& image = upload.image;
+    Texture& texture = textures[image.slot];
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    // Reads from the bound pixel buffer, the driver copies it to the texture without stalling here
+    if (texture.layer != NO_LAYER) {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, array);
+        std::size_t offset = 0;
+        for (int level = 0, size = image.width; level < image.levels; ++level, size = std::max(size / 2, 1)) {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, static_cast<GLint>(texture.layer), size, size, 1, GL_RGBA,
+                            GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(offset));
+            offset += static_cast<std::size_t>(size) * size * 4;
+        }
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    } else {
+        glBindTexture(GL_TEXTURE_2D, texture.id);
+        glTexImage2D(GL_TEXTURE_2D, 0, internal_format(image.channels), image.width, image.height, 0,
+                     pixel_format(image.channels), GL_UNSIGNED_BYTE, nullptr);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteBuffers(1, &upload.buffer);
+    upload.buffer = 0;
+    upload.image.pixels.reset();
+    texture.resident = true;
+    stats.resident += 1;
+}
+
+void TextureManager::upload_compressed(Upload& upload) {
+    const PtexView& ptex = upload.image.ptex;
+    const GLenum format = ptex.get_format() == BlockFormat::BC1 ? COMPRESSED_RGB_S3TC_DXT1 : COMPRESSED_RGBA_S3TC_DXT5;
+    Texture& texture = textures[upload.image.slot];
+    glBindTexture(GL_TEXTURE_2D, texture.id);
+    for (std::uint32_t level = 0; level < ptex.header->mipCount; ++level) {
+        const PtexMip& mip = ptex.mips[level];
+        glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), format, static_cast<GLsizei>(mip.width),
+                               static_cast<GLsizei>(mip.height), 0, static_cast<GLsizei>(mip.size), ptex.get_level(level));
+    }
+    // A file cooked without mips would otherwise leave the texture incomplete
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(ptex.header->mipCount - 1));
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // GL has its own copy once the calls return
+    upload.image.ptex = {};
+    upload.image.file = MappedFile();
+    texture.resident = true;
+    stats.resident += 1;
+    stats.compressed += 1;
+}
+
+bool TextureManager::is_resident(const unsigned int texture) const {
+    const Texture* found = find(texture);
+    return found && found->resident;
+}
+
+bool TextureManager::is_layer_resident(const std::uint32_t layer) const {
+    if (layer == PLACEHOLDER_LAYER) return !slotOfLayer.empty();
+    const Texture* found = find_layer(layer);
+    return found && found->resident;
+}
+
+bool TextureManager::is_failed(const unsigned int texture) const {
+    const Texture* found = find(texture);
+    return found && found->failed;
+}
+
+bool TextureManager::is_layer_failed(const std::uint32_t layer) const {
+    const Texture* found = find_layer(layer);
+    return found && found->failed;
+}
+
+const TextureManager::Texture* TextureManager::find(const unsigned int texture) const {
+    const auto found = slotOfName.find(texture);
+    return found != slotOfName.end() ? &textures[found->second] : nullptr;
+}
+
+const TextureManager::Texture* TextureManager::find_layer(const std::uint32_t layer) const {
+    if (layer >= slotOfLayer.size() || slotOfLayer[layer] == NO_SLOT) return nullptr;
+    return &textures[slotOfLayer[layer]];
+}
+
+unsigned int TextureManager::get_array() const {
+    return array;
+}
+
+void TextureManager::set_layer_size(const int size) {
+    if (!array) layerSize = std::max(size, 1);
+}
+
+std::size_t TextureManager::get_pending() const {
+    return textures.size() - stats.resident - stats.failed;
+}
+
+const TextureStats& TextureManager::get_stats() const {
+    return stats;
+}
+
+void TextureManager::set_upload_budget(const std::size_t bytes) {
+    uploadBudget = bytes;
+}
@@ -0,0 +1,156 @@
+#ifndef TEXTURE_MANAGER_HPP
+#define TEXTURE_MANAGER_HPP
+
+#include <glad/gl.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../util/mapped_file.hpp"
+#include "../util/ptex_format.hpp"
+
+struct TextureStats {
+    unsigned int requested = 0;     // load() calls
+    unsigned int shared = 0;        // load() calls answered with an existing texture
+    unsigned int resident = 0;
+    unsigned int failed = 0;
+    unsigned int compressed = 0;    // resident ones loaded from .ptex
+    std::size_t uploadedBytes = 0;  // handed to GL by the last update()
+};
+
+/*  Loads textures off the GL thread. load() hands back a texture name at once, filled with a
+    placeholder texel, and queues the file for decoding on the manager's own threads (not the
+    frame's JobSystem, whose waits would pick a decode up in the middle of a frame). update()
+    streams decoded images into pixel unpack buffers, at most uploadBudget bytes a frame, and
+    specifies the texture from the buffer once all of it is there, so the texture flips from the
+    placeholder to the image in one go and the name never changes. Asking twice for the same
+    file returns the same texture.
+    Cooked .ptex files (see pluto_cook) skip all of that: the decode thread maps the file and reads
+    it in, and update() passes each block compressed level to GL straight from the mapping. They
+    are stored bottom row first already, flip does not apply. Without S3TC support they are
+    decompressed on the decode thread and take the uncompressed path.
+    load_layer() puts the image into a layer of one shared GL_TEXTURE_2D_ARRAY instead, so
+    shapes with different textures can be drawn together. Layers are square and all the same
+    size, images are scaled to it and get their mips on the decode thread. Layer 0 is a white
+    placeholder; the array doubles (copied on the GPU) when it runs out of layers.
+    Everything but the decoding happens on the thread that owns the GL context.
+ */
+class TextureManager {
+public:
+    static constexpr std::size_t DEFAULT_UPLOAD_BUDGET = 4 << 20;
+    static constexpr int DEFAULT_LAYER_SIZE = 512;
+    static constexpr std::uint32_t PLACEHOLDER_LAYER = 0;
+
+    // uploadBudget 0 uploads without a limit. decodeThreads 0 picks one per hardware thread,
+    // less one for the GL thread.
+    explicit TextureManager(std::size_t uploadBudget = DEFAULT_UPLOAD_BUDGET, unsigned int decodeThreads = 0);
+    ~TextureManager();
+
+    TextureManager(const TextureManager&) = delete;
+    TextureManager& operator=(const TextureManager&) = delete;
+
+    unsigned int load(const std::string& path, bool flip);
+    std::uint32_t load_layer(const std::string& path, bool flip);
+    // Once a frame, before drawing
+    void update();
+    // Blocks until every texture asked for so far is resident or has failed, ignoring the budget
+    void finish();
+
+    bool is_resident(unsigned int texture) const;
+    bool is_layer_resident(std::uint32_t layer) const;
+    // The file could not be read or decoded, the placeholder stays for good
+    bool is_failed(unsigned int texture) const;
+    bool is_layer_failed(std::uint32_t layer) const;
+    // 0 until the first load_layer()
+    unsigned int get_array() const;
+    // Only before the first load_layer()
+    void set_layer_size(int size);
+    std::size_t get_pending() const;
+    const TextureStats& get_stats() const;
+    void set_upload_budget(std::size_t bytes);
+
+private:
+    static constexpr std::uint32_t NO_LAYER = ~0u;
+    static constexpr std::size_t NO_SLOT = ~std::size_t{0};
+    static constexpr std::uint32_t INITIAL_LAYERS = 8;
+
+    struct Request {
+        std::size_t slot;
+        std::string path;
+        bool flip;
+        int layerSize;  // 0 unless it goes to an array layer
+    };
+    struct Decoded {
+        std::size_t slot;
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        int levels = 1;          // mips stored one after the other in pixels
+        std::size_t size = 0;    // bytes in pixels
+        std::unique_ptr<unsigned char, void (*)(void*)> pixels{nullptr, nullptr};
+        // Set instead of pixels for a .ptex uploaded compressed
+        MappedFile file;
+        PtexView ptex;
+    };
+    // A decoded image on its way into a pixel buffer
+    struct Upload {
+        Decoded image;
+        unsigned int buffer = 0;
+        unsigned char* mapped = nullptr;
+        std::size_t copied = 0;
+    };
+    struct Texture {
+        unsigned int id;         // 0 for array layers
+        std::string path;
+        bool resident = false;
+        std::uint32_t layer = NO_LAYER;
+        bool failed = false;
+    };
+
+    std::size_t uploadBudget;
+    bool s3tc;
+    std::vector<Texture> textures;
+    std::unordered_map<std::string, std::size_t> slotOf;
+    // Slots by texture name and by layer, NO_SLOT for the placeholder layer
+    std::unordered_map<unsigned int, std::size_t> slotOfName;
+    std::deque<Upload> uploads;
+    TextureStats stats;
+
+    unsigned int array = 0;
+    int layerSize = DEFAULT_LAYER_SIZE;
+    std::uint32_t layerCapacity = 0;
+    std::vector<std::size_t> slotOfLayer;
+
+    // Shared with the decode threads
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable decodedReady;
+    std::deque<Request> requests;
+    std::vector<Decoded> decoded;
+    std::size_t decoding = 0;
+    bool running = true;
+    std::vector<std::thread> workers;
+
+    void decode_loop();
+    void read_ptex(const std::string& path, Decoded& image) const;
+    // Scaled to the layer size, with the mip chain below it
+    static void read_layer(const Request& request, Decoded& image);
+    void grow_array(std::uint32_t capacity);
+    const Texture* find(unsigned int texture) const;
+    const Texture* find_layer(std::uint32_t layer) const;
+    void take_decoded();
+    // Copies up to budget bytes of the front upload, specifying the texture when it is complete
+    std::size_t stream(Upload& upload, std::size_t budget);
+    void complete(Upload& upload);
+    void upload_compressed(Upload& upload);
+};
+
+#endif //TEXTURE_MANAGER_HPP
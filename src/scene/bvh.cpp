@@ -0,0 +1,410 @@
+#include "bvh.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+namespace {
+    constexpr int SAH_BINS = 16;
+    // Relative cost of visiting a node against testing one object box
+    constexpr float TRAVERSAL_COST = 1.0f;
+    // Subtrees smaller than this are not worth a job
+    constexpr std::size_t PARALLEL_MIN_OBJECTS = 4096;
+    // Subtrees per thread a parallel cull() splits the tree into
+    constexpr std::size_t CULL_SUBTREES_PER_THREAD = 4;
+
+    // Levels that fork into jobs, enough for one subtree per thread plus one level of slack for stealing
+    unsigned int parallel_depth(const JobSystem* jobs) {
+        if (!jobs || jobs->get_thread_count() < 2) return 0;
+        unsigned int depth = 1;
+        while ((1u << depth) < jobs->get_thread_count()) depth += 1;
+        return depth + 1;
+    }
+
+    // False if the box is outside one of the planes left in mask. Planes the box is fully
+    // inside of are removed from mask, children never need to test them again.
+    bool test_planes(const plutom::frustumf& frustum, const plutom::aabbf& box, std::uint32_t& mask) {
+        const plutom::vec3f c = box.center();
+        const plutom::vec3f e = box.extent();
+        for (std::uint32_t p = 0; p < 6; ++p) {
+            if (!(mask & (1u << p))) continue;
+            const plutom::planef& plane = frustum.planes[p];
+            const float d = plane.distance(c);
+            const float r = e.x * std::abs(plane.normal.x) + e.y * std::abs(plane.normal.y) +
+                            e.z * std::abs(plane.normal.z);
+            if (d + r < 0.0f) return false;
+            if (d - r >= 0.0f) mask &= ~(1u << p);
+        }
+        return true;
+    }
+
+    // Slab test, entry is clamped to 0 when the origin is inside the box
+    bool ray_box(const plutom::aabbf& box, const plutom::vec3f& origin, const plutom::vec3f& inverse,
+                 const float maxDistance, float& entry) {
+        const float tx0 = (box.min.x - origin.x) * inverse.x, tx1 = (box.max.x - origin.x) * inverse.x;
+        const float ty0 = (box.min.y - origin.y) * inverse.y, ty1 = (box.max.y - origin.y) * inverse.y;
+        const float tz0 = (box.min.z - origin.z) * inverse.z, tz1 = (box.max.z - origin.z) * inverse.z;
+        const float near = std::max({std::min(tx0, tx1), std::min(ty0, ty1), std::min(tz0, tz1), 0.0f});
+        const float far = std::min({std::max(tx0, tx1), std::max(ty0, ty1), std::max(tz0, tz1), maxDistance});
+        entry = near;
+        return near <= far;
+    }
+
+    float safe_inverse(const float v) {
+        constexpr float tiny = 1e-30f;
+        return 1.0f / (std::abs(v) < tiny ? (v < 0.0f ? -tiny : tiny) : v);
+    }
+}
+
+// Boxes are copied next to their centroids and partitioned in place, so every pass over a
+// node's range reads memory sequentially instead of going through the object indices
+struct Bvh::BuildContext {
+    struct Primitive {
+        plutom::aabbf bounds;
+        plutom::vec3f centroid;
+        std::uint32_t object;
+    };
+    std::vector<Primitive> primitives;
+    std::atomic<std::uint32_t> nextNode{1};
+    JobSystem* jobs = nullptr;
+};
+
+void Bvh::clear() {
+    nodes.clear();
+    objects.clear();
+    objectBounds.clear();
+}
+
+void Bvh::build(const plutom::aabbf* bounds, const std::size_t count, JobSystem* jobs) {
+    clear();
+    if (count == 0) return;
+
+    BuildContext ctx;
+    ctx.primitives.resize(count);
+    ctx.jobs = jobs;
+    for (std::size_t i = 0; i < count; ++i)
+        ctx.primitives[i] = {bounds[i], bounds[i].center(), static_cast<std::uint32_t>(i)};
+    // A binary tree over count leaves never needs more nodes than this, the vector must not
+    // reallocate while worker threads hold references into it
+    nodes.resize(2 * count - 1);
+    parallelDepth = parallel_depth(jobs);
+
+    build_node(ctx, 0, 0, static_cast<std::uint32_t>(count), 0);
+    nodes.resize(ctx.nextNode.load());
+    objects.resize(count);
+    objectBounds.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        objects[i] = ctx.primitives[i].object;
+        objectBounds[i] = ctx.primitives[i].bounds;
+    }
+}
+
+void Bvh::build_node(BuildContext& ctx, const std::uint32_t node, const std::uint32_t begin, const std::uint32_t end,
+                     const unsigned int depth) {
+    BvhNode& n = nodes[node];
+    plutom::aabbf box, centroidBox;
+    const auto* primitives = ctx.primitives.data();
+    for (std::uint32_t i = begin; i < end; ++i) {
+        box.expand(primitives[i].bounds);
+        centroidBox.expand(primitives[i].centroid);
+    }
+    n.bounds = box;
+    const std::uint32_t count = end - begin;
+    if (count == 1) {
+        n.first = begin;
+        n.count = count;
+        return;
+    }
+
+    // Binned SAH over all three axes
+    struct Bin {
+        plutom::aabbf bounds;
+        std::uint32_t count = 0;
+    };
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1, bestSplit = 0;
+    const plutom::vec3f span = centroidBox.max - centroidBox.min;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (span[axis] <= 0.0f) continue;
+        const float low = centroidBox.min[axis];
+        const float scale = SAH_BINS / span[axis];
+        Bin bins[SAH_BINS];
+        for (std::uint32_t i = begin; i < end; ++i) {
+            const int b = std::min(SAH_BINS - 1, static_cast<int>((primitives[i].centroid[axis] - low) * scale));
+            bins[b].count += 1;
+            bins[b].bounds.expand(primitives[i].bounds);
+        }
+        float leftArea[SAH_BINS - 1];
+        std::uint32_t leftCount[SAH_BINS - 1];
+        plutom::aabbf left;
+        std::uint32_t inLeft = 0;
+        for (int b = 0; b < SAH_BINS - 1; ++b) {
+            left.expand(bins[b].bounds);
+            inLeft += bins[b].count;
+            leftCount[b] = inLeft;
+            leftArea[b] = inLeft > 0 ? left.surface_area() : 0.0f;
+        }
+        plutom::aabbf right;
+        std::uint32_t inRight = 0;
+        for (int b = SAH_BINS - 1; b > 0; --b) {
+            right.expand(bins[b].bounds);
+            inRight += bins[b].count;
+            if (inRight == 0 || leftCount[b - 1] == 0) continue;
+            const float cost = leftArea[b - 1] * static_cast<float>(leftCount[b - 1]) +
+                               right.surface_area() * static_cast<float>(inRight);
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = b;
+            }
+        }
+    }
+
+    std::uint32_t mid = begin + count / 2;
+    if (bestAxis >= 0) {
+        const float area = box.surface_area();
+        const float splitCost = TRAVERSAL_COST + (area > 0.0f ? bestCost / area : 0.0f);
+        if (splitCost >= static_cast<float>(count) && count <= MAX_LEAF_SIZE) {
+            n.first = begin;
+            n.count = count;
+            return;
+        }
+        const float low = centroidBox.min[bestAxis];
+        const float scale = SAH_BINS / span[bestAxis];
+        const auto first = ctx.primitives.begin();
+        const auto it = std::partition(first + begin, first + end, [&](const BuildContext::Primitive& p) {
+            return std::min(SAH_BINS - 1, static_cast<int>((p.centroid[bestAxis] - low) * scale)) < bestSplit;
+        });
+        mid = static_cast<std::uint32_t>(it - first);
+        if (mid == begin || mid == end) mid = begin + count / 2;
+    } else if (count <= MAX_LEAF_SIZE) {
+        // Every centroid in the same spot, no split can separate them
+        n.first = begin;
+        n.count = count;
+        return;
+    }
+
+    const std::uint32_t left = ctx.nextNode.fetch_add(2);
+    n.first = left;
+    n.count = 0;
+    if (depth < parallelDepth && count >= PARALLEL_MIN_OBJECTS) {
+        JobCounter leftDone;
+        ctx.jobs->run([&] { build_node(ctx, left, begin, mid, depth + 1); }, &leftDone);
+        build_node(ctx, left + 1, mid, end, depth + 1);
+        ctx.jobs->wait(leftDone);
+    } else {
+        build_node(ctx, left, begin, mid, depth + 1);
+        build_node(ctx, left + 1, mid, end, depth + 1);
+    }
+}
+
+void Bvh::refit(const plutom::aabbf* bounds, JobSystem* jobs) {
+    if (nodes.empty()) return;
+    parallelDepth = parallel_depth(jobs);
+    refit_node(bounds, jobs, 0, 0);
+}
+
+void Bvh::refit_node(const plutom::aabbf* bounds, JobSystem* jobs, const std::uint32_t node, const unsigned int depth) {
+    BvhNode& n = nodes[node];
+    if (n.is_leaf()) {
+        plutom::aabbf box;
+        for (std::uint32_t e = n.first; e < n.first + n.count; ++e) {
+            objectBounds[e] = bounds[objects[e]];
+            box.expand(objectBounds[e]);
+        }
+        n.bounds = box;
+        return;
+    }
+    if (depth < parallelDepth && (nodes.size() >> depth) >= PARALLEL_MIN_OBJECTS) {
+        JobCounter leftDone;
+        jobs->run([&] { refit_node(bounds, jobs, n.first, depth + 1); }, &leftDone);
+        refit_node(bounds, jobs, n.first + 1, depth + 1);
+        jobs->wait(leftDone);
+    } else {
+        refit_node(bounds, jobs, n.first, depth + 1);
+        refit_node(bounds, jobs, n.first + 1, depth + 1);
+    }
+    n.bounds = nodes[n.first].bounds;
+    n.bounds.expand(nodes[n.first + 1].bounds);
+}
+
+void Bvh::cull(const plutom::frustumf& frustum, std::vector<std::uint32_t>& visible, JobSystem* jobs) const {
+    if (nodes.empty()) return;
+    if (!jobs || jobs->get_thread_count() < 2 || objects.size() < PARALLEL_MIN_OBJECTS) {
+        cull_node(frustum, 0, 0x3F, visible);
+        return;
+    }
+
+    // Split the top of the tree into a row of untested subtrees, left to right, so culling them
+    // separately and concatenating gives the same order as one pass from the root
+    struct Entry {
+        std::uint32_t node;
+        std::uint32_t mask;
+    };
+    const std::size_t target = jobs->get_thread_count() * CULL_SUBTREES_PER_THREAD;
+    std::vector<Entry> row{{0, 0x3F}}, next;
+    bool split = true;
+    while (split && row.size() < target) {
+        split = false;
+        next.clear();
+        for (auto [node, mask] : row) {
+            const BvhNode& n = nodes[node];
+            if (!test_planes(frustum, n.bounds, mask)) continue;
+            // Testing again with the narrowed mask gives the same answer, keep it as it is
+            if (mask == 0 || n.is_leaf()) {
+                next.push_back({node, mask});
+                continue;
+            }
+            next.push_back({n.first, mask});
+            next.push_back({n.first + 1, mask});
+            split = true;
+        }
+        row.swap(next);
+    }
+
+    std::vector<std::vector<std::uint32_t>> found(row.size());
+    jobs->parallel_for(0, row.size(), 1, [&](const std::size_t first, const std::size_t last) {
+        for (std::size_t k = first; k < last; ++k) cull_node(frustum, row[k].node, row[k].mask, found[k]);
+    });
+    std::size_t total = visible.size();
+    for (const auto& part : found) total += part.size();
+    visible.reserve(total);
+    for (const auto& part : found) visible.insert(visible.end(), part.begin(), part.end());
+}
+
+void Bvh::cull_node(const plutom::frustumf& frustum, const std::uint32_t node, const std::uint32_t mask,
+                    std::vector<std::uint32_t>& visible) const {
+    struct Entry {
+        std::uint32_t node;
+        std::uint32_t mask;
+    };
+    std::vector<Entry> stack;
+    stack.reserve(64);
+    stack.push_back({node, mask});
+    while (!stack.empty()) {
+        auto [node, mask] = stack.back();
+        stack.pop_back();
+        const BvhNode& n = nodes[node];
+        if (!test_planes(frustum, n.bounds, mask)) continue;
+        if (mask == 0) {
+            append_subtree(node, visible);
+        } else if (n.is_leaf()) {
+            for (std::uint32_t e = n.first; e < n.first + n.count; ++e) {
+                std::uint32_t objectMask = mask;
+                if (test_planes(frustum, objectBounds[e], objectMask)) visible.push_back(objects[e]);
+            }
+        } else {
+            stack.push_back({n.first + 1, mask});
+            stack.push_back({n.first, mask});
+        }
+    }
+}
+
+void Bvh::append_subtree(const std::uint32_t node, std::vector<std::uint32_t>& out) const {
+    std::vector<std::uint32_t> stack;
+    stack.reserve(64);
+    stack.push_back(node);
+    while (!stack.empty()) {
+        const BvhNode& n = nodes[stack.back()];
+        stack.pop_back();
+        if (n.is_leaf()) {
+            out.insert(out.end(), objects.begin() + n.first, objects.begin() + n.first + n.count);
+        } else {
+            stack.push_back(n.first + 1);
+            stack.push_back(n.first);
+        }
+    }
+}
+
+BvhHit Bvh::raycast(const plutom::vec3f& origin, const plutom::vec3f& direction, const float maxDistance) const {
+    BvhHit hit;
+    if (nodes.empty()) return hit;
+    const plutom::vec3f inverse{safe_inverse(direction.x), safe_inverse(direction.y), safe_inverse(direction.z)};
+    float best = maxDistance;
+    float entry;
+    if (!ray_box(nodes[0].bounds, origin, inverse, best, entry)) return hit;
+
+    struct Entry {
+        std::uint32_t node;
+        float distance;
+    };
+    std::vector<Entry> stack;
+    stack.reserve(64);
+    stack.push_back({0, entry});
+    while (!stack.empty()) {
+        const auto [node, distance] = stack.back();
+        stack.pop_back();
+        if (distance > best) continue;
+        const BvhNode& n = nodes[node];
+        if (n.is_leaf()) {
+            for (std::uint32_t e = n.first; e < n.first + n.count; ++e) {
+                if (ray_box(objectBounds[e], origin, inverse, best, entry) && (!hit.valid() || entry < best)) {
+                    best = entry;
+                    hit = {objects[e], entry};
+                }
+            }
+            continue;
+        }
+        // Nearer child on top of the stack so it can tighten best before the other is visited
+        float nearEntry, farEntry;
+        std::uint32_t nearChild = n.first, farChild = n.first + 1;
+        bool nearHit = ray_box(nodes[nearChild].bounds, origin, inverse, best, nearEntry);
+        bool farHit = ray_box(nodes[farChild].bounds, origin, inverse, best, farEntry);
+        if (nearHit && farHit && farEntry < nearEntry) {
+            std::swap(nearChild, farChild);
+            std::swap(nearEntry, farEntry);
+        } else if (!nearHit) {
+            std::swap(nearChild, farChild);
+            std::swap(nearEntry, farEntry);
+            std::swap(nearHit, farHit);
+        }
+        if (farHit) stack.push_back({farChild, farEntry});
+        if (nearHit) stack.push_back({nearChild, nearEntry});
+    }
+    return hit;
+}
+
+void Bvh::query(const plutom::aabbf& region, std::vector<std::uint32_t>& found) const {
+    if (nodes.empty()) return;
+    std::vector<std::uint32_t> stack;
+    stack.reserve(64);
+    stack.push_back(0);
+    while (!stack.empty()) {
+        const BvhNode& n = nodes[stack.back()];
+        stack.pop_back();
+        if (!n.bounds.intersects(region)) continue;
+        if (n.is_leaf()) {
+            for (std::uint32_t e = n.first; e < n.first + n.count; ++e) {
+                if (objectBounds[e].intersects(region)) found.push_back(objects[e]);
+            }
+        } else {
+            stack.push_back(n.first + 1);
+            stack.push_back(n.first);
+        }
+    }
+}
+
+float Bvh::sah_cost() const {
+    if (nodes.empty()) return 0.0f;
+    const float rootArea = nodes[0].bounds.surface_area();
+    if (rootArea <= 0.0f) return 0.0f;
+    float cost = 0.0f;
+    for (const auto& n : nodes) {
+        const float area = n.bounds.surface_area() / rootArea;
+        cost += n.is_leaf() ? area * static_cast<float>(n.count) : area * TRAVERSAL_COST;
+    }
+    return cost;
+}
+
+std::size_t Bvh::size() const {
+    return objects.size();
+}
+
+bool Bvh::empty() const {
+    return objects.empty();
+}
+
+const std::vector<BvhNode>& Bvh::get_nodes() const {
+    return nodes;
+}
@@ -0,0 +1,78 @@
+#ifndef BVH_HPP
+#define BVH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../PlutoMath/bounds.hpp"
+#include "../PlutoMath/frustum.hpp"
+#include "../PlutoMath/vec3.hpp"
+#include "../util/job_system.hpp"
+
+// Interior nodes keep their two children next to each other at first and first + 1,
+// leaves own count entries starting at first in the tree's object order.
+struct BvhNode {
+    plutom::aabbf bounds;
+    std::uint32_t first = 0;
+    std::uint32_t count = 0;
+
+    bool is_leaf() const {
+        return count > 0;
+    }
+};
+
+struct BvhHit {
+    std::uint32_t object = ~0u;
+    float distance = 0.0f;
+
+    bool valid() const {
+        return object != ~0u;
+    }
+};
+
+// Bounding volume hierarchy over a fixed set of boxes, objects are identified by their index
+// in the array passed to build(). Built top down with binned SAH; moving objects are handled by
+// refit(), which keeps the topology and only grows or shrinks node bounds, so the tree degrades
+// as objects move apart and should be rebuilt once sah_cost() drifts too far.
+// Given a JobSystem, the upper levels of build(), refit() and cull() run as jobs on it.
+class Bvh {
+public:
+    void build(const plutom::aabbf* bounds, std::size_t count, JobSystem* jobs = nullptr);
+    // bounds holds the new box of every object, in the indexing used for build()
+    void refit(const plutom::aabbf* bounds, JobSystem* jobs = nullptr);
+    void clear();
+
+    // Appends every object whose box intersects the frustum. Subtrees fully inside are
+    // emitted without testing their boxes. The order does not depend on jobs.
+    void cull(const plutom::frustumf& frustum, std::vector<std::uint32_t>& visible, JobSystem* jobs = nullptr) const;
+    // Nearest object box hit along the ray within maxDistance, distance is 0 if origin is inside.
+    // direction does not need to be normalized, distances are in units of its length.
+    BvhHit raycast(const plutom::vec3f& origin, const plutom::vec3f& direction, float maxDistance) const;
+    // Appends every object whose box overlaps region
+    void query(const plutom::aabbf& region, std::vector<std::uint32_t>& found) const;
+
+    // Expected cost of a random ray relative to testing the root, lower is better
+    float sah_cost() const;
+    std::size_t size() const;
+    bool empty() const;
+    const std::vector<BvhNode>& get_nodes() const;
+
+    static constexpr std::uint32_t MAX_LEAF_SIZE = 8;
+
+private:
+    std::vector<BvhNode> nodes;
+    // Object index and box per leaf entry, leaves index these ranges
+    std::vector<std::uint32_t> objects;
+    std::vector<plutom::aabbf> objectBounds;
+    unsigned int parallelDepth = 0;
+
+    struct BuildContext;
+    void build_node(BuildContext& ctx, std::uint32_t node, std::uint32_t begin, std::uint32_t end, unsigned int depth);
+    void refit_node(const plutom::aabbf* bounds, JobSystem* jobs, std::uint32_t node, unsigned int depth);
+    void cull_node(const plutom::frustumf& frustum, std::uint32_t node, std::uint32_t mask,
+                   std::vector<std::uint32_t>& visible) const;
+    void append_subtree(std::uint32_t node, std::vector<std::uint32_t>& out) const;
+};
+
+#endif //BVH_HPP
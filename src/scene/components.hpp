@@ -0,0 +1,53 @@
+#ifndef COMPONENTS_HPP
+#define COMPONENTS_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "ecs.hpp"
+#include "mesh_handle.hpp"
+#include "transform_graph.hpp"
+#include "../PlutoMath/vec3.hpp"
+
+// Position, rotation and scale live in the scene's TransformGraph, the component only points
+// at the node
+struct Transform {
+    TransformGraph::node_id node = TransformGraph::NONE;
+};
+
+// Everything the render queue needs to submit a draw
+struct Renderable {
+    MeshHandle mesh;
+    unsigned int program = 0;
+    unsigned int texture = 0;   // MaterialSystem texture id, 0 when untextured
+    std::uint32_t object = ~0u; // BVH object in the scene
+    bool wireframe = false;
+    bool visible = true;
+};
+
+struct Material {
+    plutom::vec3f color{1.0f, 1.0f, 1.0f};
+    float shininess = 32.0f;
+};
+
+// Constant rotation around a fixed axis, angle in degrees
+struct Spin {
+    plutom::vec3f axis{0.0f, 1.0f, 0.0f};
+    float speed = 0.0f;
+    float angle = 0.0f;
+};
+
+// Lights the scene with its Material color from its world position
+struct LightSource {
+    bool animated = false;
+};
+
+// Cold data only read by tools and lookups, kept out of the pools systems iterate
+struct ShapeInfo {
+    std::string type;
+    std::string tag;
+};
+
+using EntityRegistry = Registry<Transform, Renderable, Material, Spin, LightSource, ShapeInfo>;
+
+#endif //COMPONENTS_HPP
@@ -0,0 +1,203 @@
+#ifndef ECS_HPP
+#define ECS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Stable handle to an entity. The index is reused after destroy(), the generation is not,
+// so stale handles stop matching instead of aliasing whatever took the slot.
+struct Entity {
+    std::uint32_t index = ~0u;
+    std::uint32_t generation = 0;
+
+    bool valid() const {
+        return index != ~0u;
+    }
+
+    bool operator==(const Entity& other) const {
+        return index == other.index && generation == other.generation;
+    }
+
+    bool operator!=(const Entity& other) const {
+        return !(*this == other);
+    }
+};
+
+/*  Sparse set of one component type. Components live packed in insertion order in one array,
+    with the owning entity of each in a parallel array, so systems walk data() and entities()
+    linearly. sparse maps an entity index to its packed slot; removal swaps the last component
+    into the hole, which keeps the arrays dense but does not preserve order.
+ */
+template<typename T>
+class ComponentPool {
+public:
+    static constexpr std::uint32_t NONE = ~0u;
+
+    // Replaces the component if the entity already has one
+    T& add(const Entity entity, const T& value) {
+        if (T* existing = find(entity)) return *existing = value;
+        if (entity.index >= sparse.size()) sparse.resize(entity.index + 1, NONE);
+        sparse[entity.index] = static_cast<std::uint32_t>(components.size());
+        owners.push_back(entity);
+        components.push_back(value);
+        return components.back();
+    }
+
+    void remove(const Entity entity) {
+        if (!has(entity)) return;
+        const std::uint32_t slot = sparse[entity.index];
+        const std::uint32_t last = static_cast<std::uint32_t>(components.size() - 1);
+        if (slot != last) {
+            components[slot] = std::move(components[last]);
+            owners[slot] = owners[last];
+            sparse[owners[slot].index] = slot;
+        }
+        components.pop_back();
+        owners.pop_back();
+        sparse[entity.index] = NONE;
+    }
+
+    bool has(const Entity entity) const {
+        return entity.index < sparse.size() && sparse[entity.index] != NONE && owners[sparse[entity.index]] == entity;
+    }
+
+    // The entity must have the component, see find() otherwise
+    T& get(const Entity entity) {
+        return components[sparse[entity.index]];
+    }
+
+    const T& get(const Entity entity) const {
+        return components[sparse[entity.index]];
+    }
+
+    // nullptr if the entity does not have the component
+    T* find(const Entity entity) {
+        return has(entity) ? &components[sparse[entity.index]] : nullptr;
+    }
+
+    const T* find(const Entity entity) const {
+        return has(entity) ? &components[sparse[entity.index]] : nullptr;
+    }
+
+    std::size_t size() const {
+        return components.size();
+    }
+
+    bool empty() const {
+        return components.empty();
+    }
+
+    T* data() {
+        return components.data();
+    }
+
+    const T* data() const {
+        return components.data();
+    }
+
+    // Owner of data()[i]
+    const Entity* entities() const {
+        return owners.data();
+    }
+
+    void clear() {
+        sparse.clear();
+        owners.clear();
+        components.clear();
+    }
+
+private:
+    std::vector<std::uint32_t> sparse;
+    std::vector<Entity> owners;
+    std::vector<T> components;
+};
+
+// Entity allocator plus one ComponentPool per listed component type
+template<typename... Components>
+class Registry {
+public:
+    Entity create() {
+        Entity entity;
+        if (!freeIndices.empty()) {
+            entity.index = freeIndices.back();
+            freeIndices.pop_back();
+        } else {
+            entity.index = static_cast<std::uint32_t>(generations.size());
+            generations.push_back(0);
+        }
+        entity.generation = generations[entity.index];
+        return entity;
+    }
+
+    // Drops every component of the entity, its handle stops being alive()
+    void destroy(const Entity entity) {
+        if (!alive(entity)) return;
+        std::apply([&](auto&... pool) { (pool.remove(entity), ...); }, pools);
+        generations[entity.index] += 1;
+        freeIndices.push_back(entity.index);
+    }
+
+    bool alive(const Entity entity) const {
+        return entity.index < generations.size() && generations[entity.index] == entity.generation;
+    }
+
+    std::size_t size() const {
+        return generations.size() - freeIndices.size();
+    }
+
+    void clear() {
+        generations.clear();
+        freeIndices.clear();
+        std::apply([](auto&... pool) { (pool.clear(), ...); }, pools);
+    }
+
+    template<typename T>
+    ComponentPool<T>& pool() {
+        return std::get<ComponentPool<T>>(pools);
+    }
+
+    template<typename T>
+    const ComponentPool<T>& pool() const {
+        return std::get<ComponentPool<T>>(pools);
+    }
+
+    template<typename T>
+    T& add(const Entity entity, const T& value) {
+        return pool<T>().add(entity, value);
+    }
+
+    template<typename T>
+    void remove(const Entity entity) {
+        pool<T>().remove(entity);
+    }
+
+    template<typename T>
+    bool has(const Entity entity) const {
+        return pool<T>().has(entity);
+    }
+
+    template<typename T>
+    T& get(const Entity entity) {
+        return pool<T>().get(entity);
+    }
+
+    template<typename T>
+    const T& get(const Entity entity) const {
+        return pool<T>().get(entity);
+    }
+
+    template<typename T>
+    T* find(const Entity entity) {
+        return pool<T>().find(entity);
+    }
+
+private:
+    std::vector<std::uint32_t> generations;
+    std::vector<std::uint32_t> freeIndices;
+    std::tuple<ComponentPool<Components>...> pools;
+};
+
+#endif //ECS_HPP
@@ -0,0 +1,18 @@
+#ifndef MESH_HANDLE_HPP
+#define MESH_HANDLE_HPP
+
+// Where a mesh lives inside the renderer's shared geometry arenas. id indexes
+// GeometryRegistry::get_meshes(). Plain data so scene components can hold one without
+// depending on the renderer.
+struct MeshHandle {
+    unsigned int id = ~0u;
+    int baseVertex = 0;
+    unsigned int firstIndex = 0;
+    unsigned int indexCount = 0;
+
+    bool valid() const {
+        return id != ~0u;
+    }
+};
+
+#endif //MESH_HANDLE_HPP
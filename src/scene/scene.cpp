@@ -3,3 +3,125 @@
 //
 
 #include "scene.hpp"
+
+scene::object_id scene::add_object(const plutom::aabbf& bounds, const bool dynamic) {
+    const auto id = static_cast<object_id>(locations.size());
+    partition& part = dynamic ? dynamicObjects : staticObjects;
+    locations.push_back({dynamic, static_cast<std::uint32_t>(part.ids.size())});
+    part.ids.push_back(id);
+    part.bounds.push_back(bounds);
+    part.rebuild = true;
+    return id;
+}
+
+void scene::set_bounds(const object_id id, const plutom::aabbf& bounds) {
+    partition& part = partition_of(id);
+    part.bounds[locations[id].slot] = bounds;
+    if (locations[id].dynamic) part.refit = true;
+    else part.rebuild = true;
+}
+
+const plutom::aabbf& scene::get_bounds(const object_id id) const {
+    return partition_of(id).bounds[locations[id].slot];
+}
+
+bool scene::is_dynamic(const object_id id) const {
+    return locations[id].dynamic;
+}
+
+std::size_t scene::size() const {
+    return locations.size();
+}
+
+void scene::clear() {
+    entities.clear();
+    transforms.clear();
+    staticObjects = partition{};
+    dynamicObjects = partition{};
+    locations.clear();
+}
+
+void scene::update(JobSystem* jobs) {
+    update_partition(staticObjects, jobs);
+    update_partition(dynamicObjects, jobs);
+}
+
+void scene::update_partition(partition& part, JobSystem* jobs) {
+    if (part.refit && !part.rebuild) {
+        part.tree.refit(part.bounds.data(), jobs);
+        // Refitting never changes which objects share a node, once boxes have moved far
+        // enough for that to hurt a fresh build is cheaper than the extra traversal
+        if (part.tree.sah_cost() > part.builtCost * REBUILD_RATIO) part.rebuild = true;
+    }
+    if (part.rebuild) {
+        part.tree.build(part.bounds.data(), part.bounds.size(), jobs);
+        part.builtCost = part.tree.sah_cost();
+    }
+    part.rebuild = false;
+    part.refit = false;
+}
+
+void scene::append_ids(const partition& part, std::vector<object_id>& out, const std::size_t from) {
+    // The trees report slots in their partition, translate them back to object ids
+    for (std::size_t k = from; k < out.size(); ++k) out[k] = part.ids[out[k]];
+}
+
+void scene::cull(const plutom::frustumf& frustum, std::vector<object_id>& visible, JobSystem* jobs) const {
+    std::size_t from = visible.size();
+    staticObjects.tree.cull(frustum, visible, jobs);
+    append_ids(staticObjects, visible, from);
+    from = visible.size();
+    dynamicObjects.tree.cull(frustum, visible, jobs);
+    append_ids(dynamicObjects, visible, from);
+}
+
+scene::hit scene::pick(const plutom::vec3f& origin, const plutom::vec3f& direction, const float maxDistance) const {
+    hit result;
+    const BvhHit first = staticObjects.tree.raycast(origin, direction, maxDistance);
+    if (first.valid()) result = {staticObjects.ids[first.object], first.distance};
+    const BvhHit second = dynamicObjects.tree.raycast(origin, direction, first.valid() ? first.distance : maxDistance);
+    if (second.valid() && (!result.valid() || second.distance < result.distance))
+        result = {dynamicObjects.ids[second.object], second.distance};
+    return result;
+}
+
+void scene::query(const plutom::aabbf& region, std::vector<object_id>& found) const {
+    std::size_t from = found.size();
+    staticObjects.tree.query(region, found);
+    append_ids(staticObjects, found, from);
+    from = found.size();
+    dynamicObjects.tree.query(region, found);
+    append_ids(dynamicObjects, found, from);
+}
+
+EntityRegistry& scene::get_entities() {
+    return entities;
+}
+
+const EntityRegistry& scene::get_entities() const {
+    return entities;
+}
+
+TransformGraph& scene::get_transforms() {
+    return transforms;
+}
+
+const TransformGraph& scene::get_transforms() const {
+    return transforms;
+}
+
+const Bvh& scene::get_static_tree() const {
+    return staticObjects.tree;
+}
+
+const Bvh& scene::get_dynamic_tree() const {
+    return dynamicObjects.tree;
+}
+
+scene::partition& scene::partition_of(const object_id id) {
+    return locations[id].dynamic ? dynamicObjects : staticObjects;
+}
+
+const scene::partition& scene::partition_of(const object_id id) const {
+    return locations[id].dynamic ? dynamicObjects : staticObjects;
+}
@@ -5,10 +5,91 @@
 #ifndef SCENE_HPP
 #define SCENE_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
 
+#include "bvh.hpp"
+#include "components.hpp"
+#include "transform_graph.hpp"
 
+/*  The entities of the world with their components, the transform hierarchy and the spatial
+    index over every object. Entities reference transform nodes and objects through their
+    Transform and Renderable components.
+
+    The transform hierarchy and the spatial index are kept apart: transform nodes and objects
+    have their own ids and update() only touches the index, callers move world bounds from one
+    to the other after get_transforms().update().
+
+    Objects are boxes with an id; static ones go into a tree that is only rebuilt when one of
+    them changes, dynamic ones into a second tree that is refit every update() and rebuilt once
+    refitting has let its SAH cost drift REBUILD_RATIO past what the last build produced.
+ */
 class scene {
+public:
+    using object_id = std::uint32_t;
+
+    struct hit {
+        object_id object = ~0u;
+        float distance = 0.0f;
+
+        bool valid() const {
+            return object != ~0u;
+        }
+    };
+
+    object_id add_object(const plutom::aabbf& bounds, bool dynamic = false);
+    // Moving a static object rebuilds the static tree on the next update()
+    void set_bounds(object_id id, const plutom::aabbf& bounds);
+    const plutom::aabbf& get_bounds(object_id id) const;
+    bool is_dynamic(object_id id) const;
+    std::size_t size() const;
+    void clear();
+
+    // Brings both trees up to date with the bounds set since the last call, jobs spreads
+    // rebuilds and refits over its threads
+    void update(JobSystem* jobs = nullptr);
+
+    // Queries see the trees as of the last update()
+    void cull(const plutom::frustumf& frustum, std::vector<object_id>& visible, JobSystem* jobs = nullptr) const;
+    hit pick(const plutom::vec3f& origin, const plutom::vec3f& direction,
+             float maxDistance = std::numeric_limits<float>::max()) const;
+    void query(const plutom::aabbf& region, std::vector<object_id>& found) const;
+
+    EntityRegistry& get_entities();
+    const EntityRegistry& get_entities() const;
+    TransformGraph& get_transforms();
+    const TransformGraph& get_transforms() const;
+    const Bvh& get_static_tree() const;
+    const Bvh& get_dynamic_tree() const;
+
+    static constexpr float REBUILD_RATIO = 1.5f;
+
+private:
+    struct partition {
+        Bvh tree;
+        std::vector<object_id> ids;
+        std::vector<plutom::aabbf> bounds;
+        float builtCost = 0.0f;
+        bool rebuild = false;
+        bool refit = false;
+    };
+    struct location {
+        bool dynamic;
+        std::uint32_t slot;
+    };
+
+    EntityRegistry entities;
+    TransformGraph transforms;
+    partition staticObjects;
+    partition dynamicObjects;
+    std::vector<location> locations;
 
+    partition& partition_of(object_id id);
+    const partition& partition_of(object_id id) const;
+    static void update_partition(partition& part, JobSystem* jobs);
+    static void append_ids(const partition& part, std::vector<object_id>& out, std::size_t from);
 };
 
 
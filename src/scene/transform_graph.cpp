@@ -0,0 +1,145 @@
+#include "transform_graph.hpp"
+
+#include <algorithm>
+
+#include "../PlutoMath/transform.hpp"
+
+TransformGraph::node_id TransformGraph::create(const plutom::vec3f& position, const plutom::quatf& rotation,
+                                               const plutom::vec3f& scale, const node_id parent) {
+    const auto count = static_cast<std::uint32_t>(nodeOf.size());
+    const auto node = static_cast<node_id>(slotOf.size());
+    const std::uint32_t parentAt = parent == NONE ? NONE : slotOf[parent];
+    // Children go right after the last slot of their parent's subtree
+    const std::uint32_t slot = parentAt == NONE ? count : parentAt + subtreeSize[parentAt];
+
+    parentSlot.insert(parentSlot.begin() + slot, parentAt);
+    subtreeSize.insert(subtreeSize.begin() + slot, 1u);
+    this->position.insert(this->position.begin() + slot, position);
+    this->rotation.insert(this->rotation.begin() + slot, rotation);
+    this->scale.insert(this->scale.begin() + slot, scale);
+    world.insert(world.begin() + slot, plutom::mat4f::identity());
+    dirty.insert(dirty.begin() + slot, std::uint8_t{0});
+    nodeOf.insert(nodeOf.begin() + slot, node);
+    slotOf.push_back(slot);
+
+    if (slot < count) {
+        // Everything after the new slot moved up by one
+        for (std::uint32_t s = slot + 1; s <= count; ++s) {
+            slotOf[nodeOf[s]] = s;
+            if (parentSlot[s] != NONE && parentSlot[s] >= slot) parentSlot[s] += 1;
+        }
+    }
+    for (std::uint32_t p = parentAt; p != NONE; p = parentSlot[p]) subtreeSize[p] += 1;
+
+    mark_dirty(node);
+    return node;
+}
+
+void TransformGraph::mark_dirty(const node_id node) {
+    const std::uint32_t slot = slotOf[node];
+    if (dirty[slot]) return;
+    dirty[slot] = 1;
+    dirtyNodes.push_back(node);
+}
+
+void TransformGraph::set_position(const node_id node, const plutom::vec3f& position) {
+    this->position[slotOf[node]] = position;
+    mark_dirty(node);
+}
+
+void TransformGraph::set_rotation(const node_id node, const plutom::quatf& rotation) {
+    this->rotation[slotOf[node]] = rotation;
+    mark_dirty(node);
+}
+
+void TransformGraph::set_scale(const node_id node, const plutom::vec3f& scale) {
+    this->scale[slotOf[node]] = scale;
+    mark_dirty(node);
+}
+
+const plutom::vec3f& TransformGraph::get_position(const node_id node) const {
+    return position[slotOf[node]];
+}
+
+const plutom::quatf& TransformGraph::get_rotation(const node_id node) const {
+    return rotation[slotOf[node]];
+}
+
+const plutom::vec3f& TransformGraph::get_scale(const node_id node) const {
+    return scale[slotOf[node]];
+}
+
+TransformGraph::node_id TransformGraph::get_parent(const node_id node) const {
+    const std::uint32_t parent = parentSlot[slotOf[node]];
+    return parent == NONE ? NONE : nodeOf[parent];
+}
+
+const plutom::mat4f& TransformGraph::get_world(const node_id node) const {
+    return world[slotOf[node]];
+}
+
+void TransformGraph::update(JobSystem* jobs) {
+    updated.clear();
+    if (dirtyNodes.empty()) return;
+
+    dirtySlots.clear();
+    for (const auto node : dirtyNodes) dirtySlots.push_back(slotOf[node]);
+    dirtyNodes.clear();
+    std::sort(dirtySlots.begin(), dirtySlots.end());
+
+    // Keep only the outermost dirty slot of each subtree, the ranges left are disjoint
+    std::size_t ranges = 0;
+    std::uint32_t covered = 0;
+    for (const auto first : dirtySlots) {
+        if (first < covered) continue; // inside a subtree that is recomputed anyway
+        dirtySlots[ranges++] = first;
+        covered = first + subtreeSize[first];
+    }
+    dirtySlots.resize(ranges);
+
+    // Each range writes its own stretch of updated, in the same slot order a serial pass would
+    rangeOffsets.resize(ranges + 1);
+    rangeOffsets[0] = 0;
+    for (std::size_t r = 0; r < ranges; ++r) rangeOffsets[r + 1] = rangeOffsets[r] + subtreeSize[dirtySlots[r]];
+    updated.resize(rangeOffsets[ranges]);
+
+    // Parents come first, so by the time a slot is reached its parent's world matrix is current.
+    // Ranges never share a slot, and the parents above a range are clean, so they run in any order.
+    const auto recompute = [this](const std::size_t firstRange, const std::size_t lastRange) {
+        for (std::size_t r = firstRange; r < lastRange; ++r) {
+            const std::uint32_t first = dirtySlots[r];
+            const std::uint32_t last = first + subtreeSize[first];
+            node_id* out = updated.data() + rangeOffsets[r];
+            for (std::uint32_t s = first; s < last; ++s) {
+                const plutom::mat4f local = plutom::transform3D::trs(position[s], rotation[s], scale[s]);
+                world[s] = parentSlot[s] == NONE ? local : world[parentSlot[s]] * local;
+                dirty[s] = 0;
+                *out++ = nodeOf[s];
+            }
+        }
+    };
+    if (jobs) jobs->parallel_for(0, ranges, UPDATE_GRAIN, recompute);
+    else recompute(0, ranges);
+}
+
+const std::vector<TransformGraph::node_id>& TransformGraph::get_updated() const {
+    return updated;
+}
+
+std::size_t TransformGraph::size() const {
+    return nodeOf.size();
+}
+
+void TransformGraph::clear() {
+    parentSlot.clear();
+    subtreeSize.clear();
+    position.clear();
+    rotation.clear();
+    scale.clear();
+    world.clear();
+    dirty.clear();
+    nodeOf.clear();
+    slotOf.clear();
+    dirtyNodes.clear();
+    updated.clear();
+}
@@ -0,0 +1,70 @@
+#ifndef TRANSFORM_GRAPH_HPP
+#define TRANSFORM_GRAPH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../PlutoMath/mat4.hpp"
+#include "../PlutoMath/quat.hpp"
+#include "../PlutoMath/vec3.hpp"
+#include "../util/job_system.hpp"
+
+/*  Parent/child transform hierarchy in flat arrays. Slots are kept in depth-first order, parents
+    before their children and every subtree in one contiguous range [slot, slot + subtreeSize),
+    so update() recomputes each dirty subtree in a single linear pass. Nodes that were not
+    touched since the last update() cost nothing.
+    Node ids are stable, slots move when a child is inserted in the middle of the arrays.
+ */
+class TransformGraph {
+public:
+    using node_id = std::uint32_t;
+    static constexpr node_id NONE = ~0u;
+    // Dirty subtrees per job in update()
+    static constexpr std::size_t UPDATE_GRAIN = 256;
+
+    // Local transform is relative to parent, or to the world for roots
+    node_id create(const plutom::vec3f& position, const plutom::quatf& rotation, const plutom::vec3f& scale,
+                   node_id parent = NONE);
+
+    void set_position(node_id node, const plutom::vec3f& position);
+    void set_rotation(node_id node, const plutom::quatf& rotation);
+    void set_scale(node_id node, const plutom::vec3f& scale);
+    const plutom::vec3f& get_position(node_id node) const;
+    const plutom::quatf& get_rotation(node_id node) const;
+    const plutom::vec3f& get_scale(node_id node) const;
+    node_id get_parent(node_id node) const;
+    // As of the last update()
+    const plutom::mat4f& get_world(node_id node) const;
+
+    // Recomputes the world matrix of every dirty node and everything below it. With jobs, the
+    // separate dirty subtrees are spread over its threads; one deep subtree still runs serially.
+    void update(JobSystem* jobs = nullptr);
+    // Nodes whose world matrix changed in the last update(), in slot order
+    const std::vector<node_id>& get_updated() const;
+    std::size_t size() const;
+    void clear();
+
+private:
+    // Per slot
+    std::vector<std::uint32_t> parentSlot;
+    std::vector<std::uint32_t> subtreeSize;
+    std::vector<plutom::vec3f> position;
+    std::vector<plutom::quatf> rotation;
+    std::vector<plutom::vec3f> scale;
+    std::vector<plutom::mat4f> world;
+    std::vector<std::uint8_t> dirty;
+    std::vector<node_id> nodeOf;
+
+    // Per node
+    std::vector<std::uint32_t> slotOf;
+
+    std::vector<node_id> dirtyNodes;
+    std::vector<std::uint32_t> dirtySlots;
+    std::vector<std::size_t> rangeOffsets;
+    std::vector<node_id> updated;
+
+    void mark_dirty(node_id node);
+};
+
+#endif //TRANSFORM_GRAPH_HPP
@@ -0,0 +1,291 @@
+#include "block_codec.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    struct Color {
+        float r, g, b;
+    };
+
+    std::uint16_t pack_565(const Color& c) {
+        const auto r = static_cast<std::uint16_t>(std::clamp(std::lround(c.r * 31.0f / 255.0f), 0L, 31L));
+        const auto g = static_cast<std::uint16_t>(std::clamp(std::lround(c.g * 63.0f / 255.0f), 0L, 63L));
+        const auto b = static_cast<std::uint16_t>(std::clamp(std::lround(c.b * 31.0f / 255.0f), 0L, 31L));
+        return static_cast<std::uint16_t>(r << 11 | g << 5 | b);
+    }
+
+    void unpack_565(const std::uint16_t packed, std::uint8_t out[3]) {
+        const unsigned r = packed >> 11 & 0x1F, g = packed >> 5 & 0x3F, b = packed & 0x1F;
+        out[0] = static_cast<std::uint8_t>(r << 3 | r >> 2);
+        out[1] = static_cast<std::uint8_t>(g << 2 | g >> 4);
+        out[2] = static_cast<std::uint8_t>(b << 3 | b >> 2);
+    }
+
+    // The four colors a decoder derives from two endpoints, alpha 0 marks BC1's transparent black
+    void color_palette(const std::uint16_t c0, const std::uint16_t c1, const bool fourColors, std::uint8_t palette[4][4]) {
+        unpack_565(c0, palette[0]);
+        unpack_565(c1, palette[1]);
+        for (int i = 0; i < 3; ++i) {
+            if (fourColors) {
+                palette[2][i] = static_cast<std::uint8_t>((2 * palette[0][i] + palette[1][i]) / 3);
+                palette[3][i] = static_cast<std::uint8_t>((palette[0][i] + 2 * palette[1][i]) / 3);
+            } else {
+                palette[2][i] = static_cast<std::uint8_t>((palette[0][i] + palette[1][i]) / 2);
+                palette[3][i] = 0;
+            }
+        }
+        palette[0][3] = palette[1][3] = palette[2][3] = 255;
+        palette[3][3] = fourColors ? 255 : 0;
+    }
+
+    std::uint16_t read_16(const std::uint8_t* p) {
+        return static_cast<std::uint16_t>(p[0] | p[1] << 8);
+    }
+
+    void write_16(std::uint8_t* p, const std::uint16_t value) {
+        p[0] = static_cast<std::uint8_t>(value);
+        p[1] = static_cast<std::uint8_t>(value >> 8);
+    }
+
+    // Picks the nearest palette entry for every texel, returns the indices and the squared error
+    std::uint32_t assign_indices(const std::uint8_t pixels[64], const std::uint8_t palette[4][4], float& error) {
+        std::uint32_t indices = 0;
+        error = 0.0f;
+        for (int i = 0; i < 16; ++i) {
+            int best = 0;
+            int bestDistance = 1 << 30;
+            for (int p = 0; p < 4; ++p) {
+                const int dr = pixels[i * 4] - palette[p][0];
+                const int dg = pixels[i * 4 + 1] - palette[p][1];
+                const int db = pixels[i * 4 + 2] - palette[p][2];
+                const int distance = dr * dr + dg * dg + db * db;
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+            indices |= static_cast<std::uint32_t>(best) << (2 * i);
+            error += static_cast<float>(bestDistance);
+        }
+        return indices;
+    }
+
+    // Endpoints in four color mode (c0 > c1) with their indices, or a solid block if they meet
+    float encode_endpoints(const std::uint8_t pixels[64], const Color& a, const Color& b, std::uint8_t* out) {
+        std::uint16_t c0 = pack_565(a), c1 = pack_565(b);
+        if (c0 < c1) std::swap(c0, c1);
+        std::uint8_t palette[4][4];
+        color_palette(c0, c1, true, palette);
+        // Equal endpoints make every entry the same color, so all indices stay 0, which also reads
+        // right in the three color mode the decoder switches to then
+        float error = 0.0f;
+        const std::uint32_t indices = assign_indices(pixels, palette, error);
+        write_16(out, c0);
+        write_16(out + 2, c1);
+        for (int i = 0; i < 4; ++i) out[4 + i] = static_cast<std::uint8_t>(indices >> (8 * i));
+        return error;
+    }
+
+    void encode_color(const std::uint8_t pixels[64], std::uint8_t* out) {
+        Color mean{0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < 16; ++i) {
+            mean.r += pixels[i * 4];
+            mean.g += pixels[i * 4 + 1];
+            mean.b += pixels[i * 4 + 2];
+        }
+        mean = {mean.r / 16.0f, mean.g / 16.0f, mean.b / 16.0f};
+
+        float cov[6] = {};
+        for (int i = 0; i < 16; ++i) {
+            const float r = pixels[i * 4] - mean.r, g = pixels[i * 4 + 1] - mean.g, b = pixels[i * 4 + 2] - mean.b;
+            cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+            cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+        }
+        // Principal axis by power iteration, starting from the luminance direction
+        Color axis{0.299f, 0.587f, 0.114f};
+        for (int iteration = 0; iteration < 8; ++iteration) {
+            const Color next{cov[0] * axis.r + cov[1] * axis.g + cov[2] * axis.b,
+                             cov[1] * axis.r + cov[3] * axis.g + cov[4] * axis.b,
+                             cov[2] * axis.r + cov[4] * axis.g + cov[5] * axis.b};
+            const float length = std::max({std::fabs(next.r), std::fabs(next.g), std::fabs(next.b)});
+            if (length < 1e-6f) break;
+            axis = {next.r / length, next.g / length, next.b / length};
+        }
+
+        float low = 1e30f, high = -1e30f;
+        for (int i = 0; i < 16; ++i) {
+            const float t = (pixels[i * 4] - mean.r) * axis.r + (pixels[i * 4 + 1] - mean.g) * axis.g +
+                            (pixels[i * 4 + 2] - mean.b) * axis.b;
+            low = std::min(low, t);
+            high = std::max(high, t);
+        }
+        const float norm = axis.r * axis.r + axis.g * axis.g + axis.b * axis.b;
+        const auto at = [&](const float t) {
+            const float s = norm > 0.0f ? t / norm : 0.0f;
+            return Color{std::clamp(mean.r + axis.r * s, 0.0f, 255.0f), std::clamp(mean.g + axis.g * s, 0.0f, 255.0f),
+                         std::clamp(mean.b + axis.b * s, 0.0f, 255.0f)};
+        };
+        // Inset a little, the extremes are rarely worth a whole endpoint
+        const float inset = (high - low) / 16.0f;
+        const float error = encode_endpoints(pixels, at(high - inset), at(low + inset), out);
+
+        // Least squares endpoints for the chosen indices, kept if they do better
+        const std::uint32_t indices = out[4] | out[5] << 8 | out[6] << 16 | static_cast<std::uint32_t>(out[7]) << 24;
+        constexpr float weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+        float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+        Color ax{0.0f, 0.0f, 0.0f}, bx{0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < 16; ++i) {
+            const float w = weights[indices >> (2 * i) & 3], v = 1.0f - w;
+            aa += w * w; bb += v * v; ab += w * v;
+            ax = {ax.r + w * pixels[i * 4], ax.g + w * pixels[i * 4 + 1], ax.b + w * pixels[i * 4 + 2]};
+            bx = {bx.r + v * pixels[i * 4], bx.g + v * pixels[i * 4 + 1], bx.b + v * pixels[i * 4 + 2]};
+        }
+        const float det = aa * bb - ab * ab;
+        if (std::fabs(det) < 1e-6f) return;
+        const auto solve = [&](const float x, const float y, const bool first) {
+            return std::clamp(first ? (x * bb - y * ab) / det : (y * aa - x * ab) / det, 0.0f, 255.0f);
+        };
+        const Color a{solve(ax.r, bx.r, true), solve(ax.g, bx.g, true), solve(ax.b, bx.b, true)};
+        const Color b{solve(ax.r, bx.r, false), solve(ax.g, bx.g, false), solve(ax.b, bx.b, false)};
+        std::uint8_t refined[8];
+        if (encode_endpoints(pixels, a, b, refined) < error) std::memcpy(out, refined, 8);
+    }
+
+    void encode_alpha(const std::uint8_t pixels[64], std::uint8_t* out) {
+        std::uint8_t low = 255, high = 0;
+        for (int i = 0; i < 16; ++i) {
+            low = std::min(low, pixels[i * 4 + 3]);
+            high = std::max(high, pixels[i * 4 + 3]);
+        }
+        out[0] = high;
+        out[1] = low;
+        std::uint64_t indices = 0;
+        if (high != low) {
+            // Eight value mode, entries 2..7 step from high down to low
+            int palette[8] = {high, low};
+            for (int i = 1; i < 7; ++i) palette[i + 1] = ((7 - i) * high + i * low) / 7;
+            for (int i = 0; i < 16; ++i) {
+                int best = 0;
+                for (int p = 1; p < 8; ++p) {
+                    if (std::abs(pixels[i * 4 + 3] - palette[p]) < std::abs(pixels[i * 4 + 3] - palette[best])) best = p;
+                }
+                indices |= static_cast<std::uint64_t>(best) << (3 * i);
+            }
+        }
+        for (int i = 0; i < 6; ++i) out[2 + i] = static_cast<std::uint8_t>(indices >> (8 * i));
+    }
+
+    void decode_alpha(const std::uint8_t* block, std::uint8_t pixels[64]) {
+        const int a0 = block[0], a1 = block[1];
+        int palette[8] = {a0, a1};
+        if (a0 > a1) {
+            for (int i = 1; i < 7; ++i) palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+        } else {
+            for (int i = 1; i < 5; ++i) palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+        std::uint64_t indices = 0;
+        for (int i = 0; i < 6; ++i) indices |= static_cast<std::uint64_t>(block[2 + i]) << (8 * i);
+        for (int i = 0; i < 16; ++i) pixels[i * 4 + 3] = static_cast<std::uint8_t>(palette[indices >> (3 * i) & 7]);
+    }
+
+    void decode_color(const std::uint8_t* block, const bool alwaysFourColors, std::uint8_t pixels[64]) {
+        const std::uint16_t c0 = read_16(block), c1 = read_16(block + 2);
+        std::uint8_t palette[4][4];
+        color_palette(c0, c1, alwaysFourColors || c0 > c1, palette);
+        for (int i = 0; i < 16; ++i) {
+            const int index = block[4 + i / 4] >> (2 * (i % 4)) & 3;
+            std::memcpy(pixels + i * 4, palette[index], 4);
+        }
+    }
+}
+
+std::size_t block_codec::block_bytes(const BlockFormat format) {
+    return format == BlockFormat::BC1 ? 8 : 16;
+}
+
+std::size_t block_codec::compressed_size(const BlockFormat format, const int width, const int height) {
+    return static_cast<std::size_t>((width + 3) / 4) * static_cast<std::size_t>((height + 3) / 4) * block_bytes(format);
+}
+
+void block_codec::encode_block(const BlockFormat format, const std::uint8_t pixels[64], std::uint8_t* out) {
+    if (format == BlockFormat::BC3) {
+        encode_alpha(pixels, out);
+        out += 8;
+    }
+    encode_color(pixels, out);
+}
+
+void block_codec::decode_block(const BlockFormat format, const std::uint8_t* block, std::uint8_t pixels[64]) {
+    if (format == BlockFormat::BC3) {
+        decode_color(block + 8, true, pixels);
+        decode_alpha(block, pixels);
+    } else {
+        decode_color(block, false, pixels);
+    }
+}
+
+std::vector<std::uint8_t> block_codec::compress(const BlockFormat format, const std::uint8_t* rgba, const int width, const int height) {
+    std::vector<std::uint8_t> out(compressed_size(format, width, height));
+    std::uint8_t* block = out.data();
+    std::uint8_t pixels[64];
+    for (int by = 0; by < height; by += 4) {
+        for (int bx = 0; bx < width; bx += 4) {
+            for (int i = 0; i < 16; ++i) {
+                const int x = std::min(bx + i % 4, width - 1), y = std::min(by + i / 4, height - 1);
+                std::memcpy(pixels + i * 4, rgba + (static_cast<std::size_t>(y) * width + x) * 4, 4);
+            }
+            encode_block(format, pixels, block);
+            block += block_bytes(format);
+        }
+    }
+    return out;
+}
+
+std::vector<std::uint8_t> block_codec::decompress(const BlockFormat format, const std::uint8_t* blocks, const int width, const int height) {
+    std::vector<std::uint8_t> out(static_cast<std::size_t>(width) * height * 4);
+    std::uint8_t pixels[64];
+    for (int by = 0; by < height; by += 4) {
+        for (int bx = 0; bx < width; bx += 4) {
+            decode_block(format, blocks, pixels);
+            blocks += block_bytes(format);
+            for (int i = 0; i < 16; ++i) {
+                const int x = bx + i % 4, y = by + i / 4;
+                if (x < width && y < height) std::memcpy(out.data() + (static_cast<std::size_t>(y) * width + x) * 4, pixels + i * 4, 4);
+            }
+        }
+    }
+    return out;
+}
+
+std::vector<std::uint8_t> block_codec::downsample(const std::uint8_t* rgba, const int width, const int height) {
+    const int w = std::max(width / 2, 1), h = std::max(height / 2, 1);
+    std::vector<std::uint8_t> out(static_cast<std::size_t>(w) * h * 4);
+    for (int y = 0; y < h; ++y) {
+        const int y0 = std::min(2 * y, height - 1), y1 = std::min(2 * y + 1, height - 1);
+        for (int x = 0; x < w; ++x) {
+            const int x0 = std::min(2 * x, width - 1), x1 = std::min(2 * x + 1, width - 1);
+            for (int c = 0; c < 4; ++c) {
+                const int sum = rgba[(static_cast<std::size_t>(y0) * width + x0) * 4 + c] +
+                                rgba[(static_cast<std::size_t>(y0) * width + x1) * 4 + c] +
+                                rgba[(static_cast<std::size_t>(y1) * width + x0) * 4 + c] +
+                                rgba[(static_cast<std::size_t>(y1) * width + x1) * 4 + c];
+                out[(static_cast<std::size_t>(y) * w + x) * 4 + c] = static_cast<std::uint8_t>((sum + 2) / 4);
+            }
+        }
+    }
+    return out;
+}
+
+int block_codec::mip_count(int width, int height) {
+    int count = 1;
+    while (width > 1 || height > 1) {
+        width = std::max(width / 2, 1);
+        height = std::max(height / 2, 1);
+        count += 1;
+    }
+    return count;
+}
@@ -0,0 +1,38 @@
+#ifndef BLOCK_CODEC_HPP
+#define BLOCK_CODEC_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Block compressed formats the engine reads, numbered as in the .ptex header
+enum class BlockFormat : std::uint32_t {
+    BC1 = 1,  // DXT1, RGB at 4 bits per pixel, alpha dropped
+    BC3 = 3   // DXT5, RGBA at 8 bits per pixel
+};
+
+/*  CPU side of BC1/BC3 (S3TC). Encoding is done offline by pluto_cook: endpoints start on the
+    principal axis of the block's colors and get one least squares refinement, which is close to
+    what the slow, thorough encoders reach for a fraction of the time. Decoding is for drivers
+    without S3TC and for checking the cooker's output.
+    Images are RGBA8, blocks are stored row by row; edge blocks of sizes that are not a multiple of
+    4 repeat the last row and column.
+ */
+class block_codec {
+public:
+    static std::size_t block_bytes(BlockFormat format);
+    static std::size_t compressed_size(BlockFormat format, int width, int height);
+
+    // pixels are the 16 texels of one block, RGBA row by row
+    static void encode_block(BlockFormat format, const std::uint8_t pixels[64], std::uint8_t* out);
+    static void decode_block(BlockFormat format, const std::uint8_t* block, std::uint8_t pixels[64]);
+
+    static std::vector<std::uint8_t> compress(BlockFormat format, const std::uint8_t* rgba, int width, int height);
+    static std::vector<std::uint8_t> decompress(BlockFormat format, const std::uint8_t* blocks, int width, int height);
+
+    // Next mip level, a 2x2 box filter that halves each side (down to 1)
+    static std::vector<std::uint8_t> downsample(const std::uint8_t* rgba, int width, int height);
+    static int mip_count(int width, int height);
+};
+
+#endif //BLOCK_CODEC_HPP
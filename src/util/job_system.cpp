@@ -0,0 +1,136 @@
+#include "job_system.hpp"
+
+#include <string>
+
+#include "profiler.hpp"
+
+namespace {
+    // Which queue the current thread owns, only meaningful while owner matches
+    thread_local const JobSystem* owner = nullptr;
+    thread_local unsigned int ownIndex = 0;
+}
+
+JobSystem::JobSystem(unsigned int threadCount) {
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned int i = 0; i < threadCount; ++i) queues.push_back(std::make_unique<Queue>());
+    owner = this;
+    ownIndex = 0;
+    for (unsigned int i = 1; i < threadCount; ++i) workers.emplace_back([this, i] { worker_loop(i); });
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        running.store(false);
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+    if (owner == this) owner = nullptr;
+}
+
+unsigned int JobSystem::get_thread_count() const {
+    return static_cast<unsigned int>(queues.size());
+}
+
+unsigned int JobSystem::current_queue() const {
+    // Threads the system does not own share the first queue with the constructing thread
+    return owner == this ? ownIndex : 0;
+}
+
+void JobSystem::run(Job job, JobCounter* counter) {
+    if (counter) counter->pending.fetch_add(1, std::memory_order_relaxed);
+    push({std::move(job), counter});
+}
+
+void JobSystem::run_after(JobCounter& dependency, Job job, JobCounter* counter) {
+    if (counter) counter->pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        // finish() drains the continuations under the same lock after the count hits zero,
+        // so either it sees this one or the check below does
+        std::lock_guard<std::mutex> lock(dependency.mutex);
+        if (!dependency.done()) {
+            dependency.continuations.push_back({std::move(job), counter});
+            return;
+        }
+    }
+    push({std::move(job), counter});
+}
+
+void JobSystem::wait(const JobCounter& counter) {
+    const unsigned int self = current_queue();
+    while (!counter.done()) {
+        if (!try_run_one(self)) std::this_thread::yield();
+    }
+    // The last finish() may still hold the lock
+    std::lock_guard<std::mutex> lock(counter.mutex);
+}
+
+void JobSystem::push(Task task) {
+    Queue& queue = *queues[current_queue()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    queued.fetch_add(1, std::memory_order_release);
+    {
+        // Pairs with the predicate check in worker_loop so the wake up cannot be missed
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wake.notify_one();
+}
+
+bool JobSystem::try_run_one(const unsigned int self) {
+    Task task;
+    bool found = false;
+    {
+        Queue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            found = true;
+        }
+    }
+    const auto count = static_cast<unsigned int>(queues.size());
+    for (unsigned int i = 1; i < count && !found; ++i) {
+        Queue& victim = *queues[(self + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            found = true;
+        }
+    }
+    if (!found) return false;
+
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    {
+        PLUTO_PROFILE_SCOPE("job");
+        task.job();
+    }
+    finish(task.counter);
+    return true;
+}
+
+void JobSystem::finish(JobCounter* counter) {
+    if (!counter) return;
+    std::vector<JobCounter::Continuation> ready;
+    {
+        // The count drops under the lock so a waiter that saw zero can only destroy the
+        // counter after this block is done with it, see wait()
+        std::lock_guard<std::mutex> lock(counter->mutex);
+        if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) ready.swap(counter->continuations);
+    }
+    for (auto& next : ready) push({std::move(next.job), next.counter});
+}
+
+void JobSystem::worker_loop(const unsigned int index) {
+    owner = this;
+    ownIndex = index;
+    PLUTO_PROFILE_THREAD("Job worker " + std::to_string(index));
+    while (running.load()) {
+        if (try_run_one(index)) continue;
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this] { return queued.load(std::memory_order_acquire) > 0 || !running.load(); });
+    }
+}
@@ -0,0 +1,114 @@
+#ifndef JOB_SYSTEM_HPP
+#define JOB_SYSTEM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+
+// Counts unfinished jobs. Jobs started with run(..., &counter) bump it and drop it again when
+// they return; wait() and run_after() block on it reaching zero. A counter can be reused once
+// it is done. It must outlive every job and continuation attached to it, and only a return
+// from JobSystem::wait() (not done()) guarantees nothing touches it any more.
+class JobCounter {
+public:
+    bool done() const {
+        return pending.load(std::memory_order_acquire) == 0;
+    }
+
+private:
+    friend class JobSystem;
+    struct Continuation {
+        std::function<void()> job;
+        JobCounter* counter;
+    };
+    std::atomic<int> pending{0};
+    mutable std::mutex mutex;
+    std::vector<Continuation> continuations;
+};
+
+/*  Work-stealing scheduler over a fixed set of threads, the constructing thread included.
+    Every thread owns a deque: it pushes and pops its own work at the back, idle threads steal
+    from the front of the others. There are no fibers, a thread blocked in wait() keeps running
+    queued jobs until its counter drops to zero, so jobs may wait on jobs they spawned.
+    Jobs must not touch GL, the context stays on the thread that created it.
+    Threads the system does not own share the first queue and run any job while they wait, so
+    a second thread that submits work of its own should construct a JobSystem of its own.
+ */
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+
+    // threadCount includes the calling thread, 0 picks one per hardware thread
+    explicit JobSystem(unsigned int threadCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    void run(Job job, JobCounter* counter = nullptr);
+    // Queues job once dependency is done, right away if it already is
+    void run_after(JobCounter& dependency, Job job, JobCounter* counter = nullptr);
+    void wait(const JobCounter& counter);
+
+    // Calls fn(first, last) over disjoint chunks covering [begin, end), at least grain items each,
+    // and returns once all of them have. The calling thread takes the first chunk.
+    template<typename Fn>
+    void parallel_for(std::size_t begin, std::size_t end, std::size_t grain, Fn&& fn);
+
+    unsigned int get_thread_count() const;
+
+private:
+    struct Task {
+        Job job;
+        JobCounter* counter;
+    };
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<bool> running{true};
+    std::atomic<int> queued{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+
+    unsigned int current_queue() const;
+    void push(Task task);
+    bool try_run_one(unsigned int self);
+    void finish(JobCounter* counter);
+    void worker_loop(unsigned int index);
+};
+
+template<typename Fn>
+void JobSystem::parallel_for(const std::size_t begin, const std::size_t end, std::size_t grain, Fn&& fn) {
+    if (begin >= end) return;
+    grain = std::max<std::size_t>(grain, 1);
+    const std::size_t count = end - begin;
+    if (queues.size() == 1 || count <= grain) {
+        fn(begin, end);
+        return;
+    }
+    // A few chunks per thread so stealing can even out uneven ones
+    const std::size_t chunks = std::min((count + grain - 1) / grain, static_cast<std::size_t>(queues.size()) * 4);
+    const std::size_t step = (count + chunks - 1) / chunks;
+    JobCounter counter;
+    for (std::size_t first = begin + step; first < end; first += step) {
+        const std::size_t last = std::min(first + step, end);
+        run([&fn, first, last] { fn(first, last); }, &counter);
+    }
+    fn(begin, std::min(begin + step, end));
+    wait(counter);
+}
+
+#endif //JOB_SYSTEM_HPP
@@ -0,0 +1,116 @@
+#include "mapped_file.hpp"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path) {
+#ifdef _WIN32
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                       FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        file = nullptr;
+        return;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        close();
+        return;
+    }
+    section = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!section) {
+        close();
+        return;
+    }
+    mapping = static_cast<const std::uint8_t*>(MapViewOfFile(section, FILE_MAP_READ, 0, 0, 0));
+    if (!mapping) {
+        close();
+        return;
+    }
+    length = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat info{};
+    if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* address = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            mapping = static_cast<const std::uint8_t*>(address);
+            length = static_cast<std::size_t>(info.st_size);
+        }
+    }
+    // The mapping keeps the file alive on its own
+    ::close(fd);
+#endif
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        mapping = std::exchange(other.mapping, nullptr);
+        length = std::exchange(other.length, 0);
+#ifdef _WIN32
+        file = std::exchange(other.file, nullptr);
+        section = std::exchange(other.section, nullptr);
+#endif
+    }
+    return *this;
+}
+
+bool MappedFile::is_open() const {
+    return mapping != nullptr;
+}
+
+const std::uint8_t* MappedFile::data() const {
+    return mapping;
+}
+
+std::size_t MappedFile::size() const {
+    return length;
+}
+
+void MappedFile::prefetch() const {
+    if (!mapping) return;
+#ifdef _WIN32
+    WIN32_MEMORY_RANGE_ENTRY range{const_cast<std::uint8_t*>(mapping), length};
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+    ::madvise(const_cast<std::uint8_t*>(mapping), length, MADV_WILLNEED);
+#endif
+    // The advice only starts the reads, touching a byte of every page waits for them
+    std::uint8_t touched = 0;
+    for (std::size_t offset = 0; offset < length; offset += 4096) touched ^= mapping[offset];
+    volatile std::uint8_t sink = touched;
+    static_cast<void>(sink);
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (mapping) UnmapViewOfFile(mapping);
+    if (section) CloseHandle(section);
+    if (file) CloseHandle(file);
+    file = nullptr;
+    section = nullptr;
+#else
+    if (mapping) ::munmap(const_cast<std::uint8_t*>(mapping), length);
+#endif
+    mapping = nullptr;
+    length = 0;
+}
@@ -0,0 +1,38 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read only memory mapping of a whole file. Pages come in from the OS cache as they are first
+// touched, so opening is cheap and nothing is copied into the process until it is read.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool is_open() const;
+    const std::uint8_t* data() const;
+    std::size_t size() const;
+    // Reads the whole file in now, so later reads do not fault
+    void prefetch() const;
+
+private:
+    const std::uint8_t* mapping = nullptr;
+    std::size_t length = 0;
+#ifdef _WIN32
+    void* file = nullptr;
+    void* section = nullptr;
+#endif
+
+    void close();
+};
+
+#endif //MAPPED_FILE_HPP
@@ -0,0 +1,307 @@
+#include "mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+    constexpr unsigned int NONE = ~0u;
+
+    // FIFO post-transform cache kept as insertion times: a vertex is cached while fewer than size
+    // others went in after it
+    struct FifoCache {
+        std::vector<unsigned int> added;
+        unsigned int time;
+        unsigned int size;
+
+        FifoCache(const std::size_t vertexCount, const unsigned int size)
+            : added(vertexCount, 0), time(size + 1), size(size) {}
+
+        // True on a miss
+        bool touch(const unsigned int vertex) {
+            if (time - added[vertex] <= size) return false;
+            added[vertex] = time++;
+            return true;
+        }
+
+        void flush() {
+            time += size + 1;
+        }
+    };
+
+    // Triangles using each vertex, a vertex's are triangles[offsets[v]..offsets[v + 1])
+    struct Adjacency {
+        std::vector<unsigned int> offsets;
+        std::vector<unsigned int> triangles;
+
+        Adjacency(const unsigned int* indices, const std::size_t indexCount, const std::size_t vertexCount)
+            : offsets(vertexCount + 1, 0), triangles(indexCount) {
+            for (std::size_t i = 0; i < indexCount; ++i) offsets[indices[i] + 1] += 1;
+            for (std::size_t v = 0; v < vertexCount; ++v) offsets[v + 1] += offsets[v];
+            std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+            for (std::size_t i = 0; i < indexCount; ++i) triangles[cursor[indices[i]]++] = static_cast<unsigned int>(i / 3);
+        }
+    };
+
+    // FNV-1a
+    std::size_t hash_bytes(const std::uint8_t* bytes, const std::size_t size) {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (std::size_t i = 0; i < size; ++i) hash = (hash ^ bytes[i]) * 1099511628211ull;
+        return static_cast<std::size_t>(hash ^ (hash >> 32));
+    }
+
+    struct Position {
+        float x, y, z;
+    };
+
+    Position read_position(const void* vertices, const std::size_t stride, const unsigned int vertex) {
+        Position position;
+        std::memcpy(&position, static_cast<const std::uint8_t*>(vertices) + vertex * stride, sizeof(position));
+        return position;
+    }
+
+    // Twice the area times the unit normal
+    Position triangle_normal(const Position& a, const Position& b, const Position& c) {
+        const Position e1{b.x - a.x, b.y - a.y, b.z - a.z};
+        const Position e2{c.x - a.x, c.y - a.y, c.z - a.z};
+        return {e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x};
+    }
+}
+
+std::size_t mesh_optimizer::weld_vertices(void* vertices, const std::size_t vertexCount, const std::size_t stride,
+                                          unsigned int* indices, const std::size_t indexCount) {
+    auto* bytes = static_cast<std::uint8_t*>(vertices);
+    // Open addressing over the vertex bytes, at most half full
+    std::size_t buckets = 1;
+    while (buckets < vertexCount * 2) buckets *= 2;
+    std::vector<unsigned int> table(buckets, NONE);
+    std::vector<unsigned int> remap(vertexCount);
+    unsigned int unique = 0;
+    for (std::size_t v = 0; v < vertexCount; ++v) {
+        const std::uint8_t* vertex = bytes + v * stride;
+        std::size_t bucket = hash_bytes(vertex, stride) & (buckets - 1);
+        while (table[bucket] != NONE && std::memcmp(bytes + table[bucket] * stride, vertex, stride) != 0)
+            bucket = (bucket + 1) & (buckets - 1);
+        if (table[bucket] == NONE) {
+            table[bucket] = static_cast<unsigned int>(v);
+            remap[v] = unique++;
+        } else {
+            remap[v] = remap[table[bucket]];
+        }
+    }
+    // The table points at the original slots, compact only once it is done with
+    for (std::size_t v = 0, next = 0; v < vertexCount; ++v) {
+        if (remap[v] != next) continue;
+        if (next != v) std::memmove(bytes + next * stride, bytes + v * stride, stride);
+        next += 1;
+    }
+    for (std::size_t i = 0; i < indexCount; ++i) indices[i] = remap[indices[i]];
+    return unique;
+}
+
+void mesh_optimizer::optimize_vertex_cache(unsigned int* indices, const std::size_t indexCount,
+                                           const std::size_t vertexCount, const unsigned int cacheSize,
+                                           std::vector<unsigned int>* clusters) {
+    if (clusters) clusters->clear();
+    if (indexCount == 0) return;
+
+    const Adjacency adjacency(indices, indexCount, vertexCount);
+    std::vector<unsigned int> live(vertexCount);
+    for (std::size_t v = 0; v < vertexCount; ++v) live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+    FifoCache cache(vertexCount, cacheSize);
+    std::vector<std::uint8_t> emitted(indexCount / 3, 0);
+    std::vector<unsigned int> deadEnds;
+    std::vector<unsigned int> candidates;
+    std::vector<unsigned int> output(indexCount);
+    std::size_t written = 0;
+    unsigned int cursor = 0;
+
+    // Most recently used vertex with triangles left, else the next one in index order
+    const auto skip_dead_end = [&]() {
+        while (!deadEnds.empty()) {
+            const unsigned int vertex = deadEnds.back();
+            deadEnds.pop_back();
+            if (live[vertex] > 0) return vertex;
+        }
+        while (cursor < vertexCount && live[cursor] == 0) ++cursor;
+        return cursor < vertexCount ? cursor : NONE;
+    };
+
+    unsigned int fanning = skip_dead_end();
+    if (clusters && fanning != NONE) clusters->push_back(0);
+    while (fanning != NONE) {
+        candidates.clear();
+        for (unsigned int a = adjacency.offsets[fanning]; a < adjacency.offsets[fanning + 1]; ++a) {
+            const unsigned int triangle = adjacency.triangles[a];
+            if (emitted[triangle]) continue;
+            emitted[triangle] = 1;
+            for (int corner = 0; corner < 3; ++corner) {
+                const unsigned int vertex = indices[triangle * 3 + corner];
+                output[written++] = vertex;
+                deadEnds.push_back(vertex);
+                candidates.push_back(vertex);
+                live[vertex] -= 1;
+                cache.touch(vertex);
+            }
+        }
+
+        // Fan next around the vertex that entered the cache longest ago but will still be in it
+        // after its own remaining triangles, so as few as possible of the current ones fall out
+        unsigned int next = NONE;
+        long best = -1;
+        for (const unsigned int vertex : candidates) {
+            if (live[vertex] == 0) continue;
+            const unsigned int age = cache.time - cache.added[vertex];
+            const long priority = age + 2 * live[vertex] <= cacheSize ? static_cast<long>(age) : 0;
+            if (priority > best) {
+                best = priority;
+                next = vertex;
+            }
+        }
+        if (next == NONE) {
+            next = skip_dead_end();
+            if (clusters && next != NONE) clusters->push_back(static_cast<unsigned int>(written / 3));
+        }
+        fanning = next;
+    }
+    std::memcpy(indices, output.data(), indexCount * sizeof(unsigned int));
+}
+
+void mesh_optimizer::optimize_overdraw(unsigned int* indices, const std::size_t indexCount, const void* vertices,
+                                       const std::size_t vertexCount, const std::size_t stride,
+                                       const std::vector<unsigned int>& clusters, const unsigned int cacheSize,
+                                       const float threshold) {
+    const std::size_t triangleCount = indexCount / 3;
+    if (clusters.empty() || triangleCount == 0) return;
+
+    // Tipsify's clusters are split further wherever the cache has warmed up to within threshold of
+    // the cluster's own ACMR, giving finer pieces to sort at little cost in vertex reuse
+    FifoCache cache(vertexCount, cacheSize);
+    const auto misses = [&](const std::size_t triangle) {
+        unsigned int count = 0;
+        for (int corner = 0; corner < 3; ++corner) count += cache.touch(indices[triangle * 3 + corner]) ? 1 : 0;
+        return count;
+    };
+    std::vector<unsigned int> starts;
+    for (std::size_t k = 0; k < clusters.size(); ++k) {
+        const std::size_t begin = clusters[k];
+        const std::size_t end = k + 1 < clusters.size() ? clusters[k + 1] : triangleCount;
+        cache.flush();
+        unsigned int clusterMisses = 0;
+        for (std::size_t t = begin; t < end; ++t) clusterMisses += misses(t);
+        const float limit = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+
+        cache.flush();
+        starts.push_back(static_cast<unsigned int>(begin));
+        unsigned int running = 0, count = 0;
+        for (std::size_t t = begin; t < end; ++t) {
+            running += misses(t);
+            count += 1;
+            if (t + 1 < end && static_cast<float>(running) <= limit * static_cast<float>(count)) {
+                starts.push_back(static_cast<unsigned int>(t + 1));
+                cache.flush();
+                running = count = 0;
+            }
+        }
+    }
+
+    // Clusters facing away from the mesh's center come first: on a roughly convex mesh they are the
+    // ones in front, and whatever they cover fails the depth test instead of being shaded
+    Position center{0.0f, 0.0f, 0.0f};
+    float totalArea = 0.0f;
+    std::vector<Position> centroids(starts.size()), normals(starts.size());
+    for (std::size_t k = 0; k < starts.size(); ++k) {
+        const std::size_t end = k + 1 < starts.size() ? starts[k + 1] : triangleCount;
+        Position centroid{0.0f, 0.0f, 0.0f}, normal{0.0f, 0.0f, 0.0f};
+        float area = 0.0f;
+        for (std::size_t t = starts[k]; t < end; ++t) {
+            const Position a = read_position(vertices, stride, indices[t * 3]);
+            const Position b = read_position(vertices, stride, indices[t * 3 + 1]);
+            const Position c = read_position(vertices, stride, indices[t * 3 + 2]);
+            const Position n = triangle_normal(a, b, c);
+            const float weight = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+            centroid = {centroid.x + (a.x + b.x + c.x) * weight, centroid.y + (a.y + b.y + c.y) * weight,
+                        centroid.z + (a.z + b.z + c.z) * weight};
+            normal = {normal.x + n.x, normal.y + n.y, normal.z + n.z};
+            area += weight;
+        }
+        center = {center.x + centroid.x, center.y + centroid.y, center.z + centroid.z};
+        totalArea += area;
+        const float scale = area > 0.0f ? 1.0f / (3.0f * area) : 0.0f;
+        centroids[k] = {centroid.x * scale, centroid.y * scale, centroid.z * scale};
+        normals[k] = normal;
+    }
+    const float centerScale = totalArea > 0.0f ? 1.0f / (3.0f * totalArea) : 0.0f;
+    center = {center.x * centerScale, center.y * centerScale, center.z * centerScale};
+
+    std::vector<float> keys(starts.size());
+    for (std::size_t k = 0; k < starts.size(); ++k) {
+        const Position& n = normals[k];
+        const float length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+        const Position offset{centroids[k].x - center.x, centroids[k].y - center.y, centroids[k].z - center.z};
+        keys[k] = length > 0.0f ? (offset.x * n.x + offset.y * n.y + offset.z * n.z) / length : 0.0f;
+    }
+    std::vector<unsigned int> order(starts.size());
+    for (std::size_t k = 0; k < order.size(); ++k) order[k] = static_cast<unsigned int>(k);
+    std::stable_sort(order.begin(), order.end(), [&](const unsigned int a, const unsigned int b) {
+        return keys[a] > keys[b];
+    });
+
+    std::vector<unsigned int> output;
+    output.reserve(indexCount);
+    for (const unsigned int k : order) {
+        const std::size_t end = k + 1 < starts.size() ? starts[k + 1] : triangleCount;
+        output.insert(output.end(), indices + starts[k] * 3, indices + end * 3);
+    }
+    std::memcpy(indices, output.data(), output.size() * sizeof(unsigned int));
+}
+
+std::size_t mesh_optimizer::optimize_vertex_fetch(void* vertices, const std::size_t vertexCount,
+                                                  const std::size_t stride, unsigned int* indices,
+                                                  const std::size_t indexCount) {
+    std::vector<unsigned int> remap(vertexCount, NONE);
+    unsigned int next = 0;
+    for (std::size_t i = 0; i < indexCount; ++i) {
+        unsigned int& slot = remap[indices[i]];
+        if (slot == NONE) slot = next++;
+        indices[i] = slot;
+    }
+
+    auto* bytes = static_cast<std::uint8_t*>(vertices);
+    std::vector<std::uint8_t> ordered(static_cast<std::size_t>(next) * stride);
+    for (std::size_t v = 0; v < vertexCount; ++v) {
+        if (remap[v] != NONE) std::memcpy(ordered.data() + remap[v] * stride, bytes + v * stride, stride);
+    }
+    std::memcpy(bytes, ordered.data(), ordered.size());
+    return next;
+}
+
+std::size_t mesh_optimizer::optimize(void* vertices, const std::size_t vertexCount, const std::size_t stride,
+                                     unsigned int* indices, const std::size_t indexCount, const unsigned int cacheSize,
+                                     const float threshold) {
+    const std::size_t welded = weld_vertices(vertices, vertexCount, stride, indices, indexCount);
+    std::vector<unsigned int> clusters;
+    optimize_vertex_cache(indices, indexCount, welded, cacheSize, &clusters);
+    optimize_overdraw(indices, indexCount, vertices, welded, stride, clusters, cacheSize, threshold);
+    return optimize_vertex_fetch(vertices, welded, stride, indices, indexCount);
+}
+
+VertexCacheStats mesh_optimizer::analyze_vertex_cache(const unsigned int* indices, const std::size_t indexCount,
+                                                      const std::size_t vertexCount, const unsigned int cacheSize) {
+    VertexCacheStats stats;
+    if (indexCount == 0) return stats;
+    FifoCache cache(vertexCount, cacheSize);
+    std::vector<std::uint8_t> referenced(vertexCount, 0);
+    std::size_t referencedCount = 0;
+    for (std::size_t i = 0; i < indexCount; ++i) {
+        stats.misses += cache.touch(indices[i]) ? 1 : 0;
+        if (!referenced[indices[i]]) {
+            referenced[indices[i]] = 1;
+            referencedCount += 1;
+        }
+    }
+    stats.acmr = static_cast<float>(stats.misses) / static_cast<float>(indexCount / 3);
+    stats.atvr = static_cast<float>(stats.misses) / static_cast<float>(referencedCount);
+    return stats;
+}
@@ -0,0 +1,54 @@
+#ifndef MESH_OPTIMIZER_HPP
+#define MESH_OPTIMIZER_HPP
+
+#include <cstddef>
+#include <vector>
+
+// Post-transform cache behaviour of an index order, simulated on a FIFO cache
+struct VertexCacheStats {
+    unsigned int misses = 0;
+    float acmr = 0.0f;  // misses per triangle, 0.5 is the ideal for large regular meshes
+    float atvr = 0.0f;  // misses per referenced vertex, 1.0 means each is transformed once
+};
+
+/*  Reorders indexed triangle lists for the GPU, used offline by pluto_cook and optionally by the
+    GeometryRegistry when a mesh is added at runtime:
+
+        weld_vertices           merges vertices with identical bytes
+        optimize_vertex_cache   Tipsify (Sander et al. 2007), near optimal ACMR in linear time
+        optimize_overdraw       reorders Tipsify's clusters so outward facing parts draw first
+        optimize_vertex_fetch   lays vertices out in the order the indices first use them
+
+    optimize() runs all four in that order. Vertices are any layout of stride bytes starting with
+    the float position, which covers both primative's 8 floats and PackedVertex.
+ */
+class mesh_optimizer {
+public:
+    static constexpr unsigned int DEFAULT_CACHE_SIZE = 16;
+    // How much worse than Tipsify's ACMR a cluster may get for finer overdraw sorting
+    static constexpr float DEFAULT_OVERDRAW_THRESHOLD = 1.05f;
+
+    // Compacts the vertices in place and remaps the indices, returns the new vertex count
+    static std::size_t weld_vertices(void* vertices, std::size_t vertexCount, std::size_t stride,
+                                     unsigned int* indices, std::size_t indexCount);
+    // clusters, if given, receives the first triangle of every cluster for optimize_overdraw
+    static void optimize_vertex_cache(unsigned int* indices, std::size_t indexCount, std::size_t vertexCount,
+                                      unsigned int cacheSize = DEFAULT_CACHE_SIZE,
+                                      std::vector<unsigned int>* clusters = nullptr);
+    static void optimize_overdraw(unsigned int* indices, std::size_t indexCount, const void* vertices,
+                                  std::size_t vertexCount, std::size_t stride, const std::vector<unsigned int>& clusters,
+                                  unsigned int cacheSize = DEFAULT_CACHE_SIZE,
+                                  float threshold = DEFAULT_OVERDRAW_THRESHOLD);
+    // Drops unreferenced vertices, returns the new vertex count
+    static std::size_t optimize_vertex_fetch(void* vertices, std::size_t vertexCount, std::size_t stride,
+                                             unsigned int* indices, std::size_t indexCount);
+
+    static std::size_t optimize(void* vertices, std::size_t vertexCount, std::size_t stride, unsigned int* indices,
+                                std::size_t indexCount, unsigned int cacheSize = DEFAULT_CACHE_SIZE,
+                                float threshold = DEFAULT_OVERDRAW_THRESHOLD);
+
+    static VertexCacheStats analyze_vertex_cache(const unsigned int* indices, std::size_t indexCount,
+                                                 std::size_t vertexCount, unsigned int cacheSize = DEFAULT_CACHE_SIZE);
+};
+
+#endif //MESH_OPTIMIZER_HPP
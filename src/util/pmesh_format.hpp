@@ -0,0 +1,127 @@
+#ifndef PMESH_FORMAT_HPP
+#define PMESH_FORMAT_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/*  .pmesh, the cooked mesh container written by pluto_cook and read by the GeometryRegistry:
+
+        PmeshHeader
+        PackedVertex[vertexCount]       at vertexOffset
+        indices                         at indexOffset, 16 or 32 bit
+
+    All fields little endian. Vertices are already in the layout of the registry's vertex arena,
+    so they go to GL straight from the mapping; 16 bit indices are widened on their way into the
+    arena's 32 bit index buffer. Indices are relative to the mesh's first vertex.
+ */
+
+// position as floats, normal as snorm 10:10:10:2 (GL_INT_2_10_10_10_REV), uv as half floats
+struct PackedVertex {
+    float position[3];
+    std::uint32_t normal;
+    std::uint16_t uv[2];
+};
+static_assert(sizeof(PackedVertex) == 20, "PackedVertex is the arena's vertex stride");
+
+struct PmeshHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t vertexCount;
+    std::uint32_t indexCount;
+    std::uint32_t indexSize;    // 2 or 4 bytes
+    std::uint32_t reserved;
+    float boundsMin[3];
+    float boundsMax[3];
+    std::uint64_t vertexOffset; // from the start of the file
+    std::uint64_t indexOffset;
+};
+
+constexpr char PMESH_MAGIC[4] = {'P', 'M', 'S', 'H'};
+constexpr std::uint32_t PMESH_VERSION = 1;
+constexpr std::size_t PMESH_ALIGNMENT = 16;
+
+inline std::uint16_t pack_half(const float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const auto sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000u);
+    const std::uint32_t magnitude = bits & 0x7FFFFFFFu;
+    if (magnitude >= 0x7F800000u) return sign | (magnitude > 0x7F800000u ? 0x7E00u : 0x7C00u);  // nan, inf
+    if (magnitude >= 0x477FF000u) return sign | 0x7C00u;                                          // overflows
+    if (magnitude < 0x38800000u) {
+        // Subnormal half, or zero below its smallest step
+        if (magnitude < 0x33000000u) return sign;
+        const std::uint32_t mantissa = (magnitude & 0x007FFFFFu) | 0x00800000u;
+        const int shift = 126 - static_cast<int>(magnitude >> 23);
+        const std::uint32_t half = mantissa >> shift;
+        const std::uint32_t rest = mantissa & ((1u << shift) - 1);
+        const std::uint32_t halfway = 1u << (shift - 1);
+        return sign | static_cast<std::uint16_t>(half + (rest > halfway || (rest == halfway && (half & 1u))));
+    }
+    // Rebias the exponent and round the mantissa to nearest even
+    const std::uint32_t rebased = magnitude - 0x38000000u;
+    return sign | static_cast<std::uint16_t>((rebased + 0x0FFFu + ((rebased >> 13) & 1u)) >> 13);
+}
+
+inline std::uint32_t pack_normal(const float x, const float y, const float z) {
+    const auto snorm10 = [](const float v) {
+        const float clamped = v < -1.0f ? -1.0f : v > 1.0f ? 1.0f : v;
+        return static_cast<std::uint32_t>(static_cast<std::int32_t>(std::lround(clamped * 511.0f))) & 0x3FFu;
+    };
+    return snorm10(x) | snorm10(y) << 10 | snorm10(z) << 20;
+}
+
+// From the 8 float layout of primative: position, normal, uv
+inline PackedVertex pack_vertex(const float* vertex) {
+    PackedVertex packed{};
+    packed.position[0] = vertex[0];
+    packed.position[1] = vertex[1];
+    packed.position[2] = vertex[2];
+    packed.normal = pack_normal(vertex[3], vertex[4], vertex[5]);
+    packed.uv[0] = pack_half(vertex[6]);
+    packed.uv[1] = pack_half(vertex[7]);
+    return packed;
+}
+
+// Header of a mapped .pmesh, pointing into the mapping
+struct PmeshView {
+    const PmeshHeader* header = nullptr;
+    const PackedVertex* vertices = nullptr;
+    const std::uint8_t* indices = nullptr;   // indexSize bytes each
+
+    // Checks everything GL will be trusted with, indices included: a truncated or foreign file,
+    // or one indexing past its vertices, gives false
+    bool parse(const void* file, const std::size_t size) {
+        const auto* bytes = static_cast<const std::uint8_t*>(file);
+        if (size < sizeof(PmeshHeader)) return false;
+        const auto* h = reinterpret_cast<const PmeshHeader*>(bytes);
+        if (std::memcmp(h->magic, PMESH_MAGIC, 4) != 0 || h->version != PMESH_VERSION) return false;
+        if (h->indexSize != 2 && h->indexSize != 4) return false;
+        if (h->vertexCount == 0 || h->indexCount == 0 || h->indexCount % 3 != 0) return false;
+        if (h->indexSize == 2 && h->vertexCount > 0x10000u) return false;
+        if (h->vertexOffset % alignof(PackedVertex) != 0 || h->indexOffset % h->indexSize != 0) return false;
+
+        const std::uint64_t vertexBytes = static_cast<std::uint64_t>(h->vertexCount) * sizeof(PackedVertex);
+        const std::uint64_t indexBytes = static_cast<std::uint64_t>(h->indexCount) * h->indexSize;
+        if (h->vertexOffset > size || vertexBytes > size - h->vertexOffset) return false;
+        if (h->indexOffset > size || indexBytes > size - h->indexOffset) return false;
+
+        std::uint32_t largest = 0;
+        if (h->indexSize == 2) {
+            const auto* list = reinterpret_cast<const std::uint16_t*>(bytes + h->indexOffset);
+            for (std::uint32_t i = 0; i < h->indexCount; ++i) largest = list[i] > largest ? list[i] : largest;
+        } else {
+            const auto* list = reinterpret_cast<const std::uint32_t*>(bytes + h->indexOffset);
+            for (std::uint32_t i = 0; i < h->indexCount; ++i) largest = list[i] > largest ? list[i] : largest;
+        }
+        if (largest >= h->vertexCount) return false;
+
+        header = h;
+        vertices = reinterpret_cast<const PackedVertex*>(bytes + h->vertexOffset);
+        indices = bytes + h->indexOffset;
+        return true;
+    }
+};
+
+#endif //PMESH_FORMAT_HPP
@@ -0,0 +1,94 @@
+#include "png_writer.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+    std::uint32_t crc32(const std::uint8_t* data, const std::size_t size, std::uint32_t crc = 0) {
+        static const auto table = [] {
+            std::vector<std::uint32_t> t(256);
+            for (std::uint32_t n = 0; n < 256; ++n) {
+                std::uint32_t c = n;
+                for (int k = 0; k < 8; ++k) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[n] = c;
+            }
+            return t;
+        }();
+        crc = ~crc;
+        for (std::size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    void put_u32(std::vector<std::uint8_t>& out, const std::uint32_t v) {
+        out.push_back(static_cast<std::uint8_t>(v >> 24));
+        out.push_back(static_cast<std::uint8_t>(v >> 16));
+        out.push_back(static_cast<std::uint8_t>(v >> 8));
+        out.push_back(static_cast<std::uint8_t>(v));
+    }
+
+    void put_chunk(std::vector<std::uint8_t>& out, const char* type, const std::vector<std::uint8_t>& data) {
+        put_u32(out, static_cast<std::uint32_t>(data.size()));
+        const std::size_t start = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data.begin(), data.end());
+        put_u32(out, crc32(out.data() + start, out.size() - start));
+    }
+}
+
+std::vector<std::uint8_t> png_writer::encode(const std::uint8_t* pixels, const int width, const int height,
+                                             const int channels) {
+    static constexpr std::uint8_t colorTypes[] = {0, 4, 2, 6};  // by channels - 1
+    if (width <= 0 || height <= 0 || channels < 1 || channels > 4) return {};
+
+    std::vector<std::uint8_t> out = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    std::vector<std::uint8_t> header;
+    put_u32(header, static_cast<std::uint32_t>(width));
+    put_u32(header, static_cast<std::uint32_t>(height));
+    header.insert(header.end(), {8, colorTypes[channels - 1], 0, 0, 0});
+    put_chunk(out, "IHDR", header);
+
+    // Every row starts with filter type 0, then the zlib stream wraps it in stored blocks
+    const std::size_t rowBytes = static_cast<std::size_t>(width) * channels;
+    std::vector<std::uint8_t> raw;
+    raw.reserve((rowBytes + 1) * height);
+    for (int y = 0; y < height; ++y) {
+        raw.push_back(0);
+        raw.insert(raw.end(), pixels + y * rowBytes, pixels + (y + 1) * rowBytes);
+    }
+
+    constexpr std::size_t MAX_STORED = 65535;
+    std::vector<std::uint8_t> stream = {0x78, 0x01};
+    stream.reserve(raw.size() + raw.size() / MAX_STORED * 5 + 16);
+    std::size_t offset = 0;
+    do {
+        const std::size_t length = std::min(MAX_STORED, raw.size() - offset);
+        const bool last = offset + length == raw.size();
+        stream.push_back(last ? 1 : 0);
+        stream.push_back(static_cast<std::uint8_t>(length));
+        stream.push_back(static_cast<std::uint8_t>(length >> 8));
+        stream.push_back(static_cast<std::uint8_t>(~length));
+        stream.push_back(static_cast<std::uint8_t>(~length >> 8));
+        stream.insert(stream.end(), raw.begin() + offset, raw.begin() + offset + length);
+        offset += length;
+    } while (offset < raw.size());
+
+    std::uint32_t a = 1, b = 0;
+    for (const std::uint8_t v : raw) {
+        a = (a + v) % 65521;
+        b = (b + a) % 65521;
+    }
+    put_u32(stream, b << 16 | a);
+    put_chunk(out, "IDAT", stream);
+    put_chunk(out, "IEND", {});
+    return out;
+}
+
+bool png_writer::write(const std::string& path, const std::uint8_t* pixels, const int width, const int height,
+                       const int channels) {
+    const auto data = encode(pixels, width, height, channels);
+    if (data.empty()) return false;
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    const bool written = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    return std::fclose(file) == 0 && written;
+}
@@ -0,0 +1,17 @@
+#ifndef PNG_WRITER_HPP
+#define PNG_WRITER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Minimal PNG encoder for frame dumps and golden images. 8 bit grayscale, gray + alpha, RGB or
+// RGBA, rows top to bottom. The image data goes into stored (uncompressed) deflate blocks, so
+// files are about as large as the raw pixels but encoding needs no zlib and is byte exact.
+class png_writer {
+public:
+    static std::vector<std::uint8_t> encode(const std::uint8_t* pixels, int width, int height, int channels);
+    static bool write(const std::string& path, const std::uint8_t* pixels, int width, int height, int channels);
+};
+
+#endif //PNG_WRITER_HPP
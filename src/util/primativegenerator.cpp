@@ -11,7 +11,7 @@ primative primative_generator::cube;
 primative primative_generator::circle;
 primative primative_generator::sphere;
 
-primative primative_generator::get_square() {
+const primative& primative_generator::get_square() {
     if (square.vertices.empty()) generate_square();
     return square;
 }
@@ -31,7 +31,7 @@ void primative_generator::generate_square() {
 }
 
 
-primative primative_generator::get_cube() {
+const primative& primative_generator::get_cube() {
     if (cube.vertices.empty()) generate_cube();
     return cube;
 }
@@ -92,7 +92,7 @@ void primative_generator::generate_cube() {
     };
 }
 
-primative primative_generator::get_circle() {
+const primative& primative_generator::get_circle() {
     if (circle.vertices.empty()) generate_circle();
     return circle;
 }
@@ -126,7 +126,7 @@ void primative_generator::generate_circle() {
 
 }
 
-primative primative_generator::get_sphere() {
+const primative& primative_generator::get_sphere() {
     if (sphere.vertices.empty()) generate_sphere();
     return sphere;
 }
@@ -11,10 +11,10 @@ struct primative {
 
 class primative_generator {
 public:
-    static primative get_square();
-    static primative get_cube();
-    static primative get_circle();
-    static primative get_sphere();
+    static const primative& get_square();
+    static const primative& get_cube();
+    static const primative& get_circle();
+    static const primative& get_sphere();
 private:
     static void generate_square();
     static void generate_cube();
@@ -0,0 +1,131 @@
+#include "profiler.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+namespace {
+    std::uint64_t clock_ns() {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    thread_local void* localRing = nullptr;
+
+    void write_escaped(std::FILE* file, const char* text) {
+        for (const char* c = text; *c; ++c) {
+            if (*c == '"' || *c == '\\') std::fputc('\\', file);
+            if (static_cast<unsigned char>(*c) >= 0x20) std::fputc(*c, file);
+        }
+    }
+}
+
+Profiler& profiler() {
+    static Profiler instance;
+    return instance;
+}
+
+Profiler::Profiler() : epoch(clock_ns()) {}
+
+std::uint64_t Profiler::now() const {
+    return clock_ns() - epoch;
+}
+
+Profiler::Ring& Profiler::local_ring() {
+    if (localRing) return *static_cast<Ring*>(localRing);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto ring = std::make_unique<Ring>();
+    ring->track = static_cast<std::uint32_t>(trackNames.size());
+    ring->events.resize(RING_SIZE);
+    trackNames.push_back("Thread " + std::to_string(ring->track));
+    localRing = ring.get();
+    rings.push_back(std::move(ring));
+    return *static_cast<Ring*>(localRing);
+}
+
+void Profiler::record(const char* name, const std::uint64_t start, const std::uint64_t end) {
+    Ring& ring = local_ring();
+    record(ring.track, name, start, end);
+}
+
+void Profiler::record(const std::uint32_t track, const char* name, const std::uint64_t start, const std::uint64_t end) {
+    Ring& ring = local_ring();
+    const std::size_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= RING_SIZE) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ring.events[head % RING_SIZE] = {name, start, end, track};
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::set_thread_name(const std::string& name) {
+    const std::uint32_t track = local_ring().track;
+    std::lock_guard<std::mutex> lock(mutex);
+    trackNames[track] = name;
+}
+
+std::uint32_t Profiler::add_track(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    trackNames.push_back(name);
+    return static_cast<std::uint32_t>(trackNames.size() - 1);
+}
+
+void Profiler::collect() {
+    std::lock_guard<std::mutex> lock(mutex);
+    const bool keep = capturing.load(std::memory_order_relaxed);
+    for (auto& ring : rings) {
+        const std::size_t tail = ring->tail.load(std::memory_order_relaxed);
+        const std::size_t head = ring->head.load(std::memory_order_acquire);
+        for (std::size_t i = tail; keep && i < head && captured.size() < MAX_CAPTURED; ++i)
+            captured.push_back(ring->events[i % RING_SIZE]);
+        ring->tail.store(head, std::memory_order_release);
+    }
+}
+
+void Profiler::start_capture() {
+    std::lock_guard<std::mutex> lock(mutex);
+    captured.clear();
+    capturing.store(true);
+}
+
+void Profiler::stop_capture() {
+    capturing.store(false);
+}
+
+bool Profiler::is_capturing() const {
+    return capturing.load();
+}
+
+const std::vector<ProfileEvent>& Profiler::get_captured() const {
+    return captured;
+}
+
+std::uint64_t Profiler::get_dropped() const {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+bool Profiler::write_chrome_trace(const std::string& path) const {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) return false;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+    bool first = true;
+    for (std::size_t track = 0; track < trackNames.size(); ++track) {
+        std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%zu,\"args\":{\"name\":\"",
+                     first ? "" : ",\n", track);
+        write_escaped(file, trackNames[track].c_str());
+        std::fputs("\"}}", file);
+        first = false;
+    }
+    // Complete events, timestamps in microseconds
+    for (const auto& event : captured) {
+        std::fprintf(file, "%s{\"name\":\"", first ? "" : ",\n");
+        write_escaped(file, event.name);
+        std::fprintf(file, "\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", event.track,
+                     static_cast<double>(event.start) / 1000.0,
+                     static_cast<double>(event.end - event.start) / 1000.0);
+        first = false;
+    }
+    std::fputs("\n]}\n", file);
+    return std::fclose(file) == 0;
+}
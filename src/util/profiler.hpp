@@ -0,0 +1,108 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One timed scope. Times are nanoseconds on Profiler::now()'s clock, name must outlive the
+// profiler (string literals, __func__).
+struct ProfileEvent {
+    const char* name;
+    std::uint64_t start;
+    std::uint64_t end;
+    std::uint32_t track;
+};
+
+/*  Collects timed scopes from every thread. Each thread records into its own fixed ring that
+    only it writes and only collect() reads, so recording is two atomic loads and a store, no
+    locks; the mutex is taken once per thread, on its first event, and by collect().
+    A ring that fills up before the next collect() drops events rather than blocking, see
+    get_dropped(). Tracks are threads, plus any added with add_track() for timelines that do not
+    belong to a thread, such as the GPU.
+    Use the PLUTO_PROFILE_* macros below rather than calling this directly, they compile to
+    nothing unless PLUTO_PROFILE is defined.
+ */
+class Profiler {
+public:
+    // Events a thread can record between two collect() calls
+    static constexpr std::size_t RING_SIZE = 1 << 14;
+
+    Profiler();
+
+    std::uint64_t now() const;
+    void record(const char* name, std::uint64_t start, std::uint64_t end);
+    void record(std::uint32_t track, const char* name, std::uint64_t start, std::uint64_t end);
+    // Names the calling thread's track in the trace
+    void set_thread_name(const std::string& name);
+    std::uint32_t add_track(const std::string& name);
+
+    // Drains every ring, keeping the events while a capture runs. Call from one thread, once a frame.
+    void collect();
+    void start_capture();
+    void stop_capture();
+    bool is_capturing() const;
+    const std::vector<ProfileEvent>& get_captured() const;
+    // Chrome trace event JSON, loads in chrome://tracing, Perfetto and Speedscope
+    bool write_chrome_trace(const std::string& path) const;
+    std::uint64_t get_dropped() const;
+
+    // Captures stop growing past this many events
+    static constexpr std::size_t MAX_CAPTURED = 4'000'000;
+
+private:
+    struct Ring {
+        std::uint32_t track = 0;
+        std::vector<ProfileEvent> events;
+        std::atomic<std::size_t> head{0};  // written by the owning thread
+        std::atomic<std::size_t> tail{0};  // written by collect()
+    };
+
+    std::uint64_t epoch;
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::vector<std::string> trackNames;
+    std::vector<ProfileEvent> captured;
+    std::atomic<bool> capturing{false};
+    std::atomic<std::uint64_t> dropped{0};
+
+    Ring& local_ring();
+};
+
+Profiler& profiler();
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name) : name(name), start(profiler().now()) {}
+    ~ProfileScope() {
+        profiler().record(name, start, profiler().now());
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    std::uint64_t start;
+};
+
+#define PLUTO_PROFILE_CONCAT_(a, b) a##b
+#define PLUTO_PROFILE_CONCAT(a, b) PLUTO_PROFILE_CONCAT_(a, b)
+
+#ifdef PLUTO_PROFILE
+#define PLUTO_PROFILE_SCOPE(name) ProfileScope PLUTO_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PLUTO_PROFILE_FUNCTION() PLUTO_PROFILE_SCOPE(__func__)
+#define PLUTO_PROFILE_THREAD(name) profiler().set_thread_name(name)
+#define PLUTO_PROFILE_COLLECT() profiler().collect()
+#else
+#define PLUTO_PROFILE_SCOPE(name) ((void)0)
+#define PLUTO_PROFILE_FUNCTION() ((void)0)
+#define PLUTO_PROFILE_THREAD(name) ((void)0)
+#define PLUTO_PROFILE_COLLECT() ((void)0)
+#endif
+
+#endif //PROFILER_HPP
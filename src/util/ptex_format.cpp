@@ -0,0 +1,60 @@
+#include "ptex_format.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+BlockFormat ptex_writer::pick_format(const std::uint8_t* rgba, const int width, const int height) {
+    const std::size_t pixels = static_cast<std::size_t>(width) * height;
+    for (std::size_t i = 0; i < pixels; ++i) {
+        if (rgba[i * 4 + 3] != 255) return BlockFormat::BC3;
+    }
+    return BlockFormat::BC1;
+}
+
+std::vector<std::uint8_t> ptex_writer::encode(const std::uint8_t* rgba, const int width, const int height,
+                                              const BlockFormat format, const bool mips) {
+    if (width <= 0 || height <= 0) return {};
+    const int mipCount = mips ? block_codec::mip_count(width, height) : 1;
+
+    PtexHeader header{};
+    std::memcpy(header.magic, PTEX_MAGIC, 4);
+    header.version = PTEX_VERSION;
+    header.format = static_cast<std::uint32_t>(format);
+    header.width = static_cast<std::uint32_t>(width);
+    header.height = static_cast<std::uint32_t>(height);
+    header.mipCount = static_cast<std::uint32_t>(mipCount);
+
+    std::vector<PtexMip> table(mipCount);
+    std::vector<std::uint8_t> file(sizeof(PtexHeader) + table.size() * sizeof(PtexMip));
+    std::vector<std::uint8_t> level(rgba, rgba + static_cast<std::size_t>(width) * height * 4);
+    int w = width, h = height;
+    for (int mip = 0; mip < mipCount; ++mip) {
+        const std::size_t offset = (file.size() + LEVEL_ALIGNMENT - 1) / LEVEL_ALIGNMENT * LEVEL_ALIGNMENT;
+        const auto blocks = block_codec::compress(format, level.data(), w, h);
+        table[mip] = {offset, blocks.size(), static_cast<std::uint32_t>(w), static_cast<std::uint32_t>(h)};
+        file.resize(offset);
+        file.insert(file.end(), blocks.begin(), blocks.end());
+
+        if (mip + 1 < mipCount) {
+            level = block_codec::downsample(level.data(), w, h);
+            w = std::max(w / 2, 1);
+            h = std::max(h / 2, 1);
+        }
+    }
+    std::memcpy(file.data(), &header, sizeof(header));
+    std::memcpy(file.data() + sizeof(header), table.data(), table.size() * sizeof(PtexMip));
+    return file;
+}
+
+bool ptex_writer::write(const std::string& path, const std::vector<std::uint8_t>& file) {
+    if (file.empty()) return false;
+    std::FILE* out = std::fopen(path.c_str(), "wb");
+    if (!out) return false;
+    const bool written = std::fwrite(file.data(), 1, file.size(), out) == file.size();
+    return std::fclose(out) == 0 && written;
+}
+
+bool ptex_writer::write(const std::string& path, const std::uint8_t* rgba, const int width, const int height,
+                        const BlockFormat format, const bool mips) {
+    return write(path, encode(rgba, width, height, format, mips));
+}
@@ -0,0 +1,100 @@
+#ifndef PTEX_FORMAT_HPP
+#define PTEX_FORMAT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "block_codec.hpp"
+
+/*  .ptex, the cooked texture container written by pluto_cook and read by the TextureManager:
+
+        PtexHeader
+        PtexMip[mipCount]       largest first
+        block data              each level at its offset, 16 byte aligned, ready for glCompressedTexImage2D
+
+    All fields little endian. Rows are stored bottom up, the order GL expects, which is what
+    loading the source image with flipping on gives. Everything is laid out so the file can be
+    mapped and handed to GL in place, there is nothing to decode.
+ */
+
+struct PtexHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t format;   // BlockFormat
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t mipCount;
+};
+
+struct PtexMip {
+    std::uint64_t offset;   // from the start of the file
+    std::uint64_t size;
+    std::uint32_t width;
+    std::uint32_t height;
+};
+
+constexpr char PTEX_MAGIC[4] = {'P', 'T', 'E', 'X'};
+constexpr std::uint32_t PTEX_VERSION = 1;
+constexpr std::uint32_t PTEX_MAX_MIPS = 16;
+
+// Header and mip table of a mapped .ptex, pointing into the mapping
+struct PtexView {
+    const PtexHeader* header = nullptr;
+    const PtexMip* mips = nullptr;
+    const std::uint8_t* data = nullptr;  // start of the file, add PtexMip::offset
+
+    BlockFormat get_format() const {
+        return static_cast<BlockFormat>(header->format);
+    }
+
+    const std::uint8_t* get_level(const std::uint32_t level) const {
+        return data + mips[level].offset;
+    }
+
+    // Checks everything GL will be trusted with, a truncated or foreign file gives false
+    bool parse(const void* file, const std::size_t size) {
+        const auto* bytes = static_cast<const std::uint8_t*>(file);
+        if (size < sizeof(PtexHeader)) return false;
+        const auto* h = reinterpret_cast<const PtexHeader*>(bytes);
+        if (std::memcmp(h->magic, PTEX_MAGIC, 4) != 0 || h->version != PTEX_VERSION) return false;
+        if (h->format != static_cast<std::uint32_t>(BlockFormat::BC1) &&
+            h->format != static_cast<std::uint32_t>(BlockFormat::BC3)) return false;
+        if (h->mipCount == 0 || h->mipCount > PTEX_MAX_MIPS) return false;
+        if (size < sizeof(PtexHeader) + h->mipCount * sizeof(PtexMip)) return false;
+
+        const auto* table = reinterpret_cast<const PtexMip*>(bytes + sizeof(PtexHeader));
+        for (std::uint32_t level = 0; level < h->mipCount; ++level) {
+            const PtexMip& mip = table[level];
+            const std::uint32_t w = h->width >> level, hgt = h->height >> level;
+            if (mip.width != (w ? w : 1) || mip.height != (hgt ? hgt : 1)) return false;
+            const auto format = static_cast<BlockFormat>(h->format);
+            if (mip.size != block_codec::compressed_size(format, static_cast<int>(mip.width), static_cast<int>(mip.height))) return false;
+            if (mip.offset > size || mip.size > size - mip.offset) return false;
+        }
+        header = h;
+        mips = table;
+        data = bytes;
+        return true;
+    }
+};
+
+// The one writer of the format, used by pluto_cook and the texture benchmark. Takes an RGBA8
+// image already in the row order the file stores, bottom row first.
+class ptex_writer {
+public:
+    static constexpr std::size_t LEVEL_ALIGNMENT = 16;
+
+    // BC3 if any texel is not opaque, BC1 if not
+    static BlockFormat pick_format(const std::uint8_t* rgba, int width, int height);
+    // The whole file, with the full mip chain or only the first level
+    static std::vector<std::uint8_t> encode(const std::uint8_t* rgba, int width, int height, BlockFormat format,
+                                            bool mips);
+    static bool write(const std::string& path, const std::vector<std::uint8_t>& file);
+    static bool write(const std::string& path, const std::uint8_t* rgba, int width, int height, BlockFormat format,
+                      bool mips);
+};
+
+#endif //PTEX_FORMAT_HPP
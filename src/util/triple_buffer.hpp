@@ -0,0 +1,49 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+/*  Lock-free handoff of the newest T from one writer thread to one reader thread. The writer
+    fills write_buffer() and publish()es it, the reader acquire()s the newest published value and
+    reads it with read(). Each side owns one of the three buffers, the third sits in the middle and
+    is traded with a single atomic exchange, so neither side ever waits for the other. Values the
+    reader did not get to in time are overwritten, only the latest one counts.
+    Buffers are reused, keep capacity in T (vectors) and copy into it rather than reallocating.
+ */
+template<typename T>
+class TripleBuffer {
+public:
+    // Writer side
+    T& write_buffer() {
+        return buffers[back];
+    }
+
+    void publish() {
+        back = middle.exchange(static_cast<std::uint8_t>(back | FRESH), std::memory_order_acq_rel) & INDEX;
+    }
+
+    // Reader side. False if nothing was published since the last acquire(), read() is unchanged then.
+    bool acquire() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    // Only valid once acquire() returned true at least once
+    const T& read() const {
+        return buffers[front];
+    }
+
+private:
+    static constexpr std::uint8_t INDEX = 0x3;
+    static constexpr std::uint8_t FRESH = 0x4;
+
+    T buffers[3];
+    std::uint8_t back = 0;
+    std::uint8_t front = 1;
+    // Index of the middle buffer, with FRESH set while it holds a value the reader has not seen
+    std::atomic<std::uint8_t> middle{2};
+};
+
+#endif //TRIPLE_BUFFER_HPP
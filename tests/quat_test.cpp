@@ -0,0 +1,138 @@
+#include <cstdio>
+#include <random>
+
+#include "test.hpp"
+#include "../src/PlutoMath/plutomath.hpp"
+
+// plutom::quat against the matrix forms it replaces: transform3D::rotate() for the rotation
+// convention, translate * rotate * scale for trs(), and interpolation endpoints and midpoints.
+
+namespace {
+    using plutom::mat4d;
+    using plutom::quatd;
+    using plutom::vec3d;
+    namespace t3 = plutom::transform3D;
+
+    constexpr double PI = 3.14159265358979323846;
+
+    bool near(const double a, const double b, const double eps = 1e-9){
+        return std::abs(a - b) <= eps;
+    }
+
+    bool near(const mat4d& a, const mat4d& b, const double eps = 1e-9){
+        for(int c = 0; c < 4; ++c)
+            for(int r = 0; r < 4; ++r)
+                if(!near(a.columns[c][r], b.columns[c][r], eps)) return false;
+        return true;
+    }
+
+    bool near(const vec3d& a, const vec3d& b, const double eps = 1e-9){
+        return near(a.x, b.x, eps) && near(a.y, b.y, eps) && near(a.z, b.z, eps);
+    }
+
+    // Angle between two rotations, q and -q being the same one
+    double angle_between(const quatd& a, const quatd& b){
+        return 2.0 * std::acos(std::min(1.0, std::abs(a.normalize().dot(b.normalize()))));
+    }
+
+    void axis_angle(){
+        const vec3d axes[] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, 2, 3}, {-0.3, 0.1, -2.0}};
+        for(const auto& axis : axes){
+            for(const double theta : {0.0, 0.3, PI / 2, 2.0, PI, 5.5}){
+                const quatd q = quatd::from_axis_angle(theta, axis);
+                PLUTO_CHECK(near(q.length(), 1.0));
+                PLUTO_CHECK(near(q.to_mat4(), t3::rotate(theta, axis)));
+
+                double back = 0.0;
+                vec3d backAxis;
+                q.to_axis_angle(back, backAxis);
+                if(theta > 0.0) PLUTO_CHECK(near(quatd::from_axis_angle(back, backAxis).dot(q), 1.0));
+            }
+        }
+        // A quarter turn around z takes x to y
+        const quatd quarter = quatd::from_axis_angle(PI / 2, vec3d{0, 0, 1});
+        PLUTO_CHECK(near(quarter.rotate({1, 0, 0}), vec3d{0, 1, 0}));
+        PLUTO_CHECK(near(quarter.to_mat3() * vec3d{1, 0, 0}, vec3d{0, 1, 0}));
+    }
+
+    void matrix_round_trip(){
+        std::mt19937 gen(7);
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        for(int i = 0; i < 1000; ++i){
+            const vec3d axis{dist(gen), dist(gen), dist(gen)};
+            const double theta = (dist(gen) + 1.0) * PI;
+            if(axis.length() < 1e-3) continue;
+            const quatd q = quatd::from_axis_angle(theta, axis);
+            // All four branches of Shepperd's method are reached by angles up to 2 pi
+            PLUTO_CHECK(angle_between(quatd::from_mat3(q.to_mat3()), q) < 1e-7);
+            PLUTO_CHECK(angle_between(quatd::from_mat4(t3::rotate(theta, axis)), q) < 1e-7);
+        }
+        // The half turns, where the trace is -1 and only the diagonal branches apply
+        for(const auto& axis : {vec3d{1, 0, 0}, vec3d{0, 1, 0}, vec3d{0, 0, 1}}){
+            const quatd q = quatd::from_axis_angle(PI, axis);
+            PLUTO_CHECK(angle_between(quatd::from_mat3(q.to_mat3()), q) < 1e-7);
+        }
+    }
+
+    void composition(){
+        const quatd a = quatd::from_axis_angle(0.7, vec3d{1, 0, 0});
+        const quatd b = quatd::from_axis_angle(-1.3, vec3d{0, 1, 1});
+        // a * b applies b first, like the matrix product
+        PLUTO_CHECK(near((a * b).to_mat4(), a.to_mat4() * b.to_mat4()));
+        PLUTO_CHECK((a * a.inverse()) == quatd::identity());
+        // A rotation's inverse is its transpose
+        PLUTO_CHECK(near(a.conjugate().to_mat4(), a.to_mat4().transpose()));
+    }
+
+    void interpolation(){
+        const vec3d axis{0.2, -1.0, 0.5};
+        const quatd a = quatd::from_axis_angle(0.4, axis);
+        const quatd b = quatd::from_axis_angle(2.0, axis);
+        const quatd mid = quatd::from_axis_angle(1.2, axis);
+
+        PLUTO_CHECK(slerp(a, b, 0.0) == a);
+        PLUTO_CHECK(slerp(a, b, 1.0) == b);
+        PLUTO_CHECK(angle_between(slerp(a, b, 0.5), mid) < 1e-9);
+        // Constant angular velocity: a quarter of the way is a quarter of the angle
+        PLUTO_CHECK(angle_between(slerp(a, b, 0.25), quatd::from_axis_angle(0.8, axis)) < 1e-9);
+
+        PLUTO_CHECK(nlerp(a, b, 0.0) == a);
+        PLUTO_CHECK(nlerp(a, b, 1.0) == b);
+        // nlerp's midpoint is exact for a single axis, the speed in between is not
+        PLUTO_CHECK(angle_between(nlerp(a, b, 0.5), mid) < 1e-9);
+        PLUTO_CHECK(near(nlerp(a, b, 0.3).length(), 1.0));
+
+        // -b is the same rotation, both take the shorter arc to it
+        PLUTO_CHECK(angle_between(slerp(a, -b, 0.5), mid) < 1e-9);
+        PLUTO_CHECK(angle_between(nlerp(a, -b, 0.5), mid) < 1e-9);
+
+        // Nearly parallel falls back to nlerp instead of dividing by sin(theta)
+        const quatd c = quatd::from_axis_angle(0.4 + 1e-9, axis);
+        PLUTO_CHECK(near(slerp(a, c, 0.5).length(), 1.0));
+        PLUTO_CHECK_THROWS(slerp(a, b, 1.5));
+        PLUTO_CHECK_THROWS(nlerp(a, b, -0.1));
+    }
+
+    void trs(){
+        const vec3d t{1.5, -2.0, 0.25};
+        const vec3d s{2.0, 0.5, 3.0};
+        const vec3d axis{1, 1, 0};
+        const double theta = 0.9;
+        const quatd q = quatd::from_axis_angle(theta, axis);
+        const mat4d expected = t3::translate(t) * t3::rotate(theta, axis) * t3::scale(s);
+        PLUTO_CHECK(near(t3::trs(t, q, s), expected));
+        PLUTO_CHECK(near(t3::trs(t, q, s), t3::translate(t) * t3::rotate(q) * t3::scale(s)));
+
+        const mat4d parent = t3::translate(vec3d{0, 1, 0}) * t3::rotate(0.3, vec3d{0, 0, 1});
+        PLUTO_CHECK(near(t3::trs(parent, t, q, s), parent * expected));
+    }
+}
+
+int main(){
+    axis_angle();
+    matrix_round_trip();
+    composition();
+    interpolation();
+    trs();
+    return test::report("quat");
+}
@@ -0,0 +1,44 @@
+#include "recording_render_device.hpp"
+
+#include <algorithm>
+
+void RecordingRenderDevice::use_program(const unsigned int program) {
+    calls.push_back({.op = Op::UseProgram, .name = program});
+}
+
+void RecordingRenderDevice::set_wireframe(const bool wireframe) {
+    calls.push_back({.op = Op::SetWireframe, .name = wireframe ? 1u : 0u});
+}
+
+void RecordingRenderDevice::bind_texture(const unsigned int unit, const unsigned int texture) {
+    calls.push_back({.op = Op::BindTexture, .name = texture, .unit = unit});
+}
+
+void RecordingRenderDevice::bind_vertex_array(const unsigned int vao) {
+    calls.push_back({.op = Op::BindVertexArray, .name = vao});
+}
+
+void RecordingRenderDevice::draw_indexed(const unsigned int indexCount, const unsigned int firstIndex,
+                                         const int baseVertex, const unsigned int instanceCount,
+                                         const unsigned int baseInstance) {
+    calls.push_back({.op = Op::DrawIndexed, .indexCount = indexCount, .firstIndex = firstIndex,
+                     .baseVertex = baseVertex, .instanceCount = instanceCount, .baseInstance = baseInstance});
+}
+
+void RecordingRenderDevice::multi_draw_indirect(const std::size_t commandOffset, const unsigned int drawCount) {
+    calls.push_back({.op = Op::MultiDrawIndirect, .commandOffset = commandOffset, .drawCount = drawCount});
+}
+
+const std::vector<RecordingRenderDevice::Call>& RecordingRenderDevice::get_calls() const {
+    return calls;
+}
+
+std::size_t RecordingRenderDevice::count(const Op op) const {
+    return static_cast<std::size_t>(std::count_if(calls.begin(), calls.end(), [op](const Call& call) {
+        return call.op == op;
+    }));
+}
+
+void RecordingRenderDevice::clear() {
+    calls.clear();
+}
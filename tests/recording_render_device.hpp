@@ -0,0 +1,45 @@
+#ifndef RECORDING_RENDER_DEVICE_HPP
+#define RECORDING_RENDER_DEVICE_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "../src/render/render_device.hpp"
+
+// Logs the calls a RenderDevice receives instead of issuing them, so the render queue can be
+// run and checked without a GL context
+class RecordingRenderDevice final : public RenderDevice {
+public:
+    enum class Op { UseProgram, SetWireframe, BindTexture, BindVertexArray, DrawIndexed, MultiDrawIndirect };
+
+    // Fields a call does not take stay zero
+    struct Call {
+        Op op;
+        unsigned int name = 0;          // program, texture or VAO, 1 for wireframe on
+        unsigned int unit = 0;
+        unsigned int indexCount = 0;
+        unsigned int firstIndex = 0;
+        int baseVertex = 0;
+        unsigned int instanceCount = 0;
+        unsigned int baseInstance = 0;
+        std::size_t commandOffset = 0;
+        unsigned int drawCount = 0;
+    };
+
+    void use_program(unsigned int program) override;
+    void set_wireframe(bool wireframe) override;
+    void bind_texture(unsigned int unit, unsigned int texture) override;
+    void bind_vertex_array(unsigned int vao) override;
+    void draw_indexed(unsigned int indexCount, unsigned int firstIndex, int baseVertex,
+                      unsigned int instanceCount, unsigned int baseInstance) override;
+    void multi_draw_indirect(std::size_t commandOffset, unsigned int drawCount) override;
+
+    const std::vector<Call>& get_calls() const;
+    std::size_t count(Op op) const;
+    void clear();
+
+private:
+    std::vector<Call> calls;
+};
+
+#endif //RECORDING_RENDER_DEVICE_HPP
@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "test.hpp"
+#include "recording_render_device.hpp"
+#include "../src/render/render_queue.hpp"
+
+// RenderQueue run headless against RecordingRenderDevice: the sort order its key promises, ties
+// kept in submission order, binds of state that is already current left out, and stats that
+// agree with the calls that were actually made.
+
+namespace {
+    using Op = RecordingRenderDevice::Op;
+
+    DrawItem item(const unsigned int program, const unsigned int texture, const unsigned int mesh, const float depth,
+                  const unsigned int userIndex, const bool wireframe = false, const unsigned int vao = 1){
+        return {.program = program, .vao = vao, .texture = texture, .mesh = mesh, .indexCount = 36 * mesh,
+                .firstIndex = 100 * mesh, .baseVertex = static_cast<int>(10 * mesh), .userIndex = userIndex,
+                .wireframe = wireframe, .depth = depth};
+    }
+
+    void key_order(){
+        RenderQueue queue;
+        // Program outranks wireframe, which outranks texture, then mesh, then depth
+        queue.submit(item(2, 1, 1, 0.1f, 0));
+        queue.submit(item(1, 2, 1, 0.1f, 1));
+        queue.submit(item(1, 1, 2, 0.1f, 2));
+        queue.submit(item(1, 1, 1, 0.9f, 3));
+        queue.submit(item(1, 1, 1, 0.2f, 4));
+        queue.submit(item(1, 1, 1, 0.1f, 5, true));
+        queue.sort();
+        const unsigned int expected[] = {4, 3, 2, 1, 5, 0};
+        for(std::size_t i = 0; i < queue.size(); ++i) PLUTO_CHECK(queue[i].userIndex == expected[i]);
+
+        // Enough items with random fields to take every radix pass, against a comparison sort
+        std::mt19937 gen(3);
+        std::uniform_int_distribution<unsigned int> names(1, 5000);
+        std::uniform_real_distribution<float> depths(-0.5f, 1.5f);
+        std::vector<DrawItem> items;
+        queue.clear();
+        for(unsigned int i = 0; i < 10000; ++i){
+            items.push_back(item(names(gen), names(gen) % 4, names(gen), depths(gen), i, names(gen) % 2 == 0));
+            queue.submit(items.back());
+        }
+        queue.sort();
+        std::stable_sort(items.begin(), items.end(), [](const DrawItem& a, const DrawItem& b){
+            return RenderQueue::make_key(a) < RenderQueue::make_key(b);
+        });
+        bool matches = queue.size() == items.size();
+        for(std::size_t i = 0; matches && i < items.size(); ++i) matches = queue[i].userIndex == items[i].userIndex;
+        PLUTO_CHECK(matches);
+    }
+
+    void stable_ties(){
+        RenderQueue queue;
+        // Same key throughout, items of the other program interleaved
+        for(unsigned int i = 0; i < 600; ++i) queue.submit(item(i % 3 == 0 ? 7 : 3, 1, 1, 0.5f, i));
+        queue.sort();
+        bool ordered = true;
+        for(std::size_t i = 1; i < queue.size(); ++i){
+            if(queue[i].program == queue[i - 1].program) ordered = ordered && queue[i].userIndex > queue[i - 1].userIndex;
+        }
+        PLUTO_CHECK(ordered);
+        PLUTO_CHECK(queue[0].program == 3 && queue[queue.size() - 1].program == 7);
+
+        // A single item and an empty queue are left alone
+        queue.clear();
+        queue.sort();
+        PLUTO_CHECK(queue.size() == 0);
+        queue.submit(item(1, 1, 1, 0.5f, 42));
+        queue.sort();
+        PLUTO_CHECK(queue[0].userIndex == 42);
+    }
+
+    void redundant_binds(){
+        RenderQueue queue;
+        RecordingRenderDevice device;
+        queue.submit(item(1, 5, 1, 0.1f, 0));
+        queue.submit(item(1, 5, 1, 0.2f, 1));    // same batch as the first, instanced with it
+        queue.submit(item(1, 5, 2, 0.1f, 2));    // new mesh only, no binds
+        queue.submit(item(1, 6, 2, 0.1f, 3));    // new texture
+        queue.submit(item(1, 0, 3, 0.1f, 4, false, 2));  // texture 0 leaves the binding alone, new VAO
+        queue.submit(item(2, 0, 3, 0.1f, 5, false, 2));  // new program
+        queue.submit(item(2, 0, 3, 0.1f, 6, true, 2));   // wireframe
+        queue.sort();
+        queue.execute(device);
+
+        const auto& calls = device.get_calls();
+        const std::vector<Op> expected = {
+            Op::UseProgram, Op::SetWireframe, Op::BindVertexArray, Op::DrawIndexed,  // program 1, texture 0, VAO 2
+            Op::BindTexture, Op::BindVertexArray, Op::DrawIndexed,                   // texture 5, VAO 1, items 0 and 1
+            Op::DrawIndexed,                                                         // mesh 2
+            Op::BindTexture, Op::DrawIndexed,                                        // texture 6
+            Op::UseProgram, Op::BindVertexArray, Op::DrawIndexed,                    // program 2, VAO 2 again
+            Op::SetWireframe, Op::DrawIndexed};
+        bool same = calls.size() == expected.size();
+        for(std::size_t i = 0; same && i < calls.size(); ++i) same = calls[i].op == expected[i];
+        PLUTO_CHECK(same);
+        // No call sets state to what it already is
+        for(std::size_t i = 0; i < calls.size(); ++i){
+            if(calls[i].op == Op::DrawIndexed) continue;
+            for(std::size_t j = i; j-- > 0;){
+                if(calls[j].op != calls[i].op) continue;
+                PLUTO_CHECK(calls[j].name != calls[i].name);
+                break;
+            }
+        }
+        const auto& batched = calls[6];
+        PLUTO_CHECK(batched.instanceCount == 2 && batched.baseInstance == 1);
+        PLUTO_CHECK(batched.indexCount == 36 && batched.firstIndex == 100 && batched.baseVertex == 10);
+    }
+
+    void stats(){
+        RenderQueue queue;
+        RecordingRenderDevice device;
+        std::mt19937 gen(11);
+        std::uniform_int_distribution<unsigned int> small(1, 3);
+        std::uniform_real_distribution<float> depths(0.0f, 1.0f);
+        // One VAO per mesh, the key has no field for VAOs
+        for(unsigned int i = 0; i < 2000; ++i){
+            const unsigned int mesh = small(gen);
+            queue.submit(item(small(gen), small(gen) - 1, mesh, depths(gen), i, small(gen) == 1, mesh));
+        }
+        queue.sort();
+
+        queue.execute(device);
+        const RenderQueueStats& direct = queue.get_stats();
+        PLUTO_CHECK(direct.items == 2000);
+        PLUTO_CHECK(direct.instances == 2000);
+        PLUTO_CHECK(direct.programChanges == device.count(Op::UseProgram));
+        PLUTO_CHECK(direct.wireframeChanges == device.count(Op::SetWireframe));
+        PLUTO_CHECK(direct.textureChanges == device.count(Op::BindTexture));
+        PLUTO_CHECK(direct.vertexArrayChanges == device.count(Op::BindVertexArray));
+        PLUTO_CHECK(direct.drawCalls == device.count(Op::DrawIndexed));
+        PLUTO_CHECK(direct.drawCommands == direct.drawCalls);
+        // One batch per combination of 3 programs, wireframe on and off, textures 0 to 2 and 3 meshes
+        PLUTO_CHECK(direct.drawCalls == 3 * 2 * 3 * 3);
+        unsigned int instances = 0;
+        for(const auto& call : device.get_calls()) instances += call.op == Op::DrawIndexed ? call.instanceCount : 0;
+        PLUTO_CHECK(instances == 2000);
+        // Each batch either makes or skips its program, wireframe and VAO binds, and its texture
+        // bind unless the texture is 0
+        unsigned int batches = 0, texturedBatches = 0;
+        for(std::size_t i = 0; i < queue.size(); ++i){
+            if(i > 0 && RenderQueue::same_batch(queue[i - 1], queue[i])) continue;
+            batches += 1;
+            texturedBatches += queue[i].texture != 0 ? 1 : 0;
+        }
+        PLUTO_CHECK(batches == direct.drawCalls);
+        PLUTO_CHECK(direct.state_changes() + direct.redundantSkipped == 3 * batches + texturedBatches);
+
+        // The indirect path makes the same binds, one multi-draw per state run
+        std::vector<DrawCommand> commands(queue.size());
+        const std::size_t written = queue.build_commands(commands.data());
+        PLUTO_CHECK(written == direct.drawCommands);
+        device.clear();
+        queue.execute_indirect(device, 64);
+        const RenderQueueStats& indirect = queue.get_stats();
+        PLUTO_CHECK(indirect.drawCommands == written);
+        PLUTO_CHECK(indirect.drawCalls == device.count(Op::MultiDrawIndirect));
+        PLUTO_CHECK(indirect.drawCalls <= direct.drawCalls);
+        PLUTO_CHECK(indirect.state_changes() == direct.state_changes());
+        unsigned int drawn = 0, commandInstances = 0;
+        std::size_t nextOffset = 64;
+        for(const auto& call : device.get_calls()){
+            if(call.op != Op::MultiDrawIndirect) continue;
+            PLUTO_CHECK(call.commandOffset == nextOffset);
+            nextOffset += call.drawCount * sizeof(DrawCommand);
+            drawn += call.drawCount;
+        }
+        for(std::size_t k = 0; k < written; ++k) commandInstances += commands[k].instanceCount;
+        PLUTO_CHECK(drawn == written);
+        PLUTO_CHECK(commandInstances == indirect.instances);
+        PLUTO_CHECK(device.count(Op::UseProgram) + device.count(Op::SetWireframe) + device.count(Op::BindTexture) +
+                    device.count(Op::BindVertexArray) == indirect.state_changes());
+    }
+}
+
+int main(){
+    key_order();
+    stable_ties();
+    redundant_binds();
+    stats();
+    return test::report("render queue");
+}
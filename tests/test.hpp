@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal check macros shared by the test executables. A failed check prints where it is and
+// the test goes on, report() then gives main() its exit code for ctest.
+namespace test{
+
+    struct counters{
+        int checks = 0;
+        int failures = 0;
+    };
+
+    inline counters& state(){
+        static counters c;
+        return c;
+    }
+
+    inline void check(const bool passed, const char* expression, const char* file, const int line){
+        state().checks += 1;
+        if(passed) return;
+        state().failures += 1;
+        std::printf("%s:%d: check failed: %s\n", file, line, expression);
+    }
+
+    inline int report(const char* name){
+        std::printf("%s: %d checks, %d failed\n", name, state().checks, state().failures);
+        return state().failures == 0 ? 0 : 1;
+    }
+}
+
+#define PLUTO_CHECK(expression) test::check(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
+
+#define PLUTO_CHECK_THROWS(expression)                                                              \
+    do{                                                                                             \
+        bool threw = false;                                                                         \
+        try{ static_cast<void>(expression); }catch(...){ threw = true; }                            \
+        test::check(threw, #expression " throws", __FILE__, __LINE__);                              \
+    }while(false)
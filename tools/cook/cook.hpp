@@ -0,0 +1,8 @@
+#ifndef COOK_HPP
+#define COOK_HPP
+
+// Each cooker takes the arguments after its command name and returns the process exit code
+int cook_texture(int argc, char** argv);
+int cook_mesh(int argc, char** argv);
+
+#endif //COOK_HPP
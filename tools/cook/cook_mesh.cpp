@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cook.hpp"
+#include "util/mesh_optimizer.hpp"
+#include "util/pmesh_format.hpp"
+
+namespace {
+    // One OBJ face corner, 1 based like the file with 0 for a missing uv or normal
+    struct Corner {
+        int position;
+        int uv;
+        int normal;
+
+        bool operator==(const Corner& other) const {
+            return position == other.position && uv == other.uv && normal == other.normal;
+        }
+    };
+
+    struct CornerHash {
+        std::size_t operator()(const Corner& corner) const {
+            std::size_t hash = static_cast<std::size_t>(corner.position) * 0x9E3779B97F4A7C15ull;
+            hash ^= static_cast<std::size_t>(corner.uv) * 0xC2B2AE3D27D4EB4Full + (hash << 6) + (hash >> 2);
+            hash ^= static_cast<std::size_t>(corner.normal) * 0x165667B19E3779F9ull + (hash << 6) + (hash >> 2);
+            return hash;
+        }
+    };
+
+    // The 8 float layout of primative, before packing
+    struct ObjMesh {
+        std::vector<float> vertices;
+        std::vector<unsigned int> indices;
+    };
+
+    bool read_file(const char* path, std::string& text) {
+        std::FILE* file = std::fopen(path, "rb");
+        if (!file) return false;
+        std::fseek(file, 0, SEEK_END);
+        const long size = std::ftell(file);
+        std::fseek(file, 0, SEEK_SET);
+        text.resize(size > 0 ? static_cast<std::size_t>(size) : 0);
+        const bool ok = std::fread(text.data(), 1, text.size(), file) == text.size();
+        std::fclose(file);
+        return ok;
+    }
+
+    // OBJ indices count from 1, negative ones back from the last element read so far
+    int resolve(const long index, const std::size_t count) {
+        if (index > 0) return index <= static_cast<long>(count) ? static_cast<int>(index) : -1;
+        if (index < 0) return -index <= static_cast<long>(count) ? static_cast<int>(count + index + 1) : -1;
+        return -1;
+    }
+
+    // Positions, uvs, normals and triangulated faces. Smoothing groups, materials and objects are
+    // ignored; corners without a normal get the area weighted average of the faces around them.
+    bool parse_obj(std::string& text, ObjMesh& mesh, std::string& error) {
+        std::vector<float> positions, uvs, normals;
+        std::vector<Corner> corners;
+        std::vector<Corner> face;
+        int lineNumber = 0;
+
+        char* cursor = text.data();
+        char* const end = text.data() + text.size();
+        while (cursor < end) {
+            char* line = cursor;
+            char* lineEnd = static_cast<char*>(std::memchr(cursor, '\n', static_cast<std::size_t>(end - cursor)));
+            if (!lineEnd) lineEnd = end;
+            cursor = lineEnd + 1;
+            *lineEnd = '\0';  // strtof and strtol stop at the end of the line
+            lineNumber += 1;
+
+            while (*line == ' ' || *line == '\t') ++line;
+            if (line[0] == 'v' && (line[1] == ' ' || line[1] == '\t')) {
+                char* next = line + 1;
+                for (int c = 0; c < 3; ++c) positions.push_back(std::strtof(next, &next));
+            } else if (line[0] == 'v' && line[1] == 't') {
+                char* next = line + 2;
+                for (int c = 0; c < 2; ++c) uvs.push_back(std::strtof(next, &next));
+            } else if (line[0] == 'v' && line[1] == 'n') {
+                char* next = line + 2;
+                for (int c = 0; c < 3; ++c) normals.push_back(std::strtof(next, &next));
+            } else if (line[0] == 'f' && (line[1] == ' ' || line[1] == '\t')) {
+                face.clear();
+                char* next = line + 1;
+                while (true) {
+                    while (*next == ' ' || *next == '\t' || *next == '\r') ++next;
+                    if (*next == '\0') break;
+                    Corner corner{resolve(std::strtol(next, &next, 10), positions.size() / 3), 0, 0};
+                    if (*next == '/') {
+                        ++next;
+                        if (*next != '/') corner.uv = resolve(std::strtol(next, &next, 10), uvs.size() / 2);
+                        if (*next == '/') {
+                            ++next;
+                            corner.normal = resolve(std::strtol(next, &next, 10), normals.size() / 3);
+                        }
+                    }
+                    if (corner.position < 0 || corner.uv < 0 || corner.normal < 0) {
+                        error = "index out of range on line " + std::to_string(lineNumber);
+                        return false;
+                    }
+                    face.push_back(corner);
+                }
+                if (face.size() < 3) {
+                    error = "face with fewer than 3 corners on line " + std::to_string(lineNumber);
+                    return false;
+                }
+                // Fan, fine for the convex faces exporters write
+                for (std::size_t k = 1; k + 1 < face.size(); ++k) {
+                    corners.push_back(face[0]);
+                    corners.push_back(face[k]);
+                    corners.push_back(face[k + 1]);
+                }
+            }
+        }
+        if (corners.empty()) {
+            error = "no faces";
+            return false;
+        }
+
+        std::vector<float> smooth;
+        const bool missingNormals = std::any_of(corners.begin(), corners.end(),
+                                                [](const Corner& corner) { return corner.normal == 0; });
+        if (missingNormals) {
+            smooth.assign(positions.size(), 0.0f);
+            for (std::size_t t = 0; t < corners.size(); t += 3) {
+                const float* a = &positions[(corners[t].position - 1) * 3];
+                const float* b = &positions[(corners[t + 1].position - 1) * 3];
+                const float* c = &positions[(corners[t + 2].position - 1) * 3];
+                const float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+                const float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+                // Unnormalized, so larger faces weigh more
+                const float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+                for (std::size_t k = t; k < t + 3; ++k) {
+                    for (int i = 0; i < 3; ++i) smooth[(corners[k].position - 1) * 3 + i] += n[i];
+                }
+            }
+        }
+
+        // Corners that repeat the same position, uv and normal become one vertex
+        std::unordered_map<Corner, unsigned int, CornerHash> vertexOf;
+        vertexOf.reserve(corners.size());
+        mesh.indices.reserve(corners.size());
+        for (const Corner& corner : corners) {
+            const auto [it, inserted] = vertexOf.emplace(corner, static_cast<unsigned int>(mesh.vertices.size() / 8));
+            mesh.indices.push_back(it->second);
+            if (!inserted) continue;
+
+            const float* p = &positions[(corner.position - 1) * 3];
+            float n[3] = {0.0f, 0.0f, 0.0f};
+            if (corner.normal) std::memcpy(n, &normals[(corner.normal - 1) * 3], sizeof(n));
+            else std::memcpy(n, &smooth[(corner.position - 1) * 3], sizeof(n));
+            const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            const float scale = length > 0.0f ? 1.0f / length : 0.0f;
+            const float u = corner.uv ? uvs[(corner.uv - 1) * 2] : 0.0f;
+            const float v = corner.uv ? uvs[(corner.uv - 1) * 2 + 1] : 0.0f;
+            const float vertex[8] = {p[0], p[1], p[2], n[0] * scale, n[1] * scale, n[2] * scale, u, v};
+            mesh.vertices.insert(mesh.vertices.end(), vertex, vertex + 8);
+        }
+        return true;
+    }
+
+    std::uint64_t align(const std::uint64_t offset) {
+        return (offset + PMESH_ALIGNMENT - 1) / PMESH_ALIGNMENT * PMESH_ALIGNMENT;
+    }
+
+    void usage() {
+        std::fprintf(stderr,
+                     "usage: pluto_cook mesh [--index32] [--no-optimize] <input.obj> <output.pmesh>\n"
+                     "  --index32      32 bit indices even when 16 bit ones would do\n"
+                     "  --no-optimize  keep the file's triangle and vertex order\n");
+    }
+}
+
+int cook_mesh(const int argc, char** argv) {
+    const char* input = nullptr;
+    const char* output = nullptr;
+    bool index32 = false;
+    bool optimize = true;
+    for (int i = 0; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--index32") == 0) index32 = true;
+        else if (std::strcmp(argv[i], "--no-optimize") == 0) optimize = false;
+        else if (!input) input = argv[i];
+        else if (!output) output = argv[i];
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (!input || !output) {
+        usage();
+        return 2;
+    }
+
+    std::string text;
+    if (!read_file(input, text)) {
+        std::fprintf(stderr, "Could not read %s\n", input);
+        return 1;
+    }
+    const std::size_t sourceBytes = text.size();
+    ObjMesh mesh;
+    std::string error;
+    if (!parse_obj(text, mesh, error)) {
+        std::fprintf(stderr, "Could not load %s: %s\n", input, error.c_str());
+        return 1;
+    }
+
+    std::size_t vertexCount = mesh.vertices.size() / 8;
+    const std::size_t indexCount = mesh.indices.size();
+    std::vector<PackedVertex> packed(vertexCount);
+    PmeshHeader header{};
+    for (int c = 0; c < 3; ++c) {
+        header.boundsMin[c] = mesh.vertices[c];
+        header.boundsMax[c] = mesh.vertices[c];
+    }
+    for (std::size_t v = 0; v < vertexCount; ++v) {
+        const float* vertex = &mesh.vertices[v * 8];
+        packed[v] = pack_vertex(vertex);
+        for (int c = 0; c < 3; ++c) {
+            header.boundsMin[c] = std::min(header.boundsMin[c], vertex[c]);
+            header.boundsMax[c] = std::max(header.boundsMax[c], vertex[c]);
+        }
+    }
+
+    // Done on the packed vertices, so corners that only differed below the quantization weld too
+    const VertexCacheStats before = mesh_optimizer::analyze_vertex_cache(mesh.indices.data(), indexCount, vertexCount);
+    if (optimize) {
+        vertexCount = mesh_optimizer::optimize(packed.data(), vertexCount, sizeof(PackedVertex), mesh.indices.data(),
+                                               indexCount);
+        packed.resize(vertexCount);
+    }
+    const VertexCacheStats after = mesh_optimizer::analyze_vertex_cache(mesh.indices.data(), indexCount, vertexCount);
+
+    std::memcpy(header.magic, PMESH_MAGIC, 4);
+    header.version = PMESH_VERSION;
+    header.vertexCount = static_cast<std::uint32_t>(vertexCount);
+    header.indexCount = static_cast<std::uint32_t>(indexCount);
+    header.indexSize = !index32 && vertexCount <= 0x10000 ? 2 : 4;
+    header.vertexOffset = align(sizeof(PmeshHeader));
+    header.indexOffset = align(header.vertexOffset + vertexCount * sizeof(PackedVertex));
+    const std::uint64_t fileBytes = header.indexOffset + indexCount * header.indexSize;
+
+    std::vector<std::uint8_t> file(fileBytes, 0);
+    std::memcpy(file.data(), &header, sizeof(header));
+    std::memcpy(file.data() + header.vertexOffset, packed.data(), vertexCount * sizeof(PackedVertex));
+    if (header.indexSize == 4) {
+        std::memcpy(file.data() + header.indexOffset, mesh.indices.data(), indexCount * sizeof(std::uint32_t));
+    } else {
+        auto* out = reinterpret_cast<std::uint16_t*>(file.data() + header.indexOffset);
+        for (std::size_t i = 0; i < indexCount; ++i) out[i] = static_cast<std::uint16_t>(mesh.indices[i]);
+    }
+
+    std::FILE* handle = std::fopen(output, "wb");
+    if (!handle) {
+        std::fprintf(stderr, "Could not open %s for writing\n", output);
+        return 1;
+    }
+    bool ok = std::fwrite(file.data(), 1, file.size(), handle) == file.size();
+    ok = std::fclose(handle) == 0 && ok;
+    if (!ok) {
+        std::fprintf(stderr, "Could not write %s\n", output);
+        return 1;
+    }
+
+    // Against the 8 float vertices and 32 bit indices the primitives are uploaded from
+    const std::size_t floatBytes = vertexCount * 8 * sizeof(float) + indexCount * sizeof(std::uint32_t);
+    std::printf("%s: %zu vertices, %zu triangles, %u bit indices, %zu bytes (%.1fx smaller than %zu as floats, "
+                "%zu bytes of OBJ)\n", output, vertexCount, indexCount / 3, header.indexSize * 8,
+                static_cast<std::size_t>(fileBytes), static_cast<double>(floatBytes) / static_cast<double>(fileBytes),
+                floatBytes, sourceBytes);
+    std::printf("  vertex cache (%u entries): ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+                mesh_optimizer::DEFAULT_CACHE_SIZE, before.acmr, after.acmr, before.atvr, after.atvr);
+    return 0;
+}
@@ -0,0 +1,95 @@
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "cook.hpp"
+#include "util/block_codec.hpp"
+#include "util/ptex_format.hpp"
+
+namespace {
+    double psnr(const std::uint8_t* a, const std::uint8_t* b, const std::size_t pixels, const int channels) {
+        double error = 0.0;
+        for (std::size_t i = 0; i < pixels; ++i) {
+            for (int c = 0; c < channels; ++c) {
+                const double d = static_cast<double>(a[i * 4 + c]) - b[i * 4 + c];
+                error += d * d;
+            }
+        }
+        if (error == 0.0) return INFINITY;
+        return 10.0 * std::log10(255.0 * 255.0 * static_cast<double>(pixels * channels) / error);
+    }
+
+    void usage() {
+        std::fprintf(stderr,
+                     "usage: pluto_cook texture [--bc1|--bc3] [--no-mips] [--no-flip] <input> <output.ptex>\n"
+                     "  --bc1, --bc3   block format, by default BC3 if any texel is not opaque, BC1 if not\n"
+                     "  --no-mips      only the full size level\n"
+                     "  --no-flip      keep the file's top row first (the engine loads textures flipped)\n");
+    }
+}
+
+int cook_texture(const int argc, char** argv) {
+    const char* input = nullptr;
+    const char* output = nullptr;
+    int format = 0;
+    bool mips = true;
+    bool flip = true;
+    for (int i = 0; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--bc1") == 0) format = 1;
+        else if (std::strcmp(argv[i], "--bc3") == 0) format = 3;
+        else if (std::strcmp(argv[i], "--no-mips") == 0) mips = false;
+        else if (std::strcmp(argv[i], "--no-flip") == 0) flip = false;
+        else if (!input) input = argv[i];
+        else if (!output) output = argv[i];
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (!input || !output) {
+        usage();
+        return 2;
+    }
+
+    int width, height, channels;
+    stbi_set_flip_vertically_on_load(flip);
+    std::uint8_t* pixels = stbi_load(input, &width, &height, &channels, 4);
+    if (!pixels) {
+        std::fprintf(stderr, "Could not load %s: %s\n", input, stbi_failure_reason());
+        return 1;
+    }
+    std::vector<std::uint8_t> level(pixels, pixels + static_cast<std::size_t>(width) * height * 4);
+    stbi_image_free(pixels);
+
+    const std::size_t pixelCount = static_cast<std::size_t>(width) * height;
+    const BlockFormat blockFormat = format == 1 ? BlockFormat::BC1
+                                  : format == 3 ? BlockFormat::BC3
+                                  : ptex_writer::pick_format(level.data(), width, height);
+    const int mipCount = mips ? block_codec::mip_count(width, height) : 1;
+    const auto ptex = ptex_writer::encode(level.data(), width, height, blockFormat, mips);
+
+    PtexView view;
+    if (!view.parse(ptex.data(), ptex.size())) {
+        std::fprintf(stderr, "Could not encode %s\n", input);
+        return 1;
+    }
+    const auto decoded = block_codec::decompress(blockFormat, view.get_level(0), width, height);
+    const double quality = psnr(level.data(), decoded.data(), pixelCount, blockFormat == BlockFormat::BC1 ? 3 : 4);
+
+    if (!ptex_writer::write(output, ptex)) {
+        std::fprintf(stderr, "Could not write %s\n", output);
+        return 1;
+    }
+
+    // What the uncompressed path keeps in memory: GL pads 3 channel textures to RGBX, mips add a third
+    const std::size_t rgbaBytes = pixelCount * (channels == 3 ? 4 : channels) * (mipCount > 1 ? 4 : 3) / 3;
+    std::printf("%s: %dx%d %s, %d mips, %zu bytes (%.1fx smaller than %zu uncompressed), %.2f dB\n", output, width,
+                height, blockFormat == BlockFormat::BC1 ? "BC1" : "BC3", mipCount, ptex.size(),
+                static_cast<double>(rgbaBytes) / static_cast<double>(ptex.size()), rgbaBytes, quality);
+    return 0;
+}
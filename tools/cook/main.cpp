@@ -0,0 +1,18 @@
+#include <cstdio>
+#include <cstring>
+
+#include "cook.hpp"
+
+// pluto_cook <asset type> [options] <input> <output>
+// Converts source assets into the formats the engine maps straight into memory.
+int main(int argc, char** argv){
+    if (argc >= 2 && std::strcmp(argv[1], "texture") == 0) return cook_texture(argc - 2, argv + 2);
+    if (argc >= 2 && std::strcmp(argv[1], "mesh") == 0) return cook_mesh(argc - 2, argv + 2);
+
+    std::fprintf(stderr,
+                 "usage: pluto_cook <command> [options] <input> <output>\n"
+                 "commands:\n"
+                 "  texture    PNG/JPEG/TGA/BMP to a block compressed .ptex with mips\n"
+                 "  mesh       OBJ to a .pmesh of packed vertices and 16/32 bit indices\n");
+    return 2;
+}